@@ -19,6 +19,28 @@
 #include <stdint.h>
 #include <opus.h>
 
+/*
+ * Gets the address of length bytes at offset in a direct java.nio.ByteBuffer,
+ * or NULL if buffer is not direct or the bytes are not within its capacity.
+ */
+static jbyte *
+Opus_getDirectBufferAddress
+    (JNIEnv *env, jobject buffer, jint offset, jlong length)
+{
+    jbyte *address;
+    jlong capacity;
+
+    if (!buffer || offset < 0 || length < 0)
+        return NULL;
+    address = (*env)->GetDirectBufferAddress(env, buffer);
+    if (!address)
+        return NULL;
+    capacity = (*env)->GetDirectBufferCapacity(env, buffer);
+    if (capacity < 0 || length > capacity || offset > capacity - length)
+        return NULL;
+    return address + offset;
+}
+
 JNIEXPORT jint JNICALL
 Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_decode
     (JNIEnv *env, jclass clazz, jlong decoder, jbyteArray input,
@@ -73,6 +95,66 @@ Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_decode
     return ret;
 }
 
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_decodeAddress
+    (JNIEnv *env, jclass clazz, jlong decoder, jlong input, jint inputLength,
+        jlong output, jint outputFrameSize, jint decodeFEC)
+{
+    if (!output)
+        return OPUS_BAD_ARG;
+    return
+        opus_decode(
+                (OpusDecoder *) (intptr_t) decoder,
+                (unsigned char *)
+                    ((input && inputLength) ? (intptr_t) input : 0),
+                inputLength,
+                (opus_int16 *) (intptr_t) output,
+                outputFrameSize,
+                decodeFEC);
+}
+
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_decodeDirect
+    (JNIEnv *env, jclass clazz, jlong decoder, jobject input,
+        jint inputOffset, jint inputLength, jobject output,
+        jint outputOffset, jint outputFrameSize, jint channels,
+        jint decodeFEC)
+{
+    jbyte *input_;
+    jbyte *output_;
+
+    if (input && inputLength)
+    {
+        input_
+            = Opus_getDirectBufferAddress(
+                    env,
+                    input, inputOffset, inputLength);
+        if (!input_)
+            return OPUS_BAD_ARG;
+    }
+    else
+        input_ = NULL;
+
+    if (channels < 1)
+        return OPUS_BAD_ARG;
+    output_
+        = Opus_getDirectBufferAddress(
+                env,
+                output, outputOffset,
+                (jlong) outputFrameSize * channels * sizeof(opus_int16));
+    if (!output_)
+        return OPUS_BAD_ARG;
+
+    return
+        opus_decode(
+                (OpusDecoder *) (intptr_t) decoder,
+                (unsigned char *) input_,
+                inputLength,
+                (opus_int16 *) output_,
+                outputFrameSize,
+                decodeFEC);
+}
+
 JNIEXPORT jlong JNICALL
 Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_decoder_1create
     (JNIEnv *env, jclass clazz, jint Fs, jint channels)
@@ -170,6 +252,51 @@ Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_encode
     return ret;
 }
 
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_encodeAddress
+    (JNIEnv *env, jclass clazz, jlong encoder, jlong input,
+        jint inputFrameSize, jlong output, jint outputLength)
+{
+    if (!input || !output)
+        return OPUS_BAD_ARG;
+    return
+        opus_encode(
+                (OpusEncoder *) (intptr_t) encoder,
+                (opus_int16 *) (intptr_t) input,
+                inputFrameSize,
+                (unsigned char *) (intptr_t) output,
+                outputLength);
+}
+
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_encodeDirect
+    (JNIEnv *env, jclass clazz, jlong encoder, jobject input,
+        jint inputOffset, jint inputFrameSize, jint channels, jobject output,
+        jint outputOffset, jint outputLength)
+{
+    jbyte *input_;
+    jbyte *output_;
+
+    if (channels < 1)
+        return OPUS_BAD_ARG;
+    input_
+        = Opus_getDirectBufferAddress(
+                env,
+                input, inputOffset,
+                (jlong) inputFrameSize * channels * sizeof(opus_int16));
+    output_
+        = Opus_getDirectBufferAddress(env, output, outputOffset, outputLength);
+    if (!input_ || !output_)
+        return OPUS_BAD_ARG;
+    return
+        opus_encode(
+                (OpusEncoder *) (intptr_t) encoder,
+                (opus_int16 *) input_,
+                inputFrameSize,
+                (unsigned char *) output_,
+                outputLength);
+}
+
 JNIEXPORT jlong JNICALL
 Java_org_jitsi_impl_neomedia_codec_audio_opus_Opus_encoder_1create
     (JNIEnv *env, jclass clazz, jint Fs, jint channels)
@@ -37,7 +37,11 @@
     ? vpx_codec_vp8_dx() \
     : (((x) == org_jitsi_impl_neomedia_codec_video_VPX_INTERFACE_VP8_ENC)) \
         ? vpx_codec_vp8_cx() \
-        : NULL)
+        : (((x) == org_jitsi_impl_neomedia_codec_video_VPX_INTERFACE_VP9_DEC)) \
+            ? vpx_codec_vp9_dx() \
+            : (((x) == org_jitsi_impl_neomedia_codec_video_VPX_INTERFACE_VP9_ENC)) \
+                ? vpx_codec_vp9_cx() \
+                : NULL)
 
 #define DEFINE_ENC_CFG_INT_PROPERTY_SETTER(name, property) \
     JNIEXPORT void JNICALL \
@@ -47,6 +51,38 @@
             ((vpx_codec_enc_cfg_t *) (intptr_t) cfg)->property = (int) value; \
         }
 
+/* Defines a setter for an array property of vpx_codec_enc_cfg_t. At most
+   max elements are copied from the java array. */
+#define DEFINE_ENC_CFG_INT_ARRAY_PROPERTY_SETTER(name, property, max) \
+    JNIEXPORT void JNICALL \
+    Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1enc_1cfg_1set_1##name \
+            (JNIEnv *env, jclass clazz, jlong cfg, jintArray values) \
+        { \
+            vpx_codec_enc_cfg_t *c = (vpx_codec_enc_cfg_t *) (intptr_t) cfg; \
+            jint n = (*env)->GetArrayLength(env, values); \
+            jint buf[max]; \
+            jint i; \
+            \
+            if (n > (max)) \
+                n = (max); \
+            (*env)->GetIntArrayRegion(env, values, 0, n, buf); \
+            for (i = 0; i < n; i++) \
+                c->property[i] = (unsigned int) buf[i]; \
+        }
+
+/* Defines a setter for an integer codec control, e.g. VP9E_SET_ROW_MT. The
+   type is the one which libvpx associates with the control id. */
+#define DEFINE_CODEC_INT_CONTROL_SETTER(name, ctrl_id, type) \
+    JNIEXPORT jint JNICALL \
+    Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1##name \
+            (JNIEnv *env, jclass clazz, jlong context, jint value) \
+        { \
+            return (jint) vpx_codec_control( \
+                            (vpx_codec_ctx_t *) (intptr_t) context, \
+                            ctrl_id, \
+                            (type) value); \
+        }
+
 #define DEFINE_IMG_INT_PROPERTY_SETTER(name, property) \
     JNIEXPORT void JNICALL \
     Java_org_jitsi_impl_neomedia_codec_video_VPX_img_1set_1##name \
@@ -88,9 +124,10 @@ Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1dec_1init
 
 /*
  * Method:    codec_decode
+ * Signature: (J[BIIJJ)I
  */
 JNIEXPORT jint JNICALL
-Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1decode
+Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1decode__J_3BIIJJ
     (JNIEnv *env,
      jclass clazz,
      jlong context,
@@ -112,6 +149,37 @@ Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1decode
     return (jint) ret;
 }
 
+/*
+ * Method:    codec_decode
+ * Signature: (JLjava/nio/ByteBuffer;IIJJ)I
+ */
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1decode__JLjava_nio_ByteBuffer_2IIJJ
+    (JNIEnv *env,
+     jclass clazz,
+     jlong context,
+     jobject buf,
+     jint buf_offset,
+     jint buf_size,
+     jlong user_priv,
+     jlong deadline)
+{
+    uint8_t *buf_ptr = (uint8_t *) (*env)->GetDirectBufferAddress(env, buf);
+
+    if (!buf_ptr
+            || buf_offset < 0
+            || buf_size < 0
+            || (jlong) buf_offset + buf_size
+                > (*env)->GetDirectBufferCapacity(env, buf))
+        return (jint) VPX_CODEC_INVALID_PARAM;
+
+    return (jint) vpx_codec_decode((vpx_codec_ctx_t *) (intptr_t) context,
+                                   buf_ptr + buf_offset,
+                                   (unsigned int) buf_size,
+                                   (void *) (intptr_t) user_priv,
+                                   (long) deadline);
+}
+
 /*
  * Method:    codec_get_frame
  */
@@ -132,6 +200,212 @@ Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1get_1frame
     return (jlong) (intptr_t) ret;
 }
 
+/*
+ * Writes the 32-bit value <tt>v</tt> at <tt>dst</tt> in network byte order.
+ */
+static void
+write_be32(uint8_t *dst, uint32_t v)
+{
+    dst[0] = (uint8_t) (v >> 24);
+    dst[1] = (uint8_t) (v >> 16);
+    dst[2] = (uint8_t) (v >> 8);
+    dst[3] = (uint8_t) v;
+}
+
+/*
+ * Copies a plane of <tt>w</tt> by <tt>h</tt> bytes with stride
+ * <tt>stride</tt> from <tt>src</tt> to <tt>dst</tt>, removing the padding at
+ * the end of each row. Returns the number of bytes written.
+ */
+static size_t
+copy_plane(uint8_t *dst, const uint8_t *src, int stride, int w, int h)
+{
+    int y;
+
+    if (stride == w)
+    {
+        memcpy(dst, src, (size_t) w * h);
+    }
+    else
+    {
+        for (y = 0; y < h; y++)
+            memcpy(dst + (size_t) y * w, src + (size_t) y * stride, w);
+    }
+    return (size_t) w * h;
+}
+
+/*
+ * Method:    codec_decode_export
+ */
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1decode_1export
+    (JNIEnv *env,
+     jclass clazz,
+     jlong context,
+     jbyteArray buf,
+     jint buf_offset,
+     jint buf_size,
+     jbyteArray out,
+     jint out_offset,
+     jint out_size,
+     jlong deadline)
+{
+    vpx_codec_ctx_t *ctx = (vpx_codec_ctx_t *) (intptr_t) context;
+    vpx_codec_iter_t iter = NULL;
+    vpx_image_t *img;
+    vpx_codec_err_t err;
+    uint8_t *out_ptr;
+    jint written = 0;
+    jbyte *buf_ptr;
+
+    if (buf_offset < 0
+            || buf_size < 0
+            || buf_offset > (*env)->GetArrayLength(env, buf) - buf_size
+            || out_offset < 0
+            || out_size < 0
+            || out_offset > (*env)->GetArrayLength(env, out) - out_size)
+        return -VPX_CODEC_INVALID_PARAM;
+
+    buf_ptr = (*env)->GetByteArrayElements(env, buf, NULL);
+    if (!buf_ptr)
+        return -VPX_CODEC_MEM_ERROR;
+    err = vpx_codec_decode(ctx,
+                           (uint8_t *) (buf_ptr + buf_offset),
+                           (unsigned int) buf_size,
+                           NULL,
+                           (long) deadline);
+    (*env)->ReleaseByteArrayElements(env, buf, buf_ptr, JNI_ABORT);
+    if (err != VPX_CODEC_OK)
+        return -err;
+
+    /*
+     * The decoded frames stay valid until the next call to vpx_codec_decode,
+     * so the output array only needs to be held while copying them.
+     */
+    out_ptr = (*env)->GetPrimitiveArrayCritical(env, out, NULL);
+    if (!out_ptr)
+        return -VPX_CODEC_MEM_ERROR;
+    out_ptr += out_offset;
+
+    while ((img = vpx_codec_get_frame(ctx, &iter)))
+    {
+        int w = (int) img->d_w;
+        int h = (int) img->d_h;
+        int cw = (w + 1) >> 1;
+        int ch = (h + 1) >> 1;
+        size_t size = (size_t) w * h + 2 * (size_t) cw * ch;
+        uint8_t *dst;
+
+        if (img->fmt != VPX_IMG_FMT_I420)
+        {
+            written = -VPX_CODEC_UNSUP_FEATURE;
+            break;
+        }
+        if (org_jitsi_impl_neomedia_codec_video_VPX_DECODE_EXPORT_HEADER_SIZE
+                    + size
+                > (size_t) (out_size - written))
+        {
+            written = -VPX_CODEC_MEM_ERROR;
+            break;
+        }
+
+        dst = out_ptr + written;
+        write_be32(dst, (uint32_t) w);
+        write_be32(dst + 4, (uint32_t) h);
+        write_be32(dst + 8, (uint32_t) size);
+        dst += org_jitsi_impl_neomedia_codec_video_VPX_DECODE_EXPORT_HEADER_SIZE;
+
+        dst += copy_plane(dst, img->planes[VPX_PLANE_Y], img->stride[0], w, h);
+        dst += copy_plane(dst, img->planes[VPX_PLANE_U], img->stride[1], cw, ch);
+        copy_plane(dst, img->planes[VPX_PLANE_V], img->stride[2], cw, ch);
+
+        written
+            += org_jitsi_impl_neomedia_codec_video_VPX_DECODE_EXPORT_HEADER_SIZE
+                + (jint) size;
+    }
+
+    (*env)->ReleasePrimitiveArrayCritical(
+            env,
+            out, out_ptr - out_offset, written < 0 ? JNI_ABORT : 0);
+    return written;
+}
+
+/*
+ * Method:    codec_decode_fragments
+ */
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1decode_1fragments
+    (JNIEnv *env,
+     jclass clazz,
+     jlong context,
+     jbyteArray buf,
+     jint buf_offset,
+     jintArray fragment_sizes,
+     jint fragment_count,
+     jlong deadline)
+{
+    vpx_codec_ctx_t *ctx = (vpx_codec_ctx_t *) (intptr_t) context;
+    jint sizes[org_jitsi_impl_neomedia_codec_video_VPX_MAX_FRAGMENTS];
+    vpx_codec_err_t err = VPX_CODEC_OK;
+    jbyte *buf_ptr;
+    uint8_t *fragment;
+    jint i;
+
+    if (fragment_count < 1
+            || fragment_count
+                > org_jitsi_impl_neomedia_codec_video_VPX_MAX_FRAGMENTS
+            || fragment_count
+                > (*env)->GetArrayLength(env, fragment_sizes))
+        return VPX_CODEC_INVALID_PARAM;
+    (*env)->GetIntArrayRegion(env, fragment_sizes, 0, fragment_count, sizes);
+
+    buf_ptr = (*env)->GetByteArrayElements(env, buf, NULL);
+    if (!buf_ptr)
+        return VPX_CODEC_MEM_ERROR;
+
+    /*
+     * libvpx keeps pointers to the fragments until the end of the frame is
+     * signalled, so all of them are passed while buf is held.
+     */
+    fragment = (uint8_t *) (buf_ptr + buf_offset);
+    for (i = 0; i < fragment_count && err == VPX_CODEC_OK; i++)
+    {
+        err = vpx_codec_decode(ctx,
+                               fragment,
+                               (unsigned int) sizes[i],
+                               NULL,
+                               0);
+        fragment += sizes[i];
+    }
+    /* Signal the end of the frame even after an error, so that the decoder
+       drops the fragments it has been given. */
+    if (err == VPX_CODEC_OK)
+        err = vpx_codec_decode(ctx, NULL, 0, NULL, (long) deadline);
+    else
+        vpx_codec_decode(ctx, NULL, 0, NULL, (long) deadline);
+
+    (*env)->ReleaseByteArrayElements(env, buf, buf_ptr, JNI_ABORT);
+    return (jint) err;
+}
+
+/*
+ * Method:    codec_decode_flush
+ */
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1decode_1flush
+    (JNIEnv *env,
+     jclass clazz,
+     jlong context,
+     jlong deadline)
+{
+    return (jint) vpx_codec_decode(
+                (vpx_codec_ctx_t *) (intptr_t) context,
+                NULL,
+                0,
+                NULL,
+                (long) deadline);
+}
+
 /*
  * Method:    codec_destroy
  */
@@ -175,7 +449,7 @@ Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1enc_1config_1set
 {
     return (jint) vpx_codec_enc_config_set(
                 (vpx_codec_ctx_t *) (intptr_t) context,
-                (vpx_codec_enc_cfg_t *) (intptr_t) context);
+                (vpx_codec_enc_cfg_t *) (intptr_t) cfg);
 }
 
 /*
@@ -237,6 +511,339 @@ Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1get_1cx_1data
 
 }
 
+/*
+ * Copies the data of all compressed frame packets which are available in an
+ * encoder context into out[out_offset, out_offset + out_size) and describes
+ * each of them with CX_PKT_INFO_LENGTH elements of info: the offset in out,
+ * the size, the vpx_codec_frame_flags_t and the pts. Iteration starts over
+ * from the first packet, so the packets remain available through
+ * vpx_codec_get_cx_data until the next call to vpx_codec_encode.
+ *
+ * Returns the number of packets written, or a negated libvpx error code. No
+ * packet is written unless all of them fit.
+ */
+static jint
+copy_cx_data
+    (JNIEnv *env,
+     vpx_codec_ctx_t *ctx,
+     jbyteArray out,
+     jint out_offset,
+     jint out_size,
+     jlongArray info)
+{
+    const vpx_codec_cx_pkt_t *pkt;
+    vpx_codec_iter_t iter = NULL;
+    jsize info_length = (*env)->GetArrayLength(env, info);
+    jint count = 0;
+    size_t total = 0;
+    unsigned char *out_ptr;
+    jlong pkt_info[org_jitsi_impl_neomedia_codec_video_VPX_CX_PKT_INFO_LENGTH];
+    jint offset;
+    jint i;
+
+    if (out_offset < 0
+            || out_size < 0
+            || out_offset > (*env)->GetArrayLength(env, out) - out_size)
+        return -VPX_CODEC_INVALID_PARAM;
+
+    while ((pkt = vpx_codec_get_cx_data(ctx, &iter)))
+    {
+        if (pkt->kind == VPX_CODEC_CX_FRAME_PKT)
+        {
+            total += pkt->data.frame.sz;
+            count++;
+        }
+    }
+    if (count == 0)
+        return 0;
+    if (total > (size_t) out_size
+            || count * org_jitsi_impl_neomedia_codec_video_VPX_CX_PKT_INFO_LENGTH
+                > info_length)
+        return -VPX_CODEC_MEM_ERROR;
+
+    out_ptr = (*env)->GetPrimitiveArrayCritical(env, out, NULL);
+    if (!out_ptr)
+        return -VPX_CODEC_MEM_ERROR;
+    iter = NULL;
+    offset = out_offset;
+    while ((pkt = vpx_codec_get_cx_data(ctx, &iter)))
+    {
+        if (pkt->kind == VPX_CODEC_CX_FRAME_PKT)
+        {
+            memcpy(out_ptr + offset, pkt->data.frame.buf, pkt->data.frame.sz);
+            offset += (jint) pkt->data.frame.sz;
+        }
+    }
+    (*env)->ReleasePrimitiveArrayCritical(env, out, out_ptr, 0);
+
+    /* JNI functions must not be called while the array is held critically,
+       so the table is filled in a second pass. */
+    iter = NULL;
+    offset = out_offset;
+    i = 0;
+    while ((pkt = vpx_codec_get_cx_data(ctx, &iter)))
+    {
+        if (pkt->kind == VPX_CODEC_CX_FRAME_PKT)
+        {
+            pkt_info[0] = offset;
+            pkt_info[1] = (jlong) pkt->data.frame.sz;
+            pkt_info[2] = (jlong) pkt->data.frame.flags;
+            pkt_info[3] = (jlong) pkt->data.frame.pts;
+            (*env)->SetLongArrayRegion(
+                    env,
+                    info,
+                    i * org_jitsi_impl_neomedia_codec_video_VPX_CX_PKT_INFO_LENGTH,
+                    org_jitsi_impl_neomedia_codec_video_VPX_CX_PKT_INFO_LENGTH,
+                    pkt_info);
+            offset += (jint) pkt->data.frame.sz;
+            i++;
+        }
+    }
+    return count;
+}
+
+/*
+ * Method:    codec_encode_batch
+ */
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1encode_1batch
+    (JNIEnv *env,
+     jclass clazz,
+     jlong context,
+     jlong jimg,
+     jbyteArray bufArray,
+     jint offset0,
+     jint offset1,
+     jint offset2,
+     jlong pts,
+     jlong duration,
+     jlong flags,
+     jlong deadline,
+     jbyteArray out,
+     jint out_offset,
+     jint out_size,
+     jlongArray info)
+{
+    vpx_codec_ctx_t *ctx = (vpx_codec_ctx_t *) (intptr_t) context;
+    vpx_image_t *img = (vpx_image_t *) (intptr_t) jimg;
+    unsigned char *buf;
+    vpx_codec_err_t ret;
+
+    buf = (unsigned char *) (*env)->GetByteArrayElements(env, bufArray, NULL);
+    if (!buf)
+        return -VPX_CODEC_MEM_ERROR;
+    img->planes[0] = (buf + offset0);
+    img->planes[1] = (buf + offset1);
+    img->planes[2] = (buf + offset2);
+    img->planes[3] = 0;
+
+    ret = vpx_codec_encode(
+            ctx,
+            img,
+            (vpx_codec_pts_t) pts,
+            (unsigned long) duration,
+            (vpx_enc_frame_flags_t) flags,
+            (unsigned long) deadline);
+
+    (*env)->ReleaseByteArrayElements(env, bufArray, (jbyte *) buf, JNI_ABORT);
+    if (ret != VPX_CODEC_OK)
+        return -((jint) ret);
+
+    return copy_cx_data(env, ctx, out, out_offset, out_size, info);
+}
+
+/*
+ * Method:    codec_get_cx_data_batch
+ */
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1get_1cx_1data_1batch
+    (JNIEnv *env,
+     jclass clazz,
+     jlong context,
+     jbyteArray out,
+     jint out_offset,
+     jint out_size,
+     jlongArray info)
+{
+    return
+        copy_cx_data(
+                env,
+                (vpx_codec_ctx_t *) (intptr_t) context,
+                out,
+                out_offset,
+                out_size,
+                info);
+}
+
+/*
+ * Method:    codec_get_cx_data_packetized
+ */
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1get_1cx_1data_1packetized
+    (JNIEnv *env,
+     jclass clazz,
+     jlong context,
+     jbyteArray pd,
+     jint pd_length,
+     jint max_payload_size,
+     jbyteArray out,
+     jint out_offset,
+     jint out_size,
+     jlongArray info)
+{
+    vpx_codec_ctx_t *ctx = (vpx_codec_ctx_t *) (intptr_t) context;
+    const vpx_codec_cx_pkt_t *pkt;
+    vpx_codec_iter_t iter = NULL;
+    jsize info_length = (*env)->GetArrayLength(env, info);
+    jint count = 0;
+    size_t total = 0;
+    jbyte pd_template[
+            org_jitsi_impl_neomedia_codec_video_VPX_MAX_PAYLOAD_DESCRIPTOR_LENGTH];
+    jlong *payload_info;
+    unsigned char *out_ptr;
+    jint offset;
+    jint i;
+    int partition_id;
+    int picture_id;
+
+    if (pd_length < 1
+            || pd_length
+                > org_jitsi_impl_neomedia_codec_video_VPX_MAX_PAYLOAD_DESCRIPTOR_LENGTH
+            || pd_length > (*env)->GetArrayLength(env, pd)
+            || max_payload_size < 1
+            || out_offset < 0
+            || out_size < 0
+            || out_offset > (*env)->GetArrayLength(env, out) - out_size)
+        return -VPX_CODEC_INVALID_PARAM;
+
+    while ((pkt = vpx_codec_get_cx_data(ctx, &iter)))
+    {
+        if (pkt->kind == VPX_CODEC_CX_FRAME_PKT && pkt->data.frame.sz > 0)
+        {
+            jint n
+                = (jint)
+                    ((pkt->data.frame.sz + max_payload_size - 1)
+                        / max_payload_size);
+
+            count += n;
+            total += pkt->data.frame.sz + (size_t) n * pd_length;
+        }
+    }
+    if (count == 0)
+        return 0;
+    if (total > (size_t) out_size
+            || count * org_jitsi_impl_neomedia_codec_video_VPX_CX_PKT_INFO_LENGTH
+                > info_length)
+        return -VPX_CODEC_MEM_ERROR;
+
+    payload_info
+        = malloc(
+                count
+                    * org_jitsi_impl_neomedia_codec_video_VPX_CX_PKT_INFO_LENGTH
+                    * sizeof(jlong));
+    if (!payload_info)
+        return -VPX_CODEC_MEM_ERROR;
+    (*env)->GetByteArrayRegion(env, pd, 0, pd_length, pd_template);
+    /* A 15-bit PictureID (X, I and M set) is that of the first frame. */
+    if (pd_length >= 4
+            && (pd_template[0] & 0x80)
+            && (pd_template[1] & 0x80)
+            && (pd_template[2] & 0x80))
+    {
+        picture_id
+            = ((pd_template[2] & 0x7F) << 8) | (pd_template[3] & 0xFF);
+    }
+    else
+    {
+        picture_id = -1;
+    }
+
+    out_ptr = (*env)->GetPrimitiveArrayCritical(env, out, NULL);
+    if (!out_ptr)
+    {
+        free(payload_info);
+        return -VPX_CODEC_MEM_ERROR;
+    }
+    iter = NULL;
+    offset = out_offset;
+    i = 0;
+    partition_id = 0;
+    while ((pkt = vpx_codec_get_cx_data(ctx, &iter)))
+    {
+        const unsigned char *data;
+        size_t remaining;
+
+        if (pkt->kind != VPX_CODEC_CX_FRAME_PKT || pkt->data.frame.sz == 0)
+            continue;
+
+        data = pkt->data.frame.buf;
+        remaining = pkt->data.frame.sz;
+        while (remaining > 0)
+        {
+            size_t size
+                = (remaining > (size_t) max_payload_size)
+                    ? (size_t) max_payload_size
+                    : remaining;
+            jlong *payload
+                = payload_info
+                    + i * org_jitsi_impl_neomedia_codec_video_VPX_CX_PKT_INFO_LENGTH;
+
+            /*
+             * The first octet of the payload descriptor holds the S bit and
+             * the PartID, which are set for each payload. The rest is taken
+             * from the template as is.
+             */
+            memcpy(out_ptr + offset, pd_template, pd_length);
+            out_ptr[offset]
+                = (out_ptr[offset] & 0xE0)
+                    | ((data == pkt->data.frame.buf) ? 0x10 : 0)
+                    | (partition_id > 8 ? 8 : partition_id);
+            memcpy(out_ptr + offset + pd_length, data, size);
+
+            payload[0] = offset;
+            payload[1] = (jlong) (pd_length + size);
+            payload[2] = (jlong) pkt->data.frame.flags;
+            payload[3] = (jlong) pkt->data.frame.pts;
+
+            data += size;
+            remaining -= size;
+            offset += pd_length + (jint) size;
+            i++;
+        }
+
+        /* The last partition of a frame is not flagged as a fragment. */
+        if (pkt->data.frame.flags & VPX_FRAME_IS_FRAGMENT)
+        {
+            partition_id++;
+        }
+        else
+        {
+            payload_info[
+                    (i - 1)
+                        * org_jitsi_impl_neomedia_codec_video_VPX_CX_PKT_INFO_LENGTH
+                        + 2]
+                |= org_jitsi_impl_neomedia_codec_video_VPX_PAYLOAD_END_OF_FRAME;
+            partition_id = 0;
+            if (picture_id != -1)
+            {
+                picture_id = (picture_id + 1) & 0x7FFF;
+                pd_template[2] = (jbyte) (0x80 | (picture_id >> 8));
+                pd_template[3] = (jbyte) (picture_id & 0xFF);
+            }
+        }
+    }
+    (*env)->ReleasePrimitiveArrayCritical(env, out, out_ptr, 0);
+
+    (*env)->SetLongArrayRegion(
+            env,
+            info,
+            0,
+            count * org_jitsi_impl_neomedia_codec_video_VPX_CX_PKT_INFO_LENGTH,
+            payload_info);
+    free(payload_info);
+    return count;
+}
+
 /*
  * Method:    codec_cx_pkt_get_kind
  */
@@ -451,6 +1058,125 @@ Java_org_jitsi_impl_neomedia_codec_video_VPX_img_1wrap
                  (unsigned char *) (intptr_t) data);
 }
 
+/*
+ * Method:    img_alloc
+ */
+JNIEXPORT jlong JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_img_1alloc
+    (JNIEnv *env,
+     jclass clazz,
+     jint fmt,
+     jint d_w,
+     jint d_h,
+     jint align)
+{
+    return
+        (jlong) (intptr_t)
+            vpx_img_alloc(
+                    NULL,
+                    (vpx_img_fmt_t) fmt,
+                    (unsigned int) d_w,
+                    (unsigned int) d_h,
+                    (unsigned int) align);
+}
+
+/*
+ * Method:    img_free
+ */
+JNIEXPORT void JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_img_1free
+    (JNIEnv *env,
+     jclass clazz,
+     jlong img)
+{
+    vpx_img_free((vpx_image_t *) (intptr_t) img);
+}
+
+/*
+ * Downscales a plane of sw by sh bytes into a plane of dw by dh bytes by
+ * averaging the source area which each destination sample covers. Used by
+ * img_scale and to feed the layers of the simulcast encoder.
+ */
+static void
+scale_plane_down
+    (const uint8_t *src, int src_stride, int sw, int sh,
+     uint8_t *dst, int dst_stride, int dw, int dh)
+{
+    int x, y;
+
+    for (y = 0; y < dh; y++)
+    {
+        int y0 = y * sh / dh;
+        int y1 = (y + 1) * sh / dh;
+
+        if (y1 <= y0)
+            y1 = y0 + 1;
+        for (x = 0; x < dw; x++)
+        {
+            int x0 = x * sw / dw;
+            int x1 = (x + 1) * sw / dw;
+            unsigned int sum = 0;
+            unsigned int count;
+            int i, j;
+
+            if (x1 <= x0)
+                x1 = x0 + 1;
+            count = (x1 - x0) * (y1 - y0);
+            for (j = y0; j < y1; j++)
+            {
+                const uint8_t *row = src + (size_t) j * src_stride;
+
+                for (i = x0; i < x1; i++)
+                    sum += row[i];
+            }
+            dst[x] = (uint8_t) ((sum + count / 2) / count);
+        }
+        dst += dst_stride;
+    }
+}
+
+static void
+scale_image_down(const vpx_image_t *src, vpx_image_t *dst)
+{
+    int p;
+
+    for (p = 0; p < 3; p++)
+    {
+        int shift = p ? 1 : 0;
+
+        scale_plane_down(
+                src->planes[p], src->stride[p],
+                (src->d_w + shift) >> shift, (src->d_h + shift) >> shift,
+                dst->planes[p], dst->stride[p],
+                (dst->d_w + shift) >> shift, (dst->d_h + shift) >> shift);
+    }
+}
+
+/*
+ * Method:    img_scale
+ */
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_img_1scale
+    (JNIEnv *env,
+     jclass clazz,
+     jlong src,
+     jlong dst)
+{
+    const vpx_image_t *s = (const vpx_image_t *) (intptr_t) src;
+    vpx_image_t *d = (vpx_image_t *) (intptr_t) dst;
+
+    if (s->fmt != VPX_IMG_FMT_I420
+            || d->fmt != VPX_IMG_FMT_I420
+            || d->d_w == 0
+            || d->d_h == 0
+            || d->d_w > s->d_w
+            || d->d_h > s->d_h)
+        return -VPX_CODEC_INVALID_PARAM;
+
+    scale_image_down(s, d);
+    return 0;
+}
+
 /*
  * Method:    codec_dec_cfg_malloc
  */
@@ -489,68 +1215,1379 @@ Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1dec_1cfg_1set_1h
 }
 
 /*
- * Method:    codec_enc_cfg_malloc
+ * Method:    codec_dec_cfg_set_threads
  */
-JNIEXPORT jlong JNICALL
-Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1enc_1cfg_1malloc
-    (JNIEnv *env, jclass clazz)
+JNIEXPORT void JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1dec_1cfg_1set_1threads
+    (JNIEnv *env,
+     jclass clazz,
+     jlong cfg,
+     jint threads)
 {
-    return (jlong) (intptr_t) malloc(sizeof(vpx_codec_enc_cfg_t));
+    ((vpx_codec_dec_cfg_t *) (intptr_t) cfg)->threads = threads;
 }
 
+DEFINE_CODEC_INT_CONTROL_SETTER(dec_1set_1row_1mt, VP9D_SET_ROW_MT, int)
 
 /*
- * Method:    codec_enc_config_default
+ * Method:    codec_dec_get_frame_corrupted
  */
 JNIEXPORT jint JNICALL
-Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1enc_1config_1default
+Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1dec_1get_1frame_1corrupted
     (JNIEnv *env,
      jclass clazz,
-     jint iface,
-     jlong cfg,
-     jint usage)
+     jlong context)
 {
-    return vpx_codec_enc_config_default(
-                     GET_INTERFACE(iface),
-                     (vpx_codec_enc_cfg_t *) (intptr_t) cfg,
-                     (int) usage);
+    int corrupted = 0;
+    vpx_codec_err_t ret
+        = vpx_codec_control(
+                (vpx_codec_ctx_t *) (intptr_t) context,
+                VP8D_GET_FRAME_CORRUPTED,
+                &corrupted);
+
+    return (ret == VPX_CODEC_OK) ? (jint) (corrupted != 0) : -((jint) ret);
 }
 
-DEFINE_ENC_CFG_INT_PROPERTY_SETTER(profile, g_profile)
-DEFINE_ENC_CFG_INT_PROPERTY_SETTER(threads, g_threads)
-DEFINE_ENC_CFG_INT_PROPERTY_SETTER(w, g_w)
-DEFINE_ENC_CFG_INT_PROPERTY_SETTER(h, g_h)
+/*
+ * A pool of frame buffers which a decoder allocates decoded frames into (see
+ * vpx_codec_set_frame_buffer_functions). A buffer is in use while libvpx or
+ * the application holds a reference to it, so the application can read a
+ * decoded frame in place after the decoder has moved on to the next one.
+ * The pool is freed once its owner has released it and the application
+ * holds no more references to its buffers. The reference counts are updated
+ * atomically because frames may be released on other threads than the one
+ * which decodes.
+ */
+struct frame_buffer_pool;
+
+typedef struct frame_buffer
+{
+    struct frame_buffer_pool *pool;
+    uint8_t *data;
+    size_t size;
+    volatile int ref_count;
+    int w;
+    int h;
+    unsigned char *planes[3];
+    int stride[3];
+} frame_buffer_t;
+
+typedef struct frame_buffer_pool
+{
+    int size;
+    /* The owner's reference plus the application's references to buffers. */
+    volatile int ref_count;
+    frame_buffer_t
+        buffers[org_jitsi_impl_neomedia_codec_video_VPX_FRAME_BUFFER_POOL_MAX_SIZE];
+} frame_buffer_pool_t;
+
+static void
+frame_buffer_pool_unref(frame_buffer_pool_t *pool)
+{
+    int i;
+
+    if (__sync_sub_and_fetch(&pool->ref_count, 1) != 0)
+        return;
+    for (i = 0; i < pool->size; i++)
+        free(pool->buffers[i].data);
+    free(pool);
+}
+
+static int
+frame_buffer_pool_get
+    (void *priv, size_t min_size, vpx_codec_frame_buffer_t *fb)
+{
+    frame_buffer_pool_t *pool = (frame_buffer_pool_t *) priv;
+    int i;
+
+    for (i = 0; i < pool->size; i++)
+    {
+        frame_buffer_t *buffer = &pool->buffers[i];
+
+        if (!__sync_bool_compare_and_swap(&buffer->ref_count, 0, 1))
+            continue;
+
+        /* libvpx requires newly allocated memory to be zeroed. */
+        if (buffer->size < min_size)
+        {
+            free(buffer->data);
+            buffer->data = calloc(min_size, 1);
+            if (!buffer->data)
+            {
+                buffer->size = 0;
+                __sync_sub_and_fetch(&buffer->ref_count, 1);
+                return -1;
+            }
+            buffer->size = min_size;
+        }
+        fb->data = buffer->data;
+        fb->size = buffer->size;
+        fb->priv = buffer;
+        return 0;
+    }
+    return -1;
+}
+
+static int
+frame_buffer_pool_release(void *priv, vpx_codec_frame_buffer_t *fb)
+{
+    frame_buffer_t *buffer = (frame_buffer_t *) fb->priv;
+
+    if (buffer)
+        __sync_sub_and_fetch(&buffer->ref_count, 1);
+    return 0;
+}
 
 /*
- * Method:    codec_enc_cfg_set_error_resilient
+ * Method:    frame_buffer_pool_malloc
+ */
+JNIEXPORT jlong JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_frame_1buffer_1pool_1malloc
+    (JNIEnv *env,
+     jclass clazz,
+     jint size)
+{
+    frame_buffer_pool_t *pool;
+    int i;
+
+    if (size < 1
+            || size
+                > org_jitsi_impl_neomedia_codec_video_VPX_FRAME_BUFFER_POOL_MAX_SIZE)
+        return 0;
+
+    pool = calloc(1, sizeof(frame_buffer_pool_t));
+    if (pool)
+    {
+        pool->size = (int) size;
+        pool->ref_count = 1;
+        for (i = 0; i < pool->size; i++)
+            pool->buffers[i].pool = pool;
+    }
+    return (jlong) (intptr_t) pool;
+}
+
+/*
+ * Method:    frame_buffer_pool_free
  */
 JNIEXPORT void JNICALL
-Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1enc_1cfg_1set_1error_1resilient
+Java_org_jitsi_impl_neomedia_codec_video_VPX_frame_1buffer_1pool_1free
     (JNIEnv *env,
      jclass clazz,
-     jlong cfg,
-     jint flags)
+     jlong pool)
 {
-    ((vpx_codec_enc_cfg_t *) (intptr_t) cfg)->g_error_resilient
-        = (vpx_codec_er_flags_t) flags;
+    if (pool)
+        frame_buffer_pool_unref((frame_buffer_pool_t *) (intptr_t) pool);
 }
 
-DEFINE_ENC_CFG_INT_PROPERTY_SETTER(rc_1target_1bitrate, rc_target_bitrate)
-DEFINE_ENC_CFG_INT_PROPERTY_SETTER(rc_1dropframe_1thresh, rc_dropframe_thresh)
-DEFINE_ENC_CFG_INT_PROPERTY_SETTER(rc_1resize_1allowed, rc_resize_allowed)
-DEFINE_ENC_CFG_INT_PROPERTY_SETTER(rc_1resize_1up_1thresh, rc_resize_up_thresh)
-DEFINE_ENC_CFG_INT_PROPERTY_SETTER(rc_1resize_1down_1thresh, rc_resize_down_thresh)
-DEFINE_ENC_CFG_INT_PROPERTY_SETTER(rc_1end_1usage, rc_end_usage)
-DEFINE_ENC_CFG_INT_PROPERTY_SETTER(rc_1min_1quantizer, rc_min_quantizer)
-DEFINE_ENC_CFG_INT_PROPERTY_SETTER(rc_1max_1quantizer, rc_max_quantizer)
-DEFINE_ENC_CFG_INT_PROPERTY_SETTER(rc_1undershoot_1pct, rc_undershoot_pct)
-DEFINE_ENC_CFG_INT_PROPERTY_SETTER(rc_1overshoot_1pct, rc_overshoot_pct)
-DEFINE_ENC_CFG_INT_PROPERTY_SETTER(rc_1buf_1sz, rc_buf_sz)
-DEFINE_ENC_CFG_INT_PROPERTY_SETTER(rc_1buf_1initial_1sz, rc_buf_initial_sz)
-DEFINE_ENC_CFG_INT_PROPERTY_SETTER(rc_1buf_1optimal_1sz, rc_buf_optimal_sz)
-DEFINE_ENC_CFG_INT_PROPERTY_SETTER(kf_1mode, kf_mode)
-DEFINE_ENC_CFG_INT_PROPERTY_SETTER(kf_1min_1dist, kf_min_dist)
-DEFINE_ENC_CFG_INT_PROPERTY_SETTER(kf_1max_1dist, kf_max_dist)
+/*
+ * Method:    codec_set_frame_buffer_pool
+ */
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1set_1frame_1buffer_1pool
+    (JNIEnv *env,
+     jclass clazz,
+     jlong context,
+     jlong pool)
+{
+    return (jint) vpx_codec_set_frame_buffer_functions(
+                (vpx_codec_ctx_t *) (intptr_t) context,
+                frame_buffer_pool_get,
+                frame_buffer_pool_release,
+                (void *) (intptr_t) pool);
+}
+
+/*
+ * Method:    img_ref_frame_buffer
+ */
+JNIEXPORT jlong JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_img_1ref_1frame_1buffer
+    (JNIEnv *env,
+     jclass clazz,
+     jlong jpool,
+     jlong jimg)
+{
+    frame_buffer_pool_t *pool = (frame_buffer_pool_t *) (intptr_t) jpool;
+    vpx_image_t *img = (vpx_image_t *) (intptr_t) jimg;
+    frame_buffer_t *buffer = NULL;
+    int i;
+
+    /* fb_priv is only ours if the decoder allocated the image from the pool;
+       on its internal buffers, libvpx sets it to a structure of its own. */
+    if (!pool || !img->fb_priv)
+        return 0;
+    for (i = 0; i < pool->size; i++)
+    {
+        if (img->fb_priv == &pool->buffers[i])
+        {
+            buffer = &pool->buffers[i];
+            break;
+        }
+    }
+    if (!buffer)
+        return 0;
+
+    __sync_add_and_fetch(&buffer->pool->ref_count, 1);
+    __sync_add_and_fetch(&buffer->ref_count, 1);
+
+    /* The vpx_image_t is only valid until the next decode, so remember where
+       the frame lives in the buffer. */
+    buffer->w = (int) img->d_w;
+    buffer->h = (int) img->d_h;
+    for (i = 0; i < 3; i++)
+    {
+        buffer->planes[i] = img->planes[i];
+        buffer->stride[i] = img->stride[i];
+    }
+    return (jlong) (intptr_t) buffer;
+}
+
+/*
+ * Method:    frame_buffer_ref
+ */
+JNIEXPORT void JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_frame_1buffer_1ref
+    (JNIEnv *env,
+     jclass clazz,
+     jlong fb)
+{
+    frame_buffer_t *buffer = (frame_buffer_t *) (intptr_t) fb;
+
+    __sync_add_and_fetch(&buffer->pool->ref_count, 1);
+    __sync_add_and_fetch(&buffer->ref_count, 1);
+}
+
+/*
+ * Method:    frame_buffer_release
+ */
+JNIEXPORT void JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_frame_1buffer_1release
+    (JNIEnv *env,
+     jclass clazz,
+     jlong fb)
+{
+    frame_buffer_t *buffer = (frame_buffer_t *) (intptr_t) fb;
+
+    __sync_sub_and_fetch(&buffer->ref_count, 1);
+    frame_buffer_pool_unref(buffer->pool);
+}
+
+/*
+ * Method:    frame_buffer_get_w
+ */
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_frame_1buffer_1get_1w
+    (JNIEnv *env,
+     jclass clazz,
+     jlong fb)
+{
+    return (jint) ((frame_buffer_t *) (intptr_t) fb)->w;
+}
+
+/*
+ * Method:    frame_buffer_get_h
+ */
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_frame_1buffer_1get_1h
+    (JNIEnv *env,
+     jclass clazz,
+     jlong fb)
+{
+    return (jint) ((frame_buffer_t *) (intptr_t) fb)->h;
+}
+
+/*
+ * Method:    frame_buffer_get_stride
+ */
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_frame_1buffer_1get_1stride
+    (JNIEnv *env,
+     jclass clazz,
+     jlong fb,
+     jint plane)
+{
+    if (plane < 0 || plane > 2)
+        return 0;
+    return (jint) ((frame_buffer_t *) (intptr_t) fb)->stride[plane];
+}
+
+/*
+ * Method:    frame_buffer_get_plane
+ */
+JNIEXPORT jobject JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_frame_1buffer_1get_1plane
+    (JNIEnv *env,
+     jclass clazz,
+     jlong fb,
+     jint plane)
+{
+    frame_buffer_t *buffer = (frame_buffer_t *) (intptr_t) fb;
+    int rows;
+
+    if (plane < 0 || plane > 2 || !buffer->planes[plane])
+        return NULL;
+
+    /* I420: the chroma planes have half the height, rounded up. */
+    rows = (plane == 0) ? buffer->h : (buffer->h + 1) / 2;
+    return
+        (*env)->NewDirectByteBuffer(
+                env,
+                buffer->planes[plane],
+                (jlong) buffer->stride[plane] * rows);
+}
+
+/*
+ * A packet held by a frame assembler, in the slot for its sequence number
+ * modulo the window size.
+ */
+typedef struct
+{
+    /* The RTP sequence number, or -1 if the slot is empty. */
+    int seq;
+    uint32_t timestamp;
+    int marker;
+    /* Whether the packet starts a frame, i.e. has S set and PartID 0. */
+    int start;
+    /* FRAME_IS_* flags and TID taken from the descriptor of a start packet. */
+    int flags;
+    int tid;
+    int length;
+    unsigned char
+        data[org_jitsi_impl_neomedia_codec_video_VPX_FRAME_ASSEMBLER_MAX_PAYLOAD_SIZE];
+} frame_assembler_slot_t;
+
+typedef struct
+{
+    /*
+     * The packets which could not be appended to the frame being assembled
+     * in place because they arrived out of order.
+     */
+    frame_assembler_slot_t
+        slots[org_jitsi_impl_neomedia_codec_video_VPX_FRAME_ASSEMBLER_WINDOW];
+    /* The last sequence number of the last assembled frame, or -1. */
+    int last_seq;
+    /*
+     * The frame being assembled in place, i.e. which packets received in
+     * order are copied into straight from the Java array: the sequence
+     * numbers of its first packet and of the packet expected next (-1 if
+     * there is no such frame), its RTP timestamp, flags and TID.
+     */
+    int first_seq;
+    int next_seq;
+    uint32_t timestamp;
+    int flags;
+    int tid;
+    unsigned char *frame;
+    size_t frame_size;
+    size_t frame_capacity;
+    /*
+     * The last assembled frame, which frame_assembler_get_frame returns. The
+     * buffers grow as needed, so the size of a frame assembled in place is
+     * not limited by the window.
+     */
+    unsigned char *ready;
+    size_t ready_size;
+    size_t ready_capacity;
+} frame_assembler_t;
+
+#define FRAME_ASSEMBLER_SLOT(fa, seq) \
+    (&(fa)->slots[(seq) \
+        & (org_jitsi_impl_neomedia_codec_video_VPX_FRAME_ASSEMBLER_WINDOW - 1)])
+
+/* Compares RTP sequence numbers, taking wrapping into account. */
+static int
+seq_diff(int a, int b)
+{
+    return (int) (int16_t) (uint16_t) (a - b);
+}
+
+/*
+ * Parses the VP8 payload descriptor (RFC 7741, 4.2) at the start of an RTP
+ * payload. Returns its size, or -1 if it is not valid.
+ */
+static int
+parse_payload_descriptor
+    (const unsigned char *buf, int len, int *start, int *flags, int *tid)
+{
+    int size = 1;
+
+    if (len < 1)
+        return -1;
+    *start = (buf[0] & 0x10) && (buf[0] & 0x0F) == 0;
+    *flags
+        = (buf[0] & 0x20)
+            ? org_jitsi_impl_neomedia_codec_video_VPX_FRAME_IS_DROPPABLE
+            : 0;
+    *tid = -1;
+    if (buf[0] & 0x80)
+    {
+        unsigned char x;
+
+        if (len < 2)
+            return -1;
+        x = buf[1];
+        size = 2;
+        if (x & 0x80) /* I: PictureID, 7 or 15 bits */
+        {
+            if (len < size + 1)
+                return -1;
+            size += (buf[size] & 0x80) ? 2 : 1;
+        }
+        if (x & 0x40) /* L: TL0PICIDX */
+            size++;
+        if (x & 0x30) /* T or K: TID/Y/KEYIDX */
+        {
+            if (len < size + 1)
+                return -1;
+            if (x & 0x20)
+            {
+                *tid = buf[size] >> 6;
+                if (buf[size] & 0x20)
+                {
+                    *flags
+                        |= org_jitsi_impl_neomedia_codec_video_VPX_FRAME_IS_LAYER_SYNC;
+                }
+            }
+            size++;
+        }
+        if (len < size)
+            return -1;
+    }
+    /* RFC 6386, 9.1: bit 0 of the frame tag is 0 for keyframes. */
+    if (*start && len > size && !(buf[size] & 0x01))
+        *flags |= org_jitsi_impl_neomedia_codec_video_VPX_FRAME_IS_KEY;
+    return size;
+}
+
+/*
+ * Makes a buffer at least size bytes large, keeping its contents. Returns 0
+ * on success.
+ */
+static int
+frame_assembler_reserve(unsigned char **buf, size_t *capacity, size_t size)
+{
+    size_t new_capacity = *capacity ? *capacity : 65536;
+    unsigned char *new_buf;
+
+    if (size <= *capacity)
+        return 0;
+    while (new_capacity < size)
+        new_capacity *= 2;
+    new_buf = realloc(*buf, new_capacity);
+    if (!new_buf)
+        return -1;
+    *buf = new_buf;
+    *capacity = new_capacity;
+    return 0;
+}
+
+/*
+ * Drops the packets of incomplete frames which are older than a frame whose
+ * first packet has sequence number first. Returns the FRAME_ASSEMBLER_*
+ * status.
+ */
+static jint
+frame_assembler_drop_older(frame_assembler_t *fa, int first)
+{
+    jint status = 0;
+    int n;
+
+    if (fa->next_seq != -1 && seq_diff(fa->first_seq, first) < 0)
+    {
+        fa->next_seq = -1;
+        status = org_jitsi_impl_neomedia_codec_video_VPX_FRAME_ASSEMBLER_FRAME_DROPPED;
+    }
+    for (n = 0;
+            n < org_jitsi_impl_neomedia_codec_video_VPX_FRAME_ASSEMBLER_WINDOW;
+            n++)
+    {
+        frame_assembler_slot_t *slot = &fa->slots[n];
+
+        if (slot->seq != -1 && seq_diff(slot->seq, first) < 0)
+        {
+            slot->seq = -1;
+            status
+                = org_jitsi_impl_neomedia_codec_video_VPX_FRAME_ASSEMBLER_FRAME_DROPPED;
+        }
+    }
+    return status;
+}
+
+/*
+ * Appends the held packets which follow the frame being assembled in place,
+ * and completes it if it has received its last packet. Returns the
+ * FRAME_ASSEMBLER_* status.
+ */
+static jint
+frame_assembler_append_held(
+        frame_assembler_t *fa,
+        int marker,
+        jlong *info)
+{
+    jint status
+        = org_jitsi_impl_neomedia_codec_video_VPX_FRAME_ASSEMBLER_FRAME_READY;
+    unsigned char *buf;
+    size_t capacity;
+    int last;
+
+    while (!marker)
+    {
+        frame_assembler_slot_t *slot = FRAME_ASSEMBLER_SLOT(fa, fa->next_seq);
+
+        if (slot->seq != fa->next_seq || slot->timestamp != fa->timestamp)
+            return 0;
+        if (frame_assembler_reserve(
+                &fa->frame,
+                &fa->frame_capacity,
+                fa->frame_size + slot->length))
+        {
+            fa->next_seq = -1;
+            return
+                org_jitsi_impl_neomedia_codec_video_VPX_FRAME_ASSEMBLER_FRAME_DROPPED;
+        }
+        memcpy(fa->frame + fa->frame_size, slot->data, slot->length);
+        fa->frame_size += slot->length;
+        marker = slot->marker;
+        slot->seq = -1;
+        fa->next_seq = (fa->next_seq + 1) & 0xFFFF;
+    }
+
+    /* The assembled frame is handed out and the next one built in place. */
+    last = (fa->next_seq - 1) & 0xFFFF;
+    buf = fa->ready;
+    capacity = fa->ready_capacity;
+    fa->ready = fa->frame;
+    fa->ready_capacity = fa->frame_capacity;
+    fa->ready_size = fa->frame_size;
+    fa->frame = buf;
+    fa->frame_capacity = capacity;
+    fa->frame_size = 0;
+    fa->next_seq = -1;
+
+    info[0] = (jlong) fa->ready_size;
+    info[1] = (jlong) fa->timestamp;
+    info[2] = last;
+    info[3] = fa->tid;
+    info[4] = fa->flags;
+
+    /* The packets of older frames are of no use anymore. */
+    status |= frame_assembler_drop_older(fa, fa->first_seq);
+    fa->last_seq = last;
+    return status;
+}
+
+/*
+ * Starts assembling in place the frame which the packet with sequence number
+ * seq belongs to, from its held packets, if they are all held from the one
+ * starting the frame to the one preceding seq.
+ */
+static void
+frame_assembler_resume(frame_assembler_t *fa, int seq, uint32_t timestamp)
+{
+    frame_assembler_slot_t *slot;
+    int first = seq;
+    int n;
+
+    for (n = 0;; n++)
+    {
+        first = (first - 1) & 0xFFFF;
+        slot = FRAME_ASSEMBLER_SLOT(fa, first);
+        if (n == org_jitsi_impl_neomedia_codec_video_VPX_FRAME_ASSEMBLER_WINDOW
+                || slot->seq != first
+                || slot->timestamp != timestamp)
+            return;
+        if (slot->start)
+            break;
+    }
+
+    fa->first_seq = first;
+    fa->next_seq = first;
+    fa->timestamp = timestamp;
+    fa->flags = slot->flags;
+    fa->tid = slot->tid;
+    fa->frame_size = 0;
+    while (fa->next_seq != seq)
+    {
+        slot = FRAME_ASSEMBLER_SLOT(fa, fa->next_seq);
+        if (frame_assembler_reserve(
+                &fa->frame,
+                &fa->frame_capacity,
+                fa->frame_size + slot->length))
+        {
+            fa->next_seq = -1;
+            return;
+        }
+        memcpy(fa->frame + fa->frame_size, slot->data, slot->length);
+        fa->frame_size += slot->length;
+        slot->seq = -1;
+        fa->next_seq = (fa->next_seq + 1) & 0xFFFF;
+    }
+}
+
+/*
+ * Assembles the frame which the held packet with sequence number seq belongs
+ * to, if all of its packets are held. Returns the FRAME_ASSEMBLER_* status.
+ */
+static jint
+frame_assembler_assemble(frame_assembler_t *fa, int seq, jlong *info)
+{
+    frame_assembler_slot_t *slot = FRAME_ASSEMBLER_SLOT(fa, seq);
+    uint32_t timestamp = slot->timestamp;
+    int first = seq;
+    int last = seq;
+    int n;
+    size_t size = 0;
+    jint status = org_jitsi_impl_neomedia_codec_video_VPX_FRAME_ASSEMBLER_FRAME_READY;
+
+    /* Look for the first and the last packets of the frame. */
+    for (n = 0;; n++)
+    {
+        slot = FRAME_ASSEMBLER_SLOT(fa, first);
+        if (n == org_jitsi_impl_neomedia_codec_video_VPX_FRAME_ASSEMBLER_WINDOW
+                || slot->seq != first
+                || slot->timestamp != timestamp)
+            return 0;
+        size += slot->length;
+        if (slot->start)
+            break;
+        first = (first - 1) & 0xFFFF;
+    }
+    for (n = 0;; n++)
+    {
+        slot = FRAME_ASSEMBLER_SLOT(fa, last);
+        if (n == org_jitsi_impl_neomedia_codec_video_VPX_FRAME_ASSEMBLER_WINDOW
+                || slot->seq != last
+                || slot->timestamp != timestamp)
+            return 0;
+        if (last != seq)
+            size += slot->length;
+        if (slot->marker)
+            break;
+        last = (last + 1) & 0xFFFF;
+    }
+    if (frame_assembler_reserve(&fa->ready, &fa->ready_capacity, size))
+        return 0;
+
+    slot = FRAME_ASSEMBLER_SLOT(fa, first);
+    info[3] = slot->tid;
+    info[4] = slot->flags;
+    fa->ready_size = 0;
+    for (seq = first;; seq = (seq + 1) & 0xFFFF)
+    {
+        slot = FRAME_ASSEMBLER_SLOT(fa, seq);
+        memcpy(fa->ready + fa->ready_size, slot->data, slot->length);
+        fa->ready_size += slot->length;
+        slot->seq = -1;
+        if (seq == last)
+            break;
+    }
+    info[0] = (jlong) fa->ready_size;
+    info[1] = (jlong) timestamp;
+    info[2] = last;
+
+    /*
+     * The packets of older frames, including the one being assembled in
+     * place, are of no use anymore.
+     */
+    status |= frame_assembler_drop_older(fa, first);
+    fa->last_seq = last;
+    return status;
+}
+
+static void
+frame_assembler_clear(frame_assembler_t *fa)
+{
+    int i;
+
+    for (i = 0;
+            i < org_jitsi_impl_neomedia_codec_video_VPX_FRAME_ASSEMBLER_WINDOW;
+            i++)
+        fa->slots[i].seq = -1;
+    fa->last_seq = -1;
+    fa->next_seq = -1;
+    fa->frame_size = 0;
+    fa->ready_size = 0;
+}
+
+/*
+ * Method:    frame_assembler_malloc
+ */
+JNIEXPORT jlong JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_frame_1assembler_1malloc
+    (JNIEnv *env,
+     jclass clazz)
+{
+    frame_assembler_t *fa = calloc(1, sizeof(frame_assembler_t));
+
+    if (fa)
+        frame_assembler_clear(fa);
+    return (jlong) (intptr_t) fa;
+}
+
+/*
+ * Method:    frame_assembler_free
+ */
+JNIEXPORT void JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_frame_1assembler_1free
+    (JNIEnv *env,
+     jclass clazz,
+     jlong assembler)
+{
+    frame_assembler_t *fa = (frame_assembler_t *) (intptr_t) assembler;
+
+    if (fa)
+    {
+        free(fa->frame);
+        free(fa->ready);
+        free(fa);
+    }
+}
+
+/*
+ * Method:    frame_assembler_reset
+ */
+JNIEXPORT void JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_frame_1assembler_1reset
+    (JNIEnv *env,
+     jclass clazz,
+     jlong assembler)
+{
+    frame_assembler_clear((frame_assembler_t *) (intptr_t) assembler);
+}
+
+/*
+ * Method:    frame_assembler_push
+ */
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_frame_1assembler_1push
+    (JNIEnv *env,
+     jclass clazz,
+     jlong assembler,
+     jbyteArray buf,
+     jint buf_offset,
+     jint buf_size,
+     jint seq,
+     jlong timestamp,
+     jboolean marker,
+     jlongArray info)
+{
+    frame_assembler_t *fa = (frame_assembler_t *) (intptr_t) assembler;
+    frame_assembler_slot_t *slot;
+    /* The payload descriptor and the first octet of the payload header. */
+    unsigned char
+        pd[org_jitsi_impl_neomedia_codec_video_VPX_MAX_PAYLOAD_DESCRIPTOR_LENGTH
+            + 1];
+    jint pd_length = (buf_size < (jint) sizeof(pd)) ? buf_size : sizeof(pd);
+    int pd_size;
+    int start, flags, tid;
+    jint length;
+    jlong frame_info[
+            org_jitsi_impl_neomedia_codec_video_VPX_ASSEMBLED_FRAME_INFO_LENGTH];
+    jint status = 0;
+
+    if (buf_offset < 0
+            || buf_size < 0
+            || buf_offset > (*env)->GetArrayLength(env, buf) - buf_size
+            || (*env)->GetArrayLength(env, info)
+                < org_jitsi_impl_neomedia_codec_video_VPX_ASSEMBLED_FRAME_INFO_LENGTH)
+        return -VPX_CODEC_INVALID_PARAM;
+
+    seq &= 0xFFFF;
+    if (fa->last_seq != -1)
+    {
+        int diff = seq_diff(seq, fa->last_seq);
+
+        /*
+         * A packet up to a window behind the last assembled frame is late or
+         * a duplicate. One further away means that the sender has jumped,
+         * e.g. by more than half the sequence number space or after a
+         * restart, and nothing held is of use anymore.
+         */
+        if (diff <= 0)
+        {
+            if (diff
+                    > -org_jitsi_impl_neomedia_codec_video_VPX_FRAME_ASSEMBLER_WINDOW)
+            {
+                return
+                    org_jitsi_impl_neomedia_codec_video_VPX_FRAME_ASSEMBLER_DISCARDED;
+            }
+            frame_assembler_clear(fa);
+            status
+                = org_jitsi_impl_neomedia_codec_video_VPX_FRAME_ASSEMBLER_FRAME_DROPPED;
+        }
+    }
+
+    (*env)->GetByteArrayRegion(env, buf, buf_offset, pd_length, (jbyte *) pd);
+    pd_size = parse_payload_descriptor(pd, pd_length, &start, &flags, &tid);
+    length = buf_size - pd_size;
+    if (pd_size < 0
+            || length < 1
+            || length
+                > org_jitsi_impl_neomedia_codec_video_VPX_FRAME_ASSEMBLER_MAX_PAYLOAD_SIZE)
+        return org_jitsi_impl_neomedia_codec_video_VPX_FRAME_ASSEMBLER_DISCARDED;
+
+    if (fa->next_seq != -1)
+    {
+        int diff = seq_diff(seq, fa->next_seq);
+
+        if (diff < 0 && seq_diff(seq, fa->first_seq) >= 0)
+        {
+            return
+                org_jitsi_impl_neomedia_codec_video_VPX_FRAME_ASSEMBLER_DISCARDED;
+        }
+        /*
+         * The frame being assembled in place cannot be completed if the
+         * packet it expects next has been followed by one of another frame
+         * or has been missing for so long that the packets which follow it
+         * are no longer held.
+         */
+        if ((diff == 0 && (uint32_t) timestamp != fa->timestamp)
+                || diff
+                    >= org_jitsi_impl_neomedia_codec_video_VPX_FRAME_ASSEMBLER_WINDOW)
+        {
+            fa->next_seq = -1;
+            status
+                |= org_jitsi_impl_neomedia_codec_video_VPX_FRAME_ASSEMBLER_FRAME_DROPPED;
+        }
+    }
+    if (fa->next_seq == -1)
+    {
+        if (start)
+        {
+            fa->first_seq = seq;
+            fa->next_seq = seq;
+            fa->timestamp = (uint32_t) timestamp;
+            fa->flags = flags;
+            fa->tid = tid;
+            fa->frame_size = 0;
+        }
+        else
+        {
+            frame_assembler_resume(fa, seq, (uint32_t) timestamp);
+        }
+    }
+
+    if (fa->next_seq == seq
+            && !frame_assembler_reserve(
+                    &fa->frame,
+                    &fa->frame_capacity,
+                    fa->frame_size + length))
+    {
+        /* The packet continues the frame in order: copy it only once. */
+        (*env)->GetByteArrayRegion(
+                env,
+                buf,
+                buf_offset + pd_size,
+                length,
+                (jbyte *) (fa->frame + fa->frame_size));
+        fa->frame_size += length;
+        fa->next_seq = (seq + 1) & 0xFFFF;
+        status
+            |= frame_assembler_append_held(fa, marker == JNI_TRUE, frame_info);
+    }
+    else
+    {
+        slot = FRAME_ASSEMBLER_SLOT(fa, seq);
+        if (slot->seq == seq)
+        {
+            return
+                status
+                    | org_jitsi_impl_neomedia_codec_video_VPX_FRAME_ASSEMBLER_DISCARDED;
+        }
+
+        /* A packet left over from a window ago is overwritten. */
+        if (slot->seq != -1)
+        {
+            status
+                |= org_jitsi_impl_neomedia_codec_video_VPX_FRAME_ASSEMBLER_FRAME_DROPPED;
+        }
+        slot->seq = seq;
+        slot->timestamp = (uint32_t) timestamp;
+        slot->marker = (marker == JNI_TRUE);
+        slot->start = start;
+        slot->flags = flags;
+        slot->tid = tid;
+        slot->length = length;
+        (*env)->GetByteArrayRegion(
+                env,
+                buf,
+                buf_offset + pd_size,
+                length,
+                (jbyte *) slot->data);
+
+        status |= frame_assembler_assemble(fa, seq, frame_info);
+    }
+
+    if (status
+            & org_jitsi_impl_neomedia_codec_video_VPX_FRAME_ASSEMBLER_FRAME_READY)
+    {
+        (*env)->SetLongArrayRegion(
+                env,
+                info,
+                0,
+                org_jitsi_impl_neomedia_codec_video_VPX_ASSEMBLED_FRAME_INFO_LENGTH,
+                frame_info);
+    }
+    return status;
+}
+
+/*
+ * Method:    frame_assembler_get_frame
+ */
+JNIEXPORT jobject JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_frame_1assembler_1get_1frame
+    (JNIEnv *env,
+     jclass clazz,
+     jlong assembler)
+{
+    frame_assembler_t *fa = (frame_assembler_t *) (intptr_t) assembler;
+
+    if (fa->ready_size == 0)
+        return NULL;
+    return (*env)->NewDirectByteBuffer(env, fa->ready, (jlong) fa->ready_size);
+}
+
+/*
+ * Method:    codec_enc_cfg_malloc
+ */
+JNIEXPORT jlong JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1enc_1cfg_1malloc
+    (JNIEnv *env, jclass clazz)
+{
+    return (jlong) (intptr_t) malloc(sizeof(vpx_codec_enc_cfg_t));
+}
+
+
+/*
+ * Method:    codec_enc_config_default
+ */
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1enc_1config_1default
+    (JNIEnv *env,
+     jclass clazz,
+     jint iface,
+     jlong cfg,
+     jint usage)
+{
+    return vpx_codec_enc_config_default(
+                     GET_INTERFACE(iface),
+                     (vpx_codec_enc_cfg_t *) (intptr_t) cfg,
+                     (int) usage);
+}
+
+DEFINE_ENC_CFG_INT_PROPERTY_SETTER(profile, g_profile)
+DEFINE_ENC_CFG_INT_PROPERTY_SETTER(threads, g_threads)
+DEFINE_ENC_CFG_INT_PROPERTY_SETTER(w, g_w)
+DEFINE_ENC_CFG_INT_PROPERTY_SETTER(h, g_h)
+
+/*
+ * Method:    codec_enc_cfg_set_timebase
+ */
+JNIEXPORT void JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1enc_1cfg_1set_1timebase
+    (JNIEnv *env,
+     jclass clazz,
+     jlong cfg,
+     jint num,
+     jint den)
+{
+    vpx_codec_enc_cfg_t *enc_cfg = (vpx_codec_enc_cfg_t *) (intptr_t) cfg;
+
+    enc_cfg->g_timebase.num = (int) num;
+    enc_cfg->g_timebase.den = (int) den;
+}
+
+/*
+ * Method:    codec_enc_cfg_set_error_resilient
+ */
+JNIEXPORT void JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1enc_1cfg_1set_1error_1resilient
+    (JNIEnv *env,
+     jclass clazz,
+     jlong cfg,
+     jint flags)
+{
+    ((vpx_codec_enc_cfg_t *) (intptr_t) cfg)->g_error_resilient
+        = (vpx_codec_er_flags_t) flags;
+}
+
+DEFINE_ENC_CFG_INT_PROPERTY_SETTER(rc_1target_1bitrate, rc_target_bitrate)
+DEFINE_ENC_CFG_INT_PROPERTY_SETTER(rc_1dropframe_1thresh, rc_dropframe_thresh)
+DEFINE_ENC_CFG_INT_PROPERTY_SETTER(rc_1resize_1allowed, rc_resize_allowed)
+DEFINE_ENC_CFG_INT_PROPERTY_SETTER(rc_1resize_1up_1thresh, rc_resize_up_thresh)
+DEFINE_ENC_CFG_INT_PROPERTY_SETTER(rc_1resize_1down_1thresh, rc_resize_down_thresh)
+DEFINE_ENC_CFG_INT_PROPERTY_SETTER(rc_1end_1usage, rc_end_usage)
+DEFINE_ENC_CFG_INT_PROPERTY_SETTER(rc_1min_1quantizer, rc_min_quantizer)
+DEFINE_ENC_CFG_INT_PROPERTY_SETTER(rc_1max_1quantizer, rc_max_quantizer)
+DEFINE_ENC_CFG_INT_PROPERTY_SETTER(rc_1undershoot_1pct, rc_undershoot_pct)
+DEFINE_ENC_CFG_INT_PROPERTY_SETTER(rc_1overshoot_1pct, rc_overshoot_pct)
+DEFINE_ENC_CFG_INT_PROPERTY_SETTER(rc_1buf_1sz, rc_buf_sz)
+DEFINE_ENC_CFG_INT_PROPERTY_SETTER(rc_1buf_1initial_1sz, rc_buf_initial_sz)
+DEFINE_ENC_CFG_INT_PROPERTY_SETTER(rc_1buf_1optimal_1sz, rc_buf_optimal_sz)
+DEFINE_ENC_CFG_INT_PROPERTY_SETTER(kf_1mode, kf_mode)
+DEFINE_ENC_CFG_INT_PROPERTY_SETTER(kf_1min_1dist, kf_min_dist)
+DEFINE_ENC_CFG_INT_PROPERTY_SETTER(kf_1max_1dist, kf_max_dist)
+
+DEFINE_ENC_CFG_INT_PROPERTY_SETTER(ts_1number_1layers, ts_number_layers)
+DEFINE_ENC_CFG_INT_PROPERTY_SETTER(ts_1periodicity, ts_periodicity)
+DEFINE_ENC_CFG_INT_ARRAY_PROPERTY_SETTER(
+        ts_1target_1bitrate,
+        ts_target_bitrate,
+        VPX_TS_MAX_LAYERS)
+DEFINE_ENC_CFG_INT_ARRAY_PROPERTY_SETTER(
+        ts_1rate_1decimator,
+        ts_rate_decimator,
+        VPX_TS_MAX_LAYERS)
+DEFINE_ENC_CFG_INT_ARRAY_PROPERTY_SETTER(
+        ts_1layer_1id,
+        ts_layer_id,
+        VPX_TS_MAX_PERIODICITY)
+
+DEFINE_CODEC_INT_CONTROL_SETTER(
+        enc_1set_1temporal_1layer_1id,
+        VP8E_SET_TEMPORAL_LAYER_ID,
+        int)
+DEFINE_CODEC_INT_CONTROL_SETTER(enc_1set_1cpu_1used, VP8E_SET_CPUUSED, int)
+DEFINE_CODEC_INT_CONTROL_SETTER(
+        enc_1set_1noise_1sensitivity,
+        VP8E_SET_NOISE_SENSITIVITY,
+        unsigned int)
+DEFINE_CODEC_INT_CONTROL_SETTER(
+        enc_1set_1screen_1content_1mode,
+        VP8E_SET_SCREEN_CONTENT_MODE,
+        unsigned int)
+DEFINE_CODEC_INT_CONTROL_SETTER(
+        enc_1set_1static_1threshold,
+        VP8E_SET_STATIC_THRESHOLD,
+        unsigned int)
+DEFINE_CODEC_INT_CONTROL_SETTER(
+        enc_1set_1token_1partitions,
+        VP8E_SET_TOKEN_PARTITIONS,
+        int)
+
+/*
+ * Method:    codec_enc_get_last_quantizer
+ */
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1enc_1get_1last_1quantizer
+    (JNIEnv *env, jclass clazz, jlong context)
+{
+    int quantizer = 0;
+    vpx_codec_err_t ret
+        = vpx_codec_control(
+                (vpx_codec_ctx_t *) (intptr_t) context,
+                VP8E_GET_LAST_QUANTIZER,
+                &quantizer);
+
+    return (ret == VPX_CODEC_OK) ? (jint) quantizer : -((jint) ret);
+}
+
+/*
+ * Method:    codec_enc_set_active_map
+ */
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1enc_1set_1active_1map
+    (JNIEnv *env,
+     jclass clazz,
+     jlong context,
+     jbyteArray map,
+     jint rows,
+     jint cols)
+{
+    vpx_active_map_t active_map;
+    jbyte *map_ptr = NULL;
+    vpx_codec_err_t ret;
+
+    if (map)
+    {
+        if (rows <= 0
+                || cols <= 0
+                || (*env)->GetArrayLength(env, map) < rows * cols)
+        {
+            return (jint) VPX_CODEC_INVALID_PARAM;
+        }
+        map_ptr = (*env)->GetByteArrayElements(env, map, NULL);
+        if (!map_ptr)
+            return (jint) VPX_CODEC_MEM_ERROR;
+    }
+
+    /* A NULL map disables the active map. libvpx copies the map. */
+    active_map.active_map = (unsigned char *) map_ptr;
+    active_map.rows = (unsigned int) rows;
+    active_map.cols = (unsigned int) cols;
+    ret
+        = vpx_codec_control(
+                (vpx_codec_ctx_t *) (intptr_t) context,
+                VP8E_SET_ACTIVEMAP,
+                &active_map);
+
+    if (map_ptr)
+        (*env)->ReleaseByteArrayElements(env, map, map_ptr, JNI_ABORT);
+    return (jint) ret;
+}
+DEFINE_CODEC_INT_CONTROL_SETTER(enc_1set_1row_1mt, VP9E_SET_ROW_MT, unsigned int)
+DEFINE_CODEC_INT_CONTROL_SETTER(enc_1set_1tile_1columns, VP9E_SET_TILE_COLUMNS, int)
+DEFINE_CODEC_INT_CONTROL_SETTER(
+        enc_1set_1frame_1parallel_1decoding,
+        VP9E_SET_FRAME_PARALLEL_DECODING,
+        unsigned int)
+
+/*
+ * A set of VP8 encoders which encode the same input at several resolutions
+ * using libvpx's multi-resolution encoding. Layer 0 has the highest
+ * resolution; dsf[i] is the down-sampling factor from layer i to layer i + 1.
+ * libvpx encodes the layers from the lowest resolution up, and each layer
+ * reuses the motion analysis of the layer below it.
+ * The contexts and the raw images have to be contiguous, because
+ * vpx_codec_encode walks them as arrays when given ctx[0].
+ */
+typedef struct simulcast
+{
+    int num_layers;
+    int initialized;
+    vpx_codec_ctx_t ctx[org_jitsi_impl_neomedia_codec_video_VPX_SIMULCAST_MAX_LAYERS];
+    vpx_codec_enc_cfg_t cfg[org_jitsi_impl_neomedia_codec_video_VPX_SIMULCAST_MAX_LAYERS];
+    vpx_rational_t dsf[org_jitsi_impl_neomedia_codec_video_VPX_SIMULCAST_MAX_LAYERS];
+    vpx_image_t raw[org_jitsi_impl_neomedia_codec_video_VPX_SIMULCAST_MAX_LAYERS];
+} simulcast_t;
+
+/*
+ * Method:    simulcast_malloc
+ */
+JNIEXPORT jlong JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_simulcast_1malloc
+    (JNIEnv *env,
+     jclass clazz,
+     jint num_layers)
+{
+    simulcast_t *sc;
+    int i;
+
+    if (num_layers < 1
+            || num_layers
+                > org_jitsi_impl_neomedia_codec_video_VPX_SIMULCAST_MAX_LAYERS)
+        return 0;
+
+    sc = calloc(1, sizeof(simulcast_t));
+    if (sc)
+    {
+        sc->num_layers = num_layers;
+        for (i = 0; i < num_layers; i++)
+        {
+            sc->dsf[i].num = 2;
+            sc->dsf[i].den = 1;
+        }
+    }
+    return (jlong) (intptr_t) sc;
+}
+
+/*
+ * Method:    simulcast_get_cfg
+ */
+JNIEXPORT jlong JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_simulcast_1get_1cfg
+    (JNIEnv *env,
+     jclass clazz,
+     jlong jsc,
+     jint layer)
+{
+    simulcast_t *sc = (simulcast_t *) (intptr_t) jsc;
+
+    if (layer < 0 || layer >= sc->num_layers)
+        return 0;
+    return (jlong) (intptr_t) &sc->cfg[layer];
+}
+
+/*
+ * Method:    simulcast_get_ctx
+ */
+JNIEXPORT jlong JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_simulcast_1get_1ctx
+    (JNIEnv *env,
+     jclass clazz,
+     jlong jsc,
+     jint layer)
+{
+    simulcast_t *sc = (simulcast_t *) (intptr_t) jsc;
+
+    if (layer < 0 || layer >= sc->num_layers)
+        return 0;
+    return (jlong) (intptr_t) &sc->ctx[layer];
+}
+
+/*
+ * Method:    simulcast_set_dsf
+ */
+JNIEXPORT void JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_simulcast_1set_1dsf
+    (JNIEnv *env,
+     jclass clazz,
+     jlong jsc,
+     jint layer,
+     jint num,
+     jint den)
+{
+    simulcast_t *sc = (simulcast_t *) (intptr_t) jsc;
+
+    if (layer >= 0 && layer < sc->num_layers && num > 0 && den > 0)
+    {
+        sc->dsf[layer].num = num;
+        sc->dsf[layer].den = den;
+    }
+}
+
+/*
+ * Method:    simulcast_enc_cfg_derive
+ */
+JNIEXPORT void JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_simulcast_1enc_1cfg_1derive
+    (JNIEnv *env,
+     jclass clazz,
+     jlong jsc)
+{
+    simulcast_t *sc = (simulcast_t *) (intptr_t) jsc;
+    int i;
+
+    for (i = 1; i < sc->num_layers; i++)
+    {
+        const vpx_rational_t *dsf = &sc->dsf[i - 1];
+        vpx_codec_enc_cfg_t *cfg = &sc->cfg[i];
+
+        memcpy(cfg, &sc->cfg[i - 1], sizeof(vpx_codec_enc_cfg_t));
+        cfg->g_w = (cfg->g_w * dsf->den + dsf->num - 1) / dsf->num;
+        cfg->g_h = (cfg->g_h * dsf->den + dsf->num - 1) / dsf->num;
+        /* libvpx expects the lower resolutions to have even dimensions. */
+        cfg->g_w += cfg->g_w & 1;
+        cfg->g_h += cfg->g_h & 1;
+    }
+}
+
+/*
+ * Method:    simulcast_enc_init
+ */
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_simulcast_1enc_1init
+    (JNIEnv *env,
+     jclass clazz,
+     jlong jsc,
+     jint iface,
+     jlong flags)
+{
+    simulcast_t *sc = (simulcast_t *) (intptr_t) jsc;
+    vpx_codec_err_t ret;
+    int i;
+
+    if (sc->initialized)
+        return VPX_CODEC_ERROR;
+
+    for (i = 1; i < sc->num_layers; i++)
+    {
+        if (!vpx_img_alloc(&sc->raw[i],
+                           VPX_IMG_FMT_I420,
+                           sc->cfg[i].g_w,
+                           sc->cfg[i].g_h,
+                           32))
+        {
+            while (--i > 0)
+                vpx_img_free(&sc->raw[i]);
+            return VPX_CODEC_MEM_ERROR;
+        }
+    }
+
+    ret = vpx_codec_enc_init_multi(
+            sc->ctx,
+            GET_INTERFACE(iface),
+            sc->cfg,
+            sc->num_layers,
+            (vpx_codec_flags_t) flags,
+            sc->dsf);
+    if (ret == VPX_CODEC_OK)
+        sc->initialized = 1;
+    else
+    {
+        for (i = 1; i < sc->num_layers; i++)
+            vpx_img_free(&sc->raw[i]);
+    }
+    return (jint) ret;
+}
+
+/*
+ * Method:    simulcast_encode
+ */
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_simulcast_1encode
+    (JNIEnv *env,
+     jclass clazz,
+     jlong jsc,
+     jlong jimg,
+     jbyteArray bufArray,
+     jint offset0,
+     jint offset1,
+     jint offset2,
+     jlong pts,
+     jlong duration,
+     jlong flags,
+     jlong deadline)
+{
+    simulcast_t *sc = (simulcast_t *) (intptr_t) jsc;
+    unsigned char *buf;
+    jint ret;
+    int i;
+
+    if (!sc->initialized)
+        return VPX_CODEC_ERROR;
+
+    buf = (unsigned char *) (*env)->GetByteArrayElements(env, bufArray, NULL);
+    if (!buf)
+        return VPX_CODEC_MEM_ERROR;
+
+    sc->raw[0] = *((vpx_image_t *) (intptr_t) jimg);
+    sc->raw[0].planes[0] = (buf + offset0);
+    sc->raw[0].planes[1] = (buf + offset1);
+    sc->raw[0].planes[2] = (buf + offset2);
+    sc->raw[0].planes[3] = 0;
+
+    /* Each layer is scaled from the one above it, rather than from the
+       input, so the work shrinks with every layer. */
+    for (i = 1; i < sc->num_layers; i++)
+        scale_image_down(&sc->raw[i - 1], &sc->raw[i]);
+
+    ret = (jint) vpx_codec_encode(
+                    &sc->ctx[0],
+                    sc->raw,
+                    (vpx_codec_pts_t) pts,
+                    (unsigned long) duration,
+                    (vpx_enc_frame_flags_t) flags,
+                    (unsigned long) deadline);
+
+    (*env)->ReleaseByteArrayElements(env, bufArray, (jbyte *) buf, JNI_ABORT);
+    return ret;
+}
+
+/*
+ * Method:    simulcast_destroy
+ */
+JNIEXPORT void JNICALL
+Java_org_jitsi_impl_neomedia_codec_video_VPX_simulcast_1destroy
+    (JNIEnv *env,
+     jclass clazz,
+     jlong jsc)
+{
+    simulcast_t *sc = (simulcast_t *) (intptr_t) jsc;
+    int i;
+
+    if (!sc)
+        return;
+    if (sc->initialized)
+    {
+        for (i = 0; i < sc->num_layers; i++)
+        {
+            vpx_codec_destroy(&sc->ctx[i]);
+            if (i > 0)
+                vpx_img_free(&sc->raw[i]);
+        }
+    }
+    free(sc);
+}
 
 /*
  * Method:    stream_info_malloc
@@ -9,12 +9,20 @@ extern "C" {
 #endif
 #undef org_jitsi_impl_neomedia_codec_video_VPX_CODEC_OK
 #define org_jitsi_impl_neomedia_codec_video_VPX_CODEC_OK 0L
+#undef org_jitsi_impl_neomedia_codec_video_VPX_CODEC_MEM_ERROR
+#define org_jitsi_impl_neomedia_codec_video_VPX_CODEC_MEM_ERROR 2L
+#undef org_jitsi_impl_neomedia_codec_video_VPX_CODEC_INVALID_PARAM
+#define org_jitsi_impl_neomedia_codec_video_VPX_CODEC_INVALID_PARAM 8L
 #undef org_jitsi_impl_neomedia_codec_video_VPX_CODEC_LIST_END
 #define org_jitsi_impl_neomedia_codec_video_VPX_CODEC_LIST_END 9L
 #undef org_jitsi_impl_neomedia_codec_video_VPX_CODEC_USE_XMA
 #define org_jitsi_impl_neomedia_codec_video_VPX_CODEC_USE_XMA 1L
 #undef org_jitsi_impl_neomedia_codec_video_VPX_CODEC_USE_OUTPUT_PARTITION
 #define org_jitsi_impl_neomedia_codec_video_VPX_CODEC_USE_OUTPUT_PARTITION 131072L
+#undef org_jitsi_impl_neomedia_codec_video_VPX_CODEC_USE_ERROR_CONCEALMENT
+#define org_jitsi_impl_neomedia_codec_video_VPX_CODEC_USE_ERROR_CONCEALMENT 131072L
+#undef org_jitsi_impl_neomedia_codec_video_VPX_CODEC_USE_INPUT_FRAGMENTS
+#define org_jitsi_impl_neomedia_codec_video_VPX_CODEC_USE_INPUT_FRAGMENTS 262144L
 #undef org_jitsi_impl_neomedia_codec_video_VPX_IMG_FMT_I420
 #define org_jitsi_impl_neomedia_codec_video_VPX_IMG_FMT_I420 258L
 #undef org_jitsi_impl_neomedia_codec_video_VPX_RC_MODE_VBR
@@ -31,10 +39,70 @@ extern "C" {
 #define org_jitsi_impl_neomedia_codec_video_VPX_DL_REALTIME 1L
 #undef org_jitsi_impl_neomedia_codec_video_VPX_CODEC_CX_FRAME_PKT
 #define org_jitsi_impl_neomedia_codec_video_VPX_CODEC_CX_FRAME_PKT 0L
+#undef org_jitsi_impl_neomedia_codec_video_VPX_FRAME_IS_KEY
+#define org_jitsi_impl_neomedia_codec_video_VPX_FRAME_IS_KEY 1L
+#undef org_jitsi_impl_neomedia_codec_video_VPX_FRAME_IS_DROPPABLE
+#define org_jitsi_impl_neomedia_codec_video_VPX_FRAME_IS_DROPPABLE 2L
+#undef org_jitsi_impl_neomedia_codec_video_VPX_EFLAG_FORCE_KF
+#define org_jitsi_impl_neomedia_codec_video_VPX_EFLAG_FORCE_KF 1L
+#undef org_jitsi_impl_neomedia_codec_video_VPX_EFLAG_NO_REF_LAST
+#define org_jitsi_impl_neomedia_codec_video_VPX_EFLAG_NO_REF_LAST 65536L
+#undef org_jitsi_impl_neomedia_codec_video_VPX_EFLAG_NO_REF_GF
+#define org_jitsi_impl_neomedia_codec_video_VPX_EFLAG_NO_REF_GF 131072L
+#undef org_jitsi_impl_neomedia_codec_video_VPX_EFLAG_NO_UPD_LAST
+#define org_jitsi_impl_neomedia_codec_video_VPX_EFLAG_NO_UPD_LAST 262144L
+#undef org_jitsi_impl_neomedia_codec_video_VPX_EFLAG_FORCE_GF
+#define org_jitsi_impl_neomedia_codec_video_VPX_EFLAG_FORCE_GF 524288L
+#undef org_jitsi_impl_neomedia_codec_video_VPX_EFLAG_NO_UPD_ENTROPY
+#define org_jitsi_impl_neomedia_codec_video_VPX_EFLAG_NO_UPD_ENTROPY 1048576L
+#undef org_jitsi_impl_neomedia_codec_video_VPX_EFLAG_NO_REF_ARF
+#define org_jitsi_impl_neomedia_codec_video_VPX_EFLAG_NO_REF_ARF 2097152L
+#undef org_jitsi_impl_neomedia_codec_video_VPX_EFLAG_NO_UPD_GF
+#define org_jitsi_impl_neomedia_codec_video_VPX_EFLAG_NO_UPD_GF 4194304L
+#undef org_jitsi_impl_neomedia_codec_video_VPX_EFLAG_NO_UPD_ARF
+#define org_jitsi_impl_neomedia_codec_video_VPX_EFLAG_NO_UPD_ARF 8388608L
+#undef org_jitsi_impl_neomedia_codec_video_VPX_EFLAG_FORCE_ARF
+#define org_jitsi_impl_neomedia_codec_video_VPX_EFLAG_FORCE_ARF 16777216L
+#undef org_jitsi_impl_neomedia_codec_video_VPX_TS_MAX_LAYERS
+#define org_jitsi_impl_neomedia_codec_video_VPX_TS_MAX_LAYERS 5L
+#undef org_jitsi_impl_neomedia_codec_video_VPX_TS_MAX_PERIODICITY
+#define org_jitsi_impl_neomedia_codec_video_VPX_TS_MAX_PERIODICITY 16L
 #undef org_jitsi_impl_neomedia_codec_video_VPX_INTEFACE_VP8_DEC
 #define org_jitsi_impl_neomedia_codec_video_VPX_INTEFACE_VP8_DEC 0L
 #undef org_jitsi_impl_neomedia_codec_video_VPX_INTERFACE_VP8_ENC
 #define org_jitsi_impl_neomedia_codec_video_VPX_INTERFACE_VP8_ENC 1L
+#undef org_jitsi_impl_neomedia_codec_video_VPX_INTERFACE_VP9_DEC
+#define org_jitsi_impl_neomedia_codec_video_VPX_INTERFACE_VP9_DEC 2L
+#undef org_jitsi_impl_neomedia_codec_video_VPX_INTERFACE_VP9_ENC
+#define org_jitsi_impl_neomedia_codec_video_VPX_INTERFACE_VP9_ENC 3L
+#undef org_jitsi_impl_neomedia_codec_video_VPX_SIMULCAST_MAX_LAYERS
+#define org_jitsi_impl_neomedia_codec_video_VPX_SIMULCAST_MAX_LAYERS 4L
+#undef org_jitsi_impl_neomedia_codec_video_VPX_FRAME_BUFFER_POOL_MAX_SIZE
+#define org_jitsi_impl_neomedia_codec_video_VPX_FRAME_BUFFER_POOL_MAX_SIZE 32L
+#undef org_jitsi_impl_neomedia_codec_video_VPX_MAX_FRAGMENTS
+#define org_jitsi_impl_neomedia_codec_video_VPX_MAX_FRAGMENTS 9L
+#undef org_jitsi_impl_neomedia_codec_video_VPX_DECODE_EXPORT_HEADER_SIZE
+#define org_jitsi_impl_neomedia_codec_video_VPX_DECODE_EXPORT_HEADER_SIZE 12L
+#undef org_jitsi_impl_neomedia_codec_video_VPX_CX_PKT_INFO_LENGTH
+#define org_jitsi_impl_neomedia_codec_video_VPX_CX_PKT_INFO_LENGTH 4L
+#undef org_jitsi_impl_neomedia_codec_video_VPX_MAX_PAYLOAD_DESCRIPTOR_LENGTH
+#define org_jitsi_impl_neomedia_codec_video_VPX_MAX_PAYLOAD_DESCRIPTOR_LENGTH 6L
+#undef org_jitsi_impl_neomedia_codec_video_VPX_PAYLOAD_END_OF_FRAME
+#define org_jitsi_impl_neomedia_codec_video_VPX_PAYLOAD_END_OF_FRAME 65536L
+#undef org_jitsi_impl_neomedia_codec_video_VPX_FRAME_IS_LAYER_SYNC
+#define org_jitsi_impl_neomedia_codec_video_VPX_FRAME_IS_LAYER_SYNC 131072L
+#undef org_jitsi_impl_neomedia_codec_video_VPX_FRAME_ASSEMBLER_WINDOW
+#define org_jitsi_impl_neomedia_codec_video_VPX_FRAME_ASSEMBLER_WINDOW 128L
+#undef org_jitsi_impl_neomedia_codec_video_VPX_FRAME_ASSEMBLER_MAX_PAYLOAD_SIZE
+#define org_jitsi_impl_neomedia_codec_video_VPX_FRAME_ASSEMBLER_MAX_PAYLOAD_SIZE 1500L
+#undef org_jitsi_impl_neomedia_codec_video_VPX_FRAME_ASSEMBLER_FRAME_READY
+#define org_jitsi_impl_neomedia_codec_video_VPX_FRAME_ASSEMBLER_FRAME_READY 1L
+#undef org_jitsi_impl_neomedia_codec_video_VPX_FRAME_ASSEMBLER_DISCARDED
+#define org_jitsi_impl_neomedia_codec_video_VPX_FRAME_ASSEMBLER_DISCARDED 2L
+#undef org_jitsi_impl_neomedia_codec_video_VPX_FRAME_ASSEMBLER_FRAME_DROPPED
+#define org_jitsi_impl_neomedia_codec_video_VPX_FRAME_ASSEMBLER_FRAME_DROPPED 4L
+#undef org_jitsi_impl_neomedia_codec_video_VPX_ASSEMBLED_FRAME_INFO_LENGTH
+#define org_jitsi_impl_neomedia_codec_video_VPX_ASSEMBLED_FRAME_INFO_LENGTH 5L
 /*
  * Class:     org_jitsi_impl_neomedia_codec_video_VPX
  * Method:    codec_ctx_malloc
@@ -56,9 +124,17 @@ JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1dec_1
  * Method:    codec_decode
  * Signature: (J[BIIJJ)I
  */
-JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1decode
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1decode__J_3BIIJJ
   (JNIEnv *, jclass, jlong, jbyteArray, jint, jint, jlong, jlong);
 
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    codec_decode
+ * Signature: (JLjava/nio/ByteBuffer;IIJJ)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1decode__JLjava_nio_ByteBuffer_2IIJJ
+  (JNIEnv *, jclass, jlong, jobject, jint, jint, jlong, jlong);
+
 /*
  * Class:     org_jitsi_impl_neomedia_codec_video_VPX
  * Method:    codec_get_frame
@@ -67,6 +143,30 @@ JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1decod
 JNIEXPORT jlong JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1get_1frame
   (JNIEnv *, jclass, jlong, jlongArray);
 
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    codec_decode_export
+ * Signature: (J[BII[BIIJ)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1decode_1export
+  (JNIEnv *, jclass, jlong, jbyteArray, jint, jint, jbyteArray, jint, jint, jlong);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    codec_decode_fragments
+ * Signature: (J[BI[IIJ)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1decode_1fragments
+  (JNIEnv *, jclass, jlong, jbyteArray, jint, jintArray, jint, jlong);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    codec_decode_flush
+ * Signature: (JJ)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1decode_1flush
+  (JNIEnv *, jclass, jlong, jlong);
+
 /*
  * Class:     org_jitsi_impl_neomedia_codec_video_VPX
  * Method:    codec_destroy
@@ -107,6 +207,30 @@ JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1encod
 JNIEXPORT jlong JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1get_1cx_1data
   (JNIEnv *, jclass, jlong, jlongArray);
 
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    codec_encode_batch
+ * Signature: (JJ[BIIIJJJJ[BII[J)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1encode_1batch
+  (JNIEnv *, jclass, jlong, jlong, jbyteArray, jint, jint, jint, jlong, jlong, jlong, jlong, jbyteArray, jint, jint, jlongArray);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    codec_get_cx_data_batch
+ * Signature: (J[BII[J)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1get_1cx_1data_1batch
+  (JNIEnv *, jclass, jlong, jbyteArray, jint, jint, jlongArray);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    codec_get_cx_data_packetized
+ * Signature: (J[BII[BII[J)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1get_1cx_1data_1packetized
+  (JNIEnv *, jclass, jlong, jbyteArray, jint, jint, jbyteArray, jint, jint, jlongArray);
+
 /*
  * Class:     org_jitsi_impl_neomedia_codec_video_VPX
  * Method:    codec_cx_pkt_get_kind
@@ -315,6 +439,30 @@ JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_img_1set_1bp
 JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_img_1wrap
   (JNIEnv *, jclass, jlong, jint, jint, jint, jint, jlong);
 
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    img_alloc
+ * Signature: (IIII)J
+ */
+JNIEXPORT jlong JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_img_1alloc
+  (JNIEnv *, jclass, jint, jint, jint, jint);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    img_free
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_img_1free
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    img_scale
+ * Signature: (JJ)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_img_1scale
+  (JNIEnv *, jclass, jlong, jlong);
+
 /*
  * Class:     org_jitsi_impl_neomedia_codec_video_VPX
  * Method:    codec_dec_cfg_malloc
@@ -339,6 +487,150 @@ JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1dec_1
 JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1dec_1cfg_1set_1h
   (JNIEnv *, jclass, jlong, jint);
 
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    codec_dec_cfg_set_threads
+ * Signature: (JI)V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1dec_1cfg_1set_1threads
+  (JNIEnv *, jclass, jlong, jint);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    codec_dec_set_row_mt
+ * Signature: (JI)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1dec_1set_1row_1mt
+  (JNIEnv *, jclass, jlong, jint);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    codec_dec_get_frame_corrupted
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1dec_1get_1frame_1corrupted
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    frame_buffer_pool_malloc
+ * Signature: (I)J
+ */
+JNIEXPORT jlong JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_frame_1buffer_1pool_1malloc
+  (JNIEnv *, jclass, jint);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    frame_buffer_pool_free
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_frame_1buffer_1pool_1free
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    codec_set_frame_buffer_pool
+ * Signature: (JJ)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1set_1frame_1buffer_1pool
+  (JNIEnv *, jclass, jlong, jlong);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    img_ref_frame_buffer
+ * Signature: (JJ)J
+ */
+JNIEXPORT jlong JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_img_1ref_1frame_1buffer
+  (JNIEnv *, jclass, jlong, jlong);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    frame_buffer_ref
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_frame_1buffer_1ref
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    frame_buffer_release
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_frame_1buffer_1release
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    frame_buffer_get_w
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_frame_1buffer_1get_1w
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    frame_buffer_get_h
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_frame_1buffer_1get_1h
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    frame_buffer_get_stride
+ * Signature: (JI)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_frame_1buffer_1get_1stride
+  (JNIEnv *, jclass, jlong, jint);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    frame_buffer_get_plane
+ * Signature: (JI)Ljava/nio/ByteBuffer;
+ */
+JNIEXPORT jobject JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_frame_1buffer_1get_1plane
+  (JNIEnv *, jclass, jlong, jint);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    frame_assembler_malloc
+ * Signature: ()J
+ */
+JNIEXPORT jlong JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_frame_1assembler_1malloc
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    frame_assembler_free
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_frame_1assembler_1free
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    frame_assembler_reset
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_frame_1assembler_1reset
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    frame_assembler_push
+ * Signature: (J[BIIIJZ[J)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_frame_1assembler_1push
+  (JNIEnv *, jclass, jlong, jbyteArray, jint, jint, jint, jlong, jboolean, jlongArray);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    frame_assembler_get_frame
+ * Signature: (J)Ljava/nio/ByteBuffer;
+ */
+JNIEXPORT jobject JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_frame_1assembler_1get_1frame
+  (JNIEnv *, jclass, jlong);
+
 /*
  * Class:     org_jitsi_impl_neomedia_codec_video_VPX
  * Method:    codec_enc_cfg_malloc
@@ -387,6 +679,14 @@ JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1enc_1
 JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1enc_1cfg_1set_1h
   (JNIEnv *, jclass, jlong, jint);
 
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    codec_enc_cfg_set_timebase
+ * Signature: (JII)V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1enc_1cfg_1set_1timebase
+  (JNIEnv *, jclass, jlong, jint, jint);
+
 /*
  * Class:     org_jitsi_impl_neomedia_codec_video_VPX
  * Method:    codec_enc_cfg_set_error_resilient
@@ -523,6 +823,198 @@ JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1enc_1
 JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1enc_1cfg_1set_1kf_1max_1dist
   (JNIEnv *, jclass, jlong, jint);
 
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    codec_enc_cfg_set_ts_number_layers
+ * Signature: (JI)V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1enc_1cfg_1set_1ts_1number_1layers
+  (JNIEnv *, jclass, jlong, jint);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    codec_enc_cfg_set_ts_periodicity
+ * Signature: (JI)V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1enc_1cfg_1set_1ts_1periodicity
+  (JNIEnv *, jclass, jlong, jint);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    codec_enc_cfg_set_ts_target_bitrate
+ * Signature: (J[I)V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1enc_1cfg_1set_1ts_1target_1bitrate
+  (JNIEnv *, jclass, jlong, jintArray);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    codec_enc_cfg_set_ts_rate_decimator
+ * Signature: (J[I)V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1enc_1cfg_1set_1ts_1rate_1decimator
+  (JNIEnv *, jclass, jlong, jintArray);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    codec_enc_cfg_set_ts_layer_id
+ * Signature: (J[I)V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1enc_1cfg_1set_1ts_1layer_1id
+  (JNIEnv *, jclass, jlong, jintArray);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    codec_enc_set_temporal_layer_id
+ * Signature: (JI)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1enc_1set_1temporal_1layer_1id
+  (JNIEnv *, jclass, jlong, jint);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    codec_enc_set_cpu_used
+ * Signature: (JI)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1enc_1set_1cpu_1used
+  (JNIEnv *, jclass, jlong, jint);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    codec_enc_set_noise_sensitivity
+ * Signature: (JI)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1enc_1set_1noise_1sensitivity
+  (JNIEnv *, jclass, jlong, jint);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    codec_enc_set_screen_content_mode
+ * Signature: (JI)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1enc_1set_1screen_1content_1mode
+  (JNIEnv *, jclass, jlong, jint);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    codec_enc_set_static_threshold
+ * Signature: (JI)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1enc_1set_1static_1threshold
+  (JNIEnv *, jclass, jlong, jint);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    codec_enc_set_token_partitions
+ * Signature: (JI)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1enc_1set_1token_1partitions
+  (JNIEnv *, jclass, jlong, jint);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    codec_enc_get_last_quantizer
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1enc_1get_1last_1quantizer
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    codec_enc_set_active_map
+ * Signature: (J[BII)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1enc_1set_1active_1map
+  (JNIEnv *, jclass, jlong, jbyteArray, jint, jint);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    codec_enc_set_row_mt
+ * Signature: (JI)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1enc_1set_1row_1mt
+  (JNIEnv *, jclass, jlong, jint);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    codec_enc_set_tile_columns
+ * Signature: (JI)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1enc_1set_1tile_1columns
+  (JNIEnv *, jclass, jlong, jint);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    codec_enc_set_frame_parallel_decoding
+ * Signature: (JI)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_codec_1enc_1set_1frame_1parallel_1decoding
+  (JNIEnv *, jclass, jlong, jint);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    simulcast_malloc
+ * Signature: (I)J
+ */
+JNIEXPORT jlong JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_simulcast_1malloc
+  (JNIEnv *, jclass, jint);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    simulcast_get_cfg
+ * Signature: (JI)J
+ */
+JNIEXPORT jlong JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_simulcast_1get_1cfg
+  (JNIEnv *, jclass, jlong, jint);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    simulcast_get_ctx
+ * Signature: (JI)J
+ */
+JNIEXPORT jlong JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_simulcast_1get_1ctx
+  (JNIEnv *, jclass, jlong, jint);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    simulcast_set_dsf
+ * Signature: (JIII)V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_simulcast_1set_1dsf
+  (JNIEnv *, jclass, jlong, jint, jint, jint);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    simulcast_enc_cfg_derive
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_simulcast_1enc_1cfg_1derive
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    simulcast_enc_init
+ * Signature: (JIJ)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_simulcast_1enc_1init
+  (JNIEnv *, jclass, jlong, jint, jlong);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    simulcast_encode
+ * Signature: (JJ[BIIIJJJJ)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_simulcast_1encode
+  (JNIEnv *, jclass, jlong, jlong, jbyteArray, jint, jint, jint, jlong, jlong, jlong, jlong);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_codec_video_VPX
+ * Method:    simulcast_destroy
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_codec_video_VPX_simulcast_1destroy
+  (JNIEnv *, jclass, jlong);
+
 /*
  * Class:     org_jitsi_impl_neomedia_codec_video_VPX
  * Method:    stream_info_malloc
@@ -0,0 +1,852 @@
+/*
+ * Copyright @ 2015 Atlassian Pty Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Reads the VP8 or VP9 frames of an IVF file, or of the first video track of
+ * a WebM file, from a read-only memory mapping of the file. The file is
+ * indexed once when it is opened, and the frames are then handed to java as
+ * direct ByteBuffers over the mapping, without a copy, or copied into java
+ * arrays after checking that the file still holds them.
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader.h"
+
+#define CODEC_VP8 \
+    org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader_CODEC_VP8
+#define CODEC_VP9 \
+    org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader_CODEC_VP9
+#define FLAG_KEY \
+    org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader_FLAG_KEY
+#define INFO_TIMESTAMP \
+    org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader_INFO_TIMESTAMP
+#define INFO_FLAGS \
+    org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader_INFO_FLAGS
+#define INFO_LENGTH \
+    org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader_INFO_LENGTH
+
+#define IVF_FILE_HEADER_LENGTH 32
+#define IVF_FRAME_HEADER_LENGTH 12
+
+/* The EBML IDs of the WebM elements which the reader looks at. */
+#define EBML_ID 0x1A45DFA3
+#define SEGMENT_ID 0x18538067
+#define SEEK_HEAD_ID 0x114D9B74
+#define INFO_ID 0x1549A966
+#define TIMECODE_SCALE_ID 0x2AD7B1
+#define TRACKS_ID 0x1654AE6B
+#define TRACK_ENTRY_ID 0xAE
+#define TRACK_NUMBER_ID 0xD7
+#define TRACK_TYPE_ID 0x83
+#define CODEC_ID_ID 0x86
+#define VIDEO_ID 0xE0
+#define PIXEL_WIDTH_ID 0xB0
+#define PIXEL_HEIGHT_ID 0xBA
+#define CLUSTER_ID 0x1F43B675
+#define TIMECODE_ID 0xE7
+#define SIMPLE_BLOCK_ID 0xA3
+#define BLOCK_GROUP_ID 0xA0
+#define BLOCK_ID 0xA1
+#define CUES_ID 0x1C53BB6B
+#define CHAPTERS_ID 0x1043A770
+#define TAGS_ID 0x1254C367
+#define ATTACHMENTS_ID 0x1941A469
+
+#define TRACK_TYPE_VIDEO 1
+#define DEFAULT_TIMECODE_SCALE 1000000
+
+typedef struct
+{
+    uint64_t offset;
+    uint32_t length;
+    uint32_t flags;
+    int64_t timestamp;
+} vpx_file_frame_t;
+
+typedef struct
+{
+    unsigned char *data;
+    uint64_t size;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#else
+    /* Kept open to check that the file has not been truncated. */
+    int fd;
+#endif
+
+    int codec;
+    int width;
+    int height;
+
+    vpx_file_frame_t *frames;
+    int frame_count;
+    int frame_capacity;
+} vpx_file_t;
+
+/* The state of the WebM parser which persists across the elements. */
+typedef struct
+{
+    uint64_t timecode_scale;
+    uint64_t track_number;
+    uint64_t cluster_timecode;
+} webm_state_t;
+
+static uint16_t
+read_le16(const unsigned char *p)
+{
+    return (uint16_t) (p[0] | (p[1] << 8));
+}
+
+static uint32_t
+read_le32(const unsigned char *p)
+{
+    return ((uint32_t) p[0])
+        | ((uint32_t) p[1] << 8)
+        | ((uint32_t) p[2] << 16)
+        | ((uint32_t) p[3] << 24);
+}
+
+static uint64_t
+read_le64(const unsigned char *p)
+{
+    return ((uint64_t) read_le32(p + 4) << 32) | read_le32(p);
+}
+
+/*
+ * Determines whether a frame is a keyframe from the first bytes of its
+ * uncompressed header.
+ */
+static int
+is_keyframe(int codec, const unsigned char *p, uint32_t length)
+{
+    if (length == 0)
+        return 0;
+    if (codec == CODEC_VP8)
+        return !(p[0] & 0x01);
+    else
+    {
+        /* frame_marker (2 bits), profile_low_bit, profile_high_bit, a
+           reserved bit in profile 3, show_existing_frame, frame_type. */
+        int profile = ((p[0] >> 5) & 0x01) | ((p[0] >> 3) & 0x02);
+        int bit = (profile == 3) ? 5 : 4;
+
+        if ((p[0] >> 6) != 0x02 || ((p[0] >> (7 - bit)) & 0x01))
+            return 0;
+        return !((p[0] >> (6 - bit)) & 0x01);
+    }
+}
+
+static int
+add_frame(
+        vpx_file_t *file,
+        uint64_t offset, uint32_t length,
+        int64_t timestamp,
+        uint32_t flags)
+{
+    vpx_file_frame_t *frame;
+
+    if (file->frame_count == file->frame_capacity)
+    {
+        int capacity
+            = file->frame_capacity ? (2 * file->frame_capacity) : 1024;
+        vpx_file_frame_t *frames
+            = realloc(file->frames, capacity * sizeof(vpx_file_frame_t));
+
+        if (!frames)
+            return 0;
+        file->frames = frames;
+        file->frame_capacity = capacity;
+    }
+
+    frame = file->frames + file->frame_count++;
+    frame->offset = offset;
+    frame->length = length;
+    frame->timestamp = timestamp;
+    frame->flags = flags;
+    return 1;
+}
+
+static int
+parse_ivf(vpx_file_t *file)
+{
+    const unsigned char *data = file->data;
+    uint64_t pos;
+    uint32_t rate, scale;
+
+    if (file->size < IVF_FILE_HEADER_LENGTH)
+        return 0;
+
+    if (!memcmp(data + 8, "VP80", 4))
+        file->codec = CODEC_VP8;
+    else if (!memcmp(data + 8, "VP90", 4))
+        file->codec = CODEC_VP9;
+    else
+        return 0;
+
+    file->width = read_le16(data + 12);
+    file->height = read_le16(data + 14);
+    rate = read_le32(data + 16);
+    scale = read_le32(data + 20);
+    if (!rate || !scale)
+    {
+        rate = 1000;
+        scale = 1;
+    }
+
+    pos = read_le16(data + 6);
+    if (pos < IVF_FILE_HEADER_LENGTH)
+        pos = IVF_FILE_HEADER_LENGTH;
+
+    /* A frame which was cut short, e.g. by a crash during the recording, is
+       left out along with anything which follows it. */
+    while (pos + IVF_FRAME_HEADER_LENGTH <= file->size)
+    {
+        uint32_t length = read_le32(data + pos);
+        uint64_t pts = read_le64(data + pos + 4);
+
+        pos += IVF_FRAME_HEADER_LENGTH;
+        if (length > file->size - pos)
+            break;
+
+        if (!add_frame(
+                file,
+                pos, length,
+                (int64_t) ((double) pts * scale * 1000000000.0 / rate),
+                is_keyframe(file->codec, data + pos, length) ? FLAG_KEY : 0))
+            return 0;
+        pos += length;
+    }
+    return 1;
+}
+
+/* An EBML element header. The size of an element of unknown size, or of an
+   element which is cut short, runs up to the end of its parent. */
+typedef struct
+{
+    uint32_t id;
+    uint64_t data;
+    uint64_t size;
+    int unknown;
+    int truncated;
+} ebml_element_t;
+
+/*
+ * Reads an EBML variable size integer, and returns its length in bytes or 0
+ * if there is no valid integer before end.
+ */
+static int
+ebml_read_vint(
+        const unsigned char *data, uint64_t pos, uint64_t end,
+        uint64_t *value,
+        int *unknown)
+{
+    unsigned char mask = 0x80;
+    int length = 1;
+    int all_ones;
+    uint64_t v;
+    int i;
+
+    if (pos >= end)
+        return 0;
+    while (length <= 8 && !(data[pos] & mask))
+    {
+        mask >>= 1;
+        length++;
+    }
+    if (length > 8 || (uint64_t) length > end - pos)
+        return 0;
+
+    v = data[pos] & (mask - 1);
+    all_ones = (v == (uint64_t) (mask - 1));
+    for (i = 1; i < length; i++)
+    {
+        v = (v << 8) | data[pos + i];
+        if (data[pos + i] != 0xFF)
+            all_ones = 0;
+    }
+    *value = v;
+    if (unknown)
+        *unknown = all_ones;
+    return length;
+}
+
+static int
+ebml_read_element(
+        const unsigned char *data, uint64_t pos, uint64_t end,
+        ebml_element_t *e)
+{
+    uint64_t id;
+    int id_length, size_length;
+    int i;
+
+    /* The IDs keep their marker bit, so read the length from the first byte
+       and the value as is. */
+    if (pos >= end || !(data[pos] & 0xF0))
+        return 0;
+    id_length = (data[pos] & 0x80) ? 1
+        : (data[pos] & 0x40) ? 2
+        : (data[pos] & 0x20) ? 3
+        : 4;
+    if ((uint64_t) id_length > end - pos)
+        return 0;
+    for (id = 0, i = 0; i < id_length; i++)
+        id = (id << 8) | data[pos + i];
+
+    size_length
+        = ebml_read_vint(
+                data, pos + id_length, end,
+                &e->size,
+                &e->unknown);
+    if (!size_length)
+        return 0;
+
+    e->id = (uint32_t) id;
+    e->data = pos + id_length + size_length;
+    e->truncated = !e->unknown && e->size > end - e->data;
+    if (e->unknown || e->truncated)
+        e->size = end - e->data;
+    return 1;
+}
+
+static uint64_t
+ebml_read_uint(const unsigned char *data, const ebml_element_t *e)
+{
+    uint64_t value = 0;
+    uint64_t i;
+
+    for (i = 0; i < e->size && i < 8; i++)
+        value = (value << 8) | data[e->data + i];
+    return value;
+}
+
+/* Determines whether an element of unknown size ends at a specific ID, i.e.
+   whether the ID is the one of a top-level element of the segment. */
+static int
+webm_is_top_level(uint32_t id)
+{
+    switch (id)
+    {
+    case CLUSTER_ID:
+    case CUES_ID:
+    case INFO_ID:
+    case SEEK_HEAD_ID:
+    case TRACKS_ID:
+    case CHAPTERS_ID:
+    case TAGS_ID:
+    case ATTACHMENTS_ID:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static void
+webm_parse_info(
+        vpx_file_t *file,
+        const ebml_element_t *info,
+        webm_state_t *state)
+{
+    uint64_t end = info->data + info->size;
+    uint64_t pos = info->data;
+    ebml_element_t e;
+
+    while (ebml_read_element(file->data, pos, end, &e))
+    {
+        if (e.id == TIMECODE_SCALE_ID)
+        {
+            state->timecode_scale = ebml_read_uint(file->data, &e);
+            if (!state->timecode_scale)
+                state->timecode_scale = DEFAULT_TIMECODE_SCALE;
+        }
+        pos = e.data + e.size;
+    }
+}
+
+/* Selects the first VP8 or VP9 video track of the file. */
+static void
+webm_parse_tracks(
+        vpx_file_t *file,
+        const ebml_element_t *tracks,
+        webm_state_t *state)
+{
+    const unsigned char *data = file->data;
+    uint64_t end = tracks->data + tracks->size;
+    uint64_t pos = tracks->data;
+    ebml_element_t entry;
+
+    while (!state->track_number
+            && ebml_read_element(data, pos, end, &entry))
+    {
+        uint64_t entry_end = entry.data + entry.size;
+        uint64_t number = 0, type = 0;
+        int codec = -1, width = 0, height = 0;
+        ebml_element_t e;
+
+        pos = entry.data;
+        while (entry.id == TRACK_ENTRY_ID
+                && ebml_read_element(data, pos, entry_end, &e))
+        {
+            switch (e.id)
+            {
+            case TRACK_NUMBER_ID:
+                number = ebml_read_uint(data, &e);
+                break;
+            case TRACK_TYPE_ID:
+                type = ebml_read_uint(data, &e);
+                break;
+            case CODEC_ID_ID:
+                /* The string may be padded with zeros. */
+                if (e.size >= 5
+                        && (e.size == 5 || !data[e.data + 5]))
+                {
+                    if (!memcmp(data + e.data, "V_VP8", 5))
+                        codec = CODEC_VP8;
+                    else if (!memcmp(data + e.data, "V_VP9", 5))
+                        codec = CODEC_VP9;
+                }
+                break;
+            case VIDEO_ID:
+            {
+                uint64_t video_end = e.data + e.size;
+                ebml_element_t v;
+
+                pos = e.data;
+                while (ebml_read_element(data, pos, video_end, &v))
+                {
+                    if (v.id == PIXEL_WIDTH_ID)
+                        width = (int) ebml_read_uint(data, &v);
+                    else if (v.id == PIXEL_HEIGHT_ID)
+                        height = (int) ebml_read_uint(data, &v);
+                    pos = v.data + v.size;
+                }
+                break;
+            }
+            }
+            pos = e.data + e.size;
+        }
+
+        if (number && type == TRACK_TYPE_VIDEO && codec >= 0)
+        {
+            state->track_number = number;
+            file->codec = codec;
+            file->width = width;
+            file->height = height;
+        }
+        pos = entry_end;
+    }
+}
+
+/*
+ * Adds the frame of a (Simple)Block of the selected track. Laced blocks are
+ * skipped, WebmWriter never laces video frames.
+ */
+static int
+webm_add_block(
+        vpx_file_t *file,
+        const webm_state_t *state,
+        const ebml_element_t *block,
+        int simple)
+{
+    const unsigned char *data = file->data;
+    uint64_t end = block->data + block->size;
+    uint64_t track;
+    int16_t timecode;
+    unsigned char flags;
+    uint64_t offset;
+    uint32_t length;
+    int n;
+
+    if (block->truncated)
+        return 1;
+    n = ebml_read_vint(data, block->data, end, &track, NULL);
+    if (!n || track != state->track_number || block->size < (uint64_t) n + 3)
+        return 1;
+
+    offset = block->data + n;
+    timecode = (int16_t) ((data[offset] << 8) | data[offset + 1]);
+    flags = data[offset + 2];
+    if (flags & 0x06)
+        return 1;
+
+    offset += 3;
+    length = (uint32_t) (end - offset);
+    return
+        add_frame(
+                file,
+                offset, length,
+                ((int64_t) state->cluster_timecode + timecode)
+                    * (int64_t) state->timecode_scale,
+                (simple
+                        ? (flags & 0x80)
+                        : is_keyframe(file->codec, data + offset, length))
+                    ? FLAG_KEY
+                    : 0);
+}
+
+/*
+ * Indexes the frames of a cluster, and returns the position which follows
+ * it, or 0 if the frames could not be indexed.
+ */
+static uint64_t
+webm_parse_cluster(
+        vpx_file_t *file,
+        const ebml_element_t *cluster,
+        webm_state_t *state)
+{
+    const unsigned char *data = file->data;
+    uint64_t end = cluster->data + cluster->size;
+    uint64_t pos = cluster->data;
+    ebml_element_t e;
+
+    while (ebml_read_element(data, pos, end, &e))
+    {
+        if (cluster->unknown && webm_is_top_level(e.id))
+            return pos;
+
+        switch (e.id)
+        {
+        case TIMECODE_ID:
+            state->cluster_timecode = ebml_read_uint(data, &e);
+            break;
+        case SIMPLE_BLOCK_ID:
+            if (!webm_add_block(file, state, &e, 1))
+                return 0;
+            break;
+        case BLOCK_GROUP_ID:
+        {
+            uint64_t group_end = e.data + e.size;
+            ebml_element_t b;
+
+            pos = e.data;
+            while (ebml_read_element(data, pos, group_end, &b))
+            {
+                if (b.id == BLOCK_ID && !webm_add_block(file, state, &b, 0))
+                    return 0;
+                pos = b.data + b.size;
+            }
+            break;
+        }
+        }
+        pos = e.data + e.size;
+    }
+    return end;
+}
+
+static int
+parse_webm(vpx_file_t *file)
+{
+    const unsigned char *data = file->data;
+    webm_state_t state;
+    ebml_element_t e;
+    uint64_t end, pos;
+
+    if (!ebml_read_element(data, 0, file->size, &e) || e.id != EBML_ID)
+        return 0;
+    if (!ebml_read_element(data, e.data + e.size, file->size, &e)
+            || e.id != SEGMENT_ID)
+        return 0;
+
+    state.timecode_scale = DEFAULT_TIMECODE_SCALE;
+    state.track_number = 0;
+    state.cluster_timecode = 0;
+
+    /* The segment of a live recording, or of one which was cut short, runs up
+       to the end of the file. */
+    pos = e.data;
+    end = e.data + e.size;
+    while (ebml_read_element(data, pos, end, &e))
+    {
+        switch (e.id)
+        {
+        case INFO_ID:
+            webm_parse_info(file, &e, &state);
+            break;
+        case TRACKS_ID:
+            webm_parse_tracks(file, &e, &state);
+            break;
+        case CLUSTER_ID:
+            if (!state.track_number)
+                return 0;
+            pos = webm_parse_cluster(file, &e, &state);
+            if (!pos)
+                return 0;
+            continue;
+        }
+        pos = e.data + e.size;
+    }
+    return state.track_number != 0;
+}
+
+static int
+map_file(vpx_file_t *file, const char *path)
+{
+    /* The mapping is private and writable, i.e. copy-on-write, because the
+       direct ByteBuffers over it are writable. Nothing is written back to the
+       file. */
+#ifdef _WIN32
+    LARGE_INTEGER size;
+    wchar_t *wpath;
+    int length;
+
+    length = MultiByteToWideChar(CP_UTF8, 0, path, -1, NULL, 0);
+    if (length <= 0)
+        return 0;
+    wpath = malloc(length * sizeof(wchar_t));
+    if (!wpath)
+        return 0;
+    MultiByteToWideChar(CP_UTF8, 0, path, -1, wpath, length);
+    file->file
+        = CreateFileW(
+                wpath,
+                GENERIC_READ,
+                FILE_SHARE_READ | FILE_SHARE_WRITE,
+                NULL,
+                OPEN_EXISTING,
+                FILE_ATTRIBUTE_NORMAL,
+                NULL);
+    free(wpath);
+    if (file->file == INVALID_HANDLE_VALUE)
+        return 0;
+
+    if (GetFileSizeEx(file->file, &size) && size.QuadPart > 0)
+    {
+        file->mapping
+            = CreateFileMappingW(file->file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+        if (file->mapping)
+        {
+            file->data = MapViewOfFile(file->mapping, FILE_MAP_COPY, 0, 0, 0);
+            if (file->data)
+            {
+                file->size = (uint64_t) size.QuadPart;
+                return 1;
+            }
+            CloseHandle(file->mapping);
+        }
+    }
+    CloseHandle(file->file);
+    return 0;
+#else
+    struct stat st;
+    void *data;
+    int fd;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return 0;
+    if (fstat(fd, &st) || st.st_size <= 0)
+    {
+        close(fd);
+        return 0;
+    }
+    data
+        = mmap(
+                NULL,
+                (size_t) st.st_size,
+                PROT_READ | PROT_WRITE,
+                MAP_PRIVATE,
+                fd,
+                0);
+    if (data == MAP_FAILED)
+    {
+        close(fd);
+        return 0;
+    }
+
+    file->fd = fd;
+    file->data = data;
+    file->size = (uint64_t) st.st_size;
+    return 1;
+#endif
+}
+
+static void
+unmap_file(vpx_file_t *file)
+{
+#ifdef _WIN32
+    UnmapViewOfFile(file->data);
+    CloseHandle(file->mapping);
+    CloseHandle(file->file);
+#else
+    munmap(file->data, (size_t) file->size);
+    close(file->fd);
+#endif
+}
+
+/*
+ * Determines whether a frame is still in the file. An access to a page of the
+ * mapping past the end of a file which has been truncated since it was mapped
+ * raises SIGBUS. Windows does not allow to truncate a mapped file.
+ */
+static int
+is_frame_in_file(vpx_file_t *file, const vpx_file_frame_t *frame)
+{
+#ifdef _WIN32
+    return 1;
+#else
+    struct stat st;
+
+    return
+        !fstat(file->fd, &st)
+            && (uint64_t) st.st_size >= frame->offset + frame->length;
+#endif
+}
+
+static void
+get_frame_info(JNIEnv *env, const vpx_file_frame_t *frame, jlongArray info)
+{
+    jlong values[INFO_LENGTH];
+
+    values[INFO_TIMESTAMP] = (jlong) frame->timestamp;
+    values[INFO_FLAGS] = (jlong) frame->flags;
+    (*env)->SetLongArrayRegion(env, info, 0, INFO_LENGTH, values);
+}
+
+static void
+free_file(vpx_file_t *file)
+{
+    if (file->data)
+        unmap_file(file);
+    free(file->frames);
+    free(file);
+}
+
+JNIEXPORT void JNICALL
+Java_org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader_close
+    (JNIEnv *env, jclass clazz, jlong reader)
+{
+    free_file((vpx_file_t *) (intptr_t) reader);
+}
+
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader_getCodec
+    (JNIEnv *env, jclass clazz, jlong reader)
+{
+    return (jint) ((vpx_file_t *) (intptr_t) reader)->codec;
+}
+
+JNIEXPORT jobject JNICALL
+Java_org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader_getFrame
+    (JNIEnv *env, jclass clazz, jlong reader, jint index, jlongArray info)
+{
+    vpx_file_t *file = (vpx_file_t *) (intptr_t) reader;
+    vpx_file_frame_t *frame;
+
+    if (index < 0 || index >= file->frame_count)
+        return NULL;
+    frame = file->frames + index;
+
+    if (info)
+        get_frame_info(env, frame, info);
+    return
+        (*env)->NewDirectByteBuffer(
+                env,
+                file->data + frame->offset,
+                (jlong) frame->length);
+}
+
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader_getFrameCount
+    (JNIEnv *env, jclass clazz, jlong reader)
+{
+    return (jint) ((vpx_file_t *) (intptr_t) reader)->frame_count;
+}
+
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader_getHeight
+    (JNIEnv *env, jclass clazz, jlong reader)
+{
+    return (jint) ((vpx_file_t *) (intptr_t) reader)->height;
+}
+
+JNIEXPORT jint JNICALL
+Java_org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader_getWidth
+    (JNIEnv *env, jclass clazz, jlong reader)
+{
+    return (jint) ((vpx_file_t *) (intptr_t) reader)->width;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader_readFrame
+    (JNIEnv *env, jclass clazz, jlong reader, jint index, jbyteArray buf,
+     jint offset, jlongArray info)
+{
+    vpx_file_t *file = (vpx_file_t *) (intptr_t) reader;
+    jsize buf_length = (*env)->GetArrayLength(env, buf);
+    vpx_file_frame_t *frame;
+
+    if (index < 0 || index >= file->frame_count)
+        return JNI_FALSE;
+    frame = file->frames + index;
+    if (offset < 0
+            || offset > buf_length
+            || (uint32_t) (buf_length - offset) < frame->length
+            || !is_frame_in_file(file, frame))
+        return JNI_FALSE;
+
+    (*env)->SetByteArrayRegion(
+            env,
+            buf, offset, (jsize) frame->length,
+            (const jbyte *) (file->data + frame->offset));
+    if (info)
+        get_frame_info(env, frame, info);
+    return JNI_TRUE;
+}
+
+JNIEXPORT jlong JNICALL
+Java_org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader_open
+    (JNIEnv *env, jclass clazz, jstring path)
+{
+    const char *chars;
+    vpx_file_t *file;
+    int ok = 0;
+
+    file = calloc(1, sizeof(vpx_file_t));
+    if (!file)
+        return 0;
+
+    chars = (*env)->GetStringUTFChars(env, path, NULL);
+    if (chars)
+    {
+        ok = map_file(file, chars);
+        (*env)->ReleaseStringUTFChars(env, path, chars);
+    }
+
+    if (ok)
+    {
+        if (file->size >= 4 && !memcmp(file->data, "DKIF", 4))
+            ok = parse_ivf(file);
+        else
+            ok = parse_webm(file);
+    }
+    if (!ok || !file->frame_count)
+    {
+        free_file(file);
+        return 0;
+    }
+    return (jlong) (intptr_t) file;
+}
@@ -0,0 +1,89 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader */
+
+#ifndef _Included_org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader
+#define _Included_org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader
+#ifdef __cplusplus
+extern "C" {
+#endif
+#undef org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader_CODEC_VP8
+#define org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader_CODEC_VP8 0L
+#undef org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader_CODEC_VP9
+#define org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader_CODEC_VP9 1L
+#undef org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader_FLAG_KEY
+#define org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader_FLAG_KEY 1L
+#undef org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader_INFO_TIMESTAMP
+#define org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader_INFO_TIMESTAMP 0L
+#undef org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader_INFO_FLAGS
+#define org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader_INFO_FLAGS 1L
+#undef org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader_INFO_LENGTH
+#define org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader_INFO_LENGTH 2L
+/*
+ * Class:     org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader
+ * Method:    close
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader_close
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader
+ * Method:    getCodec
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader_getCodec
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader
+ * Method:    getFrame
+ * Signature: (JI[J)Ljava/nio/ByteBuffer;
+ */
+JNIEXPORT jobject JNICALL Java_org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader_getFrame
+  (JNIEnv *, jclass, jlong, jint, jlongArray);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader
+ * Method:    getFrameCount
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader_getFrameCount
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader
+ * Method:    getHeight
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader_getHeight
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader
+ * Method:    getWidth
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader_getWidth
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader
+ * Method:    readFrame
+ * Signature: (JI[BI[J)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader_readFrame
+  (JNIEnv *, jclass, jlong, jint, jbyteArray, jint, jlongArray);
+
+/*
+ * Class:     org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader
+ * Method:    open
+ * Signature: (Ljava/lang/String;)J
+ */
+JNIEXPORT jlong JNICALL Java_org_jitsi_impl_neomedia_jmfext_media_protocol_vpxfile_VPXFileReader_open
+  (JNIEnv *, jclass, jstring);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
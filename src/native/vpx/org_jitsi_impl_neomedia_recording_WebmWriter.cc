@@ -1,9 +1,10 @@
-#include <assert.h>
 #include <jni.h>
 #include <limits.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <new>
 
 #include "vpx/vpx_codec.h"
@@ -53,15 +54,181 @@ typedef enum stereo_format {
 
 typedef off_t EbmlLoc;
 
+/* The number of serialized clusters which can wait for the I/O thread. */
+#define IO_QUEUE_LENGTH 8
+
+/* The I/O statistics, in the order of WebmWriter.IO_STAT_*. */
+enum io_stat {
+  IO_STAT_CLUSTERS = 0,
+  IO_STAT_BYTES,
+  IO_STAT_QUEUED,
+  IO_STAT_MAX_QUEUED,
+  IO_STAT_STALLS,
+  IO_STAT_STALL_NANOS,
+  IO_STAT_WRITE_ERRORS,
+  IO_STAT_LATE_BLOCKS,
+  IO_STATS_LENGTH
+};
+
+struct io_buffer {
+  unsigned char *buf;
+  size_t         len;
+  size_t         cap;
+};
+
+/* A background thread which writes serialized clusters to the file. The
+ * clusters are passed through a single-producer single-consumer ring: the
+ * writing thread only advances tail and the I/O thread only advances head,
+ * both with atomic stores. The mutex and the condition only serve to park
+ * either thread when the ring is full or empty. A thread sets its parked
+ * flag before it checks the ring one last time under the mutex, and the
+ * other thread only takes the mutex to wake it up when the flag is set.
+ */
+struct io_thread {
+  pthread_t        thread;
+  pthread_mutex_t  mutex;
+  pthread_cond_t   cond;
+  FILE            *stream;
+  struct io_buffer queue[IO_QUEUE_LENGTH];
+  unsigned int     head;
+  unsigned int     tail;
+  int              io_parked;
+  int              writer_parked;
+  int              stop;
+  int64_t          stats[IO_STATS_LENGTH];
+};
+
+/* The loads and stores of head, tail and the parked flags are sequentially
+ * consistent: a thread which parks stores its flag and then loads the index
+ * of the other thread, which stores its index and then loads the flag, so at
+ * least one of them sees the store of the other and no wake-up is lost.
+ */
+static inline unsigned int io_load(const unsigned int *p) {
+  return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+}
+
+static inline void io_store(unsigned int *p, unsigned int v) {
+  __atomic_store_n(p, v, __ATOMIC_SEQ_CST);
+}
+
+/* Parks the calling thread until full_or_empty() is false or the I/O thread
+ * is asked to stop. parked is the flag of the calling thread.
+ */
+static void io_park(struct io_thread *io, int *parked,
+                    int (*full_or_empty)(struct io_thread *)) {
+  pthread_mutex_lock(&io->mutex);
+  __atomic_store_n(parked, 1, __ATOMIC_SEQ_CST);
+  while (full_or_empty(io) && !io->stop)
+    pthread_cond_wait(&io->cond, &io->mutex);
+  __atomic_store_n(parked, 0, __ATOMIC_SEQ_CST);
+  pthread_mutex_unlock(&io->mutex);
+}
+
+/* Wakes up the other thread if it is parked. */
+static void io_unpark(struct io_thread *io, int *parked) {
+  if (__atomic_load_n(parked, __ATOMIC_SEQ_CST)) {
+    pthread_mutex_lock(&io->mutex);
+    pthread_cond_broadcast(&io->cond);
+    pthread_mutex_unlock(&io->mutex);
+  }
+}
+
+static int io_empty(struct io_thread *io) {
+  return io_load(&io->head) == io_load(&io->tail);
+}
+
+static int io_full(struct io_thread *io) {
+  return io_load(&io->tail) - io_load(&io->head) == IO_QUEUE_LENGTH;
+}
+
+static int io_not_empty(struct io_thread *io) {
+  return !io_empty(io);
+}
+
 struct cue_entry {
   unsigned int time;
   uint64_t     loc;
+  unsigned int track;
+};
+
+/* The cues are stored in a list of fixed size chunks so that adding one never
+ * moves the others.
+ */
+#define CUE_CHUNK_LENGTH 256
+
+struct cue_chunk {
+  struct cue_chunk *next;
+  unsigned int      count;
+  struct cue_entry  entries[CUE_CHUNK_LENGTH];
+};
+
+/* The ID of the Void element, which readers skip. */
+#define VOID_ID 0xEC
+
+/* The maximum number of tracks, which keeps track numbers encodable in the
+ * single byte of a SimpleBlock header.
+ */
+#define WEBM_MAX_TRACKS 8
+
+/* The codecs, in the order of WebmWriter.CODEC_*. */
+enum webm_codec {
+  WEBM_CODEC_VP8 = 0,
+  WEBM_CODEC_VP9,
+  WEBM_CODEC_OPUS
+};
+
+/* Matroska track types. */
+#define TRACK_TYPE_VIDEO 1
+#define TRACK_TYPE_AUDIO 2
+
+/* Element IDs which libmkv does not define. */
+#define CODEC_DELAY_ID   0x56AA
+#define SEEK_PRE_ROLL_ID 0x56BB
+
+/* The seek pre-roll of Opus tracks in nanoseconds, as advised by the WebM
+ * guidelines.
+ */
+#define OPUS_SEEK_PRE_ROLL 80000000
+
+/* The duration in milliseconds of the clusters of files without video, which
+ * have no keyframes to start clusters at.
+ */
+#define AUDIO_CLUSTER_DURATION_MS 5000
+
+/* How long in milliseconds a block may wait for the blocks of the other
+ * tracks with earlier time stamps before it is written anyway.
+ */
+#define INTERLEAVE_MAX_DELAY_MS 500
+
+struct track_entry {
+  int            type;
+  int            codec;
+  unsigned int   width;
+  unsigned int   height;
+  unsigned int   sample_rate;
+  unsigned int   channels;
+  unsigned char *codec_private;
+  size_t         codec_private_len;
+  off_t          uid_pos;
+  int64_t        last_pts_ms;  /* of the last block received, or -1 */
+};
+
+/* A block of a multi-track file which waits to be written in time stamp
+ * order.
+ */
+struct pending_block {
+  int64_t        pts_ms;
+  unsigned int   track;
+  int            flags;
+  unsigned char *data;
+  size_t         len;
 };
 
 extern "C" {
 struct EbmlGlobal {
   FILE *stream;
   int64_t last_pts_ms;
+  int64_t late_blocks;  /* written with the time stamp of their predecessor */
 
   /* These pointers are to the start of an element */
   off_t    position_reference;
@@ -71,9 +238,6 @@ struct EbmlGlobal {
   off_t    cue_pos;
   off_t    cluster_pos;
 
-  /* This pointer is to a specific element to be serialized */
-  off_t    track_id_pos;
-
   /* These pointers are to the size field of the element */
   EbmlLoc  startSegment;
   EbmlLoc  startCluster;
@@ -81,11 +245,84 @@ struct EbmlGlobal {
   uint32_t cluster_timecode;
   int      cluster_open;
 
-  struct cue_entry *cue_list;
+  struct cue_chunk *cue_head;
+  struct cue_chunk *cue_tail;
   unsigned int      cues;
+
+  /* The checkpoints: their interval (0, the default, to disable), the time
+   * of the last one, the number of cues it wrote, and the size of the Cues
+   * element written at cue_pos, which the next one turns into a Void element.
+   */
+  int64_t      checkpoint_interval_ms;
+  int64_t      checkpoint_ms;
+  unsigned int checkpoint_cues;
+  off_t        cue_len;
+
+  /* The tracks, numbered from 1, and whether the header has been written,
+   * after which no track can be added.
+   */
+  struct track_entry tracks[WEBM_MAX_TRACKS];
+  unsigned int       track_count;
+  unsigned int       video_tracks;
+  int                header_written;
+
+  /* The tracks which have a cue point in the open cluster, one bit each. */
+  unsigned int cluster_cued;
+
+  /* The blocks of multi-track files which wait to be interleaved, sorted by
+   * time stamp.
+   */
+  struct pending_block *pending;
+  unsigned int          pending_count;
+  unsigned int          pending_cap;
+
+  /* The open cluster is serialized into this buffer, its sizes are patched
+   * in memory and it is written out with a single fwrite when it is closed.
+   */
+  unsigned char *buf;
+  size_t         buf_len;
+  size_t         buf_cap;
+  off_t          buf_pos;  /* the file offset of buf[0] */
+  int            buffering;
+
+  /* The I/O thread, if any, and whether clusters have been passed to it
+   * since the file was last accessed directly, in which case end_pos is the
+   * file offset after the last of them.
+   */
+  struct io_thread *io;
+  int               io_pending;
+  off_t             end_pos;
+
+  /* Whether the output is a stream, e.g. a pipe, which is written in order
+   * and never seeked. All elements are then buffered and the sizes of those
+   * which do not fit in the buffer (the Segment) are left unknown, and
+   * stream_pos is the number of bytes written.
+   */
+  int   live;
+  off_t stream_pos;
+
+  /* The rotation of the output to a new file at the first keyframe past a
+   * duration or size (0 for no limit), the name of the first file, from
+   * which those of the next ones are derived, the name of the current one
+   * and its index, and the time stamp at which it starts.
+   */
+  int64_t      rotate_ms;
+  int64_t      rotate_bytes;
+  char        *filename;
+  char        *current_filename;
+  unsigned int file_index;
+  int64_t      file_start_ms;
+  int          rotated;
+
+  /* The frame passed to writeWebmBlock, copied out of its java array. */
+  unsigned char *frame_buf;
+  size_t         frame_buf_cap;
 };
 }
 
+/* The initial capacity of the cluster buffer, enough for a few frames. */
+#define CLUSTER_BUFFER_INITIAL_SIZE (64 * 1024)
+
 FUNC(jlong, allocCfg) {
   EbmlGlobal *glob = new (std::nothrow) EbmlGlobal;
 
@@ -97,14 +334,42 @@ FUNC(jlong, allocCfg) {
   return (intptr_t)glob;
 }
 
+static void ebml_flush(EbmlGlobal *glob);
+static void io_thread_stop(EbmlGlobal *glob);
+
+static void free_cues(EbmlGlobal *glob) {
+  while (glob->cue_head) {
+    struct cue_chunk *next = glob->cue_head->next;
+
+    free(glob->cue_head);
+    glob->cue_head = next;
+  }
+  glob->cue_tail = NULL;
+  glob->cues = 0;
+}
+
 FUNC(void, freeCfg, jlong jglob) {
-  const EbmlGlobal *glob = reinterpret_cast<EbmlGlobal*>(jglob);
+  EbmlGlobal *glob = reinterpret_cast<EbmlGlobal*>(jglob);
+  unsigned int i;
 
   if (glob != NULL) {
-    if (glob->stream)
+    if (glob->stream) {
+      /* An unfinished cluster keeps its unknown size and is still valid. */
+      ebml_flush(glob);
+      io_thread_stop(glob);
       fclose(glob->stream);
+    }
 
-    free(glob->cue_list);
+    free_cues(glob);
+    free(glob->buf);
+    free(glob->frame_buf);
+    free(glob->filename);
+    free(glob->current_filename);
+    for (i = 0; i < glob->pending_count; i++)
+      free(glob->pending[i].data);
+    free(glob->pending);
+    for (i = 0; i < glob->track_count; i++)
+      free(glob->tracks[i].codec_private);
 
     delete glob;
 
@@ -112,22 +377,265 @@ FUNC(void, freeCfg, jlong jglob) {
   }
 }
 
-FUNC(jboolean, openFile, jlong jglob, jstring fileName) {
+FUNC(jboolean, openFile, jlong jglob, jstring fileName, jboolean live) {
   EbmlGlobal *glob = reinterpret_cast<EbmlGlobal*>(jglob);
   const char *mfile = env->GetStringUTFChars(fileName, 0);
 
   glob->stream = fopen(mfile, "wb");
+  if (glob->stream) {
+    glob->filename = strdup(mfile);
+    glob->current_filename = strdup(mfile);
+  }
 
   env->ReleaseStringUTFChars(fileName, mfile);
 
   if (!glob->stream)
     return JNI_TRUE;
 
+  /* A stream is only written whole clusters at a time, which are to reach
+   * the reader as soon as they are complete.
+   */
+  glob->live = live;
+  if (live)
+    setvbuf(glob->stream, NULL, _IONBF, 0);
+
   return JNI_FALSE;
 }
 
+FUNC(jstring, getFileName, jlong jglob) {
+  EbmlGlobal *glob = reinterpret_cast<EbmlGlobal*>(jglob);
+
+  return glob->current_filename
+      ? env->NewStringUTF(glob->current_filename)
+      : NULL;
+}
+
+FUNC(void, setRotation, jlong jglob, jlong duration, jlong size) {
+  EbmlGlobal *glob = reinterpret_cast<EbmlGlobal*>(jglob);
+
+  glob->rotate_ms = duration;
+  glob->rotate_bytes = size;
+}
+
+static int64_t monotonic_nanos() {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void *io_thread_run(void *arg) {
+  struct io_thread *io = reinterpret_cast<struct io_thread*>(arg);
+
+  for (;;) {
+    struct io_buffer *b;
+    unsigned int head = io->head;
+
+    if (io_empty(io)) {
+      io_park(io, &io->io_parked, io_empty);
+      /* Stop only once everything queued has been written. */
+      if (io_empty(io))
+        break;
+    }
+
+    b = &io->queue[head % IO_QUEUE_LENGTH];
+    if (fwrite(b->buf, 1, b->len, io->stream) != b->len)
+      __sync_fetch_and_add(&io->stats[IO_STAT_WRITE_ERRORS], 1);
+    io_store(&io->head, head + 1);
+    io_unpark(io, &io->writer_parked);
+  }
+  return NULL;
+}
+
+/* Passes the buffered cluster to the I/O thread, waiting for room in the
+ * queue if the disk is behind. The buffer of a written cluster is taken back
+ * in exchange.
+ */
+static void io_thread_enqueue(EbmlGlobal *glob) {
+  struct io_thread *io = glob->io;
+  struct io_buffer *b;
+  unsigned char *buf;
+  size_t cap;
+  unsigned int tail = io->tail;
+  unsigned int queued;
+
+  if (io_full(io)) {
+    int64_t start = monotonic_nanos();
+
+    io_park(io, &io->writer_parked, io_full);
+    io->stats[IO_STAT_STALLS]++;
+    io->stats[IO_STAT_STALL_NANOS] += monotonic_nanos() - start;
+  }
+
+  b = &io->queue[tail % IO_QUEUE_LENGTH];
+  buf = b->buf;
+  cap = b->cap;
+  b->buf = glob->buf;
+  b->len = glob->buf_len;
+  b->cap = glob->buf_cap;
+  glob->buf = buf;
+  glob->buf_cap = cap;
+
+  io->stats[IO_STAT_CLUSTERS]++;
+  io->stats[IO_STAT_BYTES] += b->len;
+  io_store(&io->tail, tail + 1);
+  io_unpark(io, &io->io_parked);
+
+  queued = tail + 1 - io_load(&io->head);
+  if ((int64_t)queued > io->stats[IO_STAT_MAX_QUEUED])
+    io->stats[IO_STAT_MAX_QUEUED] = queued;
+}
+
+/* Waits until the I/O thread has written everything queued, so that the file
+ * can be accessed directly.
+ */
+static void ebml_sync(EbmlGlobal *glob) {
+  struct io_thread *io = glob->io;
+
+  if (!glob->io_pending)
+    return;
+
+  if (io_not_empty(io))
+    io_park(io, &io->writer_parked, io_not_empty);
+  glob->io_pending = 0;
+}
+
+static void io_thread_stop(EbmlGlobal *glob) {
+  struct io_thread *io = glob->io;
+  int i;
+
+  if (!io)
+    return;
+
+  pthread_mutex_lock(&io->mutex);
+  io->stop = 1;
+  pthread_cond_broadcast(&io->cond);
+  pthread_mutex_unlock(&io->mutex);
+  pthread_join(io->thread, NULL);
+
+  pthread_cond_destroy(&io->cond);
+  pthread_mutex_destroy(&io->mutex);
+  for (i = 0; i < IO_QUEUE_LENGTH; i++)
+    free(io->queue[i].buf);
+  free(io);
+  glob->io = NULL;
+  glob->io_pending = 0;
+}
+
+FUNC(jboolean, startIOThread, jlong jglob) {
+  EbmlGlobal *glob = reinterpret_cast<EbmlGlobal*>(jglob);
+  struct io_thread *io;
+
+  if (glob->io)
+    return JNI_TRUE;
+  if (!glob->stream)
+    return JNI_FALSE;
+
+  io = reinterpret_cast<struct io_thread*>(calloc(1, sizeof(*io)));
+  if (!io)
+    return JNI_FALSE;
+  io->stream = glob->stream;
+  if (pthread_mutex_init(&io->mutex, NULL)) {
+    free(io);
+    return JNI_FALSE;
+  }
+  if (pthread_cond_init(&io->cond, NULL)) {
+    pthread_mutex_destroy(&io->mutex);
+    free(io);
+    return JNI_FALSE;
+  }
+  if (pthread_create(&io->thread, NULL, io_thread_run, io)) {
+    pthread_cond_destroy(&io->cond);
+    pthread_mutex_destroy(&io->mutex);
+    free(io);
+    return JNI_FALSE;
+  }
+  glob->io = io;
+  return JNI_TRUE;
+}
+
+FUNC(void, getIOStatistics, jlong jglob, jlongArray jstats) {
+  EbmlGlobal *glob = reinterpret_cast<EbmlGlobal*>(jglob);
+  jlong stats[IO_STATS_LENGTH];
+  jsize len = env->GetArrayLength(jstats);
+  int i;
+
+  memset(stats, 0, sizeof(stats));
+  if (glob->io) {
+    for (i = 0; i < IO_STATS_LENGTH; i++)
+      stats[i] = glob->io->stats[i];
+    stats[IO_STAT_QUEUED]
+        = io_load(&glob->io->tail) - io_load(&glob->io->head);
+  }
+  stats[IO_STAT_LATE_BLOCKS] = glob->late_blocks;
+  env->SetLongArrayRegion(
+      jstats, 0, len < IO_STATS_LENGTH ? len : IO_STATS_LENGTH, stats);
+}
+
+/* Writes out the buffered data, if any, or passes it to the I/O thread, and
+ * stops buffering.
+ */
+static void ebml_flush(EbmlGlobal *glob) {
+  if (glob->buffering && glob->buf_len) {
+    glob->stream_pos += glob->buf_len;
+    if (glob->io) {
+      glob->end_pos = glob->buf_pos + (off_t)glob->buf_len;
+      io_thread_enqueue(glob);
+      glob->io_pending = 1;
+    } else if (fwrite(glob->buf, 1, glob->buf_len, glob->stream)) {
+      ;
+    }
+  }
+  glob->buf_len = 0;
+  glob->buffering = 0;
+}
+
+/* Starts buffering the data written at the current position of the stream. */
+static void ebml_start_buffering(EbmlGlobal *glob) {
+  ebml_flush(glob);
+  if (glob->live)
+    glob->buf_pos = glob->stream_pos;
+  else
+    glob->buf_pos = glob->io_pending ? glob->end_pos : ftello(glob->stream);
+  glob->buffering = 1;
+}
+
+/* Gets the file offset at which the next byte will be written. */
+static off_t ebml_tell(EbmlGlobal *glob) {
+  if (glob->buffering)
+    return glob->buf_pos + (off_t)glob->buf_len;
+  if (glob->live)
+    return glob->stream_pos;
+  ebml_sync(glob);
+  return ftello(glob->stream);
+}
+
 extern "C" {
 void Ebml_Write(EbmlGlobal *glob, const void *buffer_in, unsigned long len) {
+  if (glob->buffering) {
+    if (glob->buf_len + len > glob->buf_cap) {
+      size_t cap = glob->buf_cap ? glob->buf_cap : CLUSTER_BUFFER_INITIAL_SIZE;
+      unsigned char *buf;
+
+      while (cap < glob->buf_len + len)
+        cap *= 2;
+      buf = reinterpret_cast<unsigned char*>(realloc(glob->buf, cap));
+      if (buf) {
+        glob->buf = buf;
+        glob->buf_cap = cap;
+      } else {
+        /* Fall back to writing (and patching sizes in) the file directly. */
+        ebml_flush(glob);
+      }
+    }
+    if (glob->buffering) {
+      memcpy(glob->buf + glob->buf_len, buffer_in, len);
+      glob->buf_len += len;
+      return;
+    }
+  }
+  ebml_sync(glob);
+  glob->stream_pos += len;
   if (fwrite(buffer_in, 1, len, glob->stream))
     ;
 }
@@ -135,15 +643,17 @@ void Ebml_Write(EbmlGlobal *glob, const void *buffer_in, unsigned long len) {
 
 #define WRITE_BUFFER(s) \
   for (i = len - 1; i >= 0; i--) { \
-    x = *(const s *)buffer_in >> (i * CHAR_BIT); \
-    Ebml_Write(glob, &x, 1ULL); \
+    x[len - 1 - i] = *(const s *)buffer_in >> (i * CHAR_BIT); \
   }
 extern "C" {
 void Ebml_Serialize(EbmlGlobal *glob, const void *buffer_in,
                     int buffer_size, unsigned long len) {
-  char x;
+  char x[8];
   int i;
 
+  if (len > sizeof(x))
+    return;
+
   /* buffer_size:
     * 1 - int8_t;
     * 2 - int16_t;
@@ -164,8 +674,10 @@ void Ebml_Serialize(EbmlGlobal *glob, const void *buffer_in,
       WRITE_BUFFER(int64_t)
       break;
     default:
-      break;
+      return;
   }
+  /* Write the big-endian bytes at once rather than one at a time. */
+  Ebml_Write(glob, x, len);
 }
 }
 #undef WRITE_BUFFER
@@ -188,7 +700,7 @@ static void Ebml_StartSubElement(EbmlGlobal *glob, EbmlLoc *ebmlLoc,
   uint64_t unknownLen =  LITERALU64(0x01FFFFFFFFFFFFFF);
 
   Ebml_WriteID(glob, class_id);
-  *ebmlLoc = ftello(glob->stream);
+  *ebmlLoc = ebml_tell(glob);
   Ebml_Serialize(glob, &unknownLen, sizeof(unknownLen), 8ULL);
 }
 
@@ -197,12 +709,28 @@ static void Ebml_EndSubElement(EbmlGlobal *glob, EbmlLoc *ebmlLoc) {
   uint64_t size;
 
   /* Save the current stream pointer */
-  pos = ftello(glob->stream);
+  pos = ebml_tell(glob);
 
   /* Calculate the size of this element */
   size = pos - *ebmlLoc - 8;
   size |=  LITERALU64(0x0100000000000000);
 
+  /* Patch the size in memory if the element is buffered */
+  if (glob->buffering && *ebmlLoc >= glob->buf_pos) {
+    unsigned char *p = glob->buf + (*ebmlLoc - glob->buf_pos);
+    int i;
+
+    for (i = 0; i < 8; i++)
+      p[i] = (unsigned char)(size >> ((7 - i) * CHAR_BIT));
+    return;
+  }
+
+  /* A stream cannot be seeked back so the size stays unknown. */
+  if (glob->live)
+    return;
+  ebml_flush(glob);
+  ebml_sync(glob);
+
   /* Seek back to the beginning of the element and write the new size */
   fseeko(glob->stream, *ebmlLoc, SEEK_SET);
   Ebml_Serialize(glob, &size, sizeof(size), 8ULL);
@@ -224,14 +752,15 @@ static void write_webm_seek_info(EbmlGlobal *ebml) {
   off_t pos;
 
   /* Save the current stream pointer */
-  pos = ftello(ebml->stream);
+  pos = ebml_tell(ebml);
 
   if (ebml->seek_info_pos)
     fseeko(ebml->stream, ebml->seek_info_pos, SEEK_SET);
   else
     ebml->seek_info_pos = pos;
 
-  {
+  /* A stream has no SeekHead since the positions are not known ahead. */
+  if (!ebml->live) {
     EbmlLoc start;
 
     Ebml_StartSubElement(ebml, &start, SeekHead);
@@ -253,27 +782,151 @@ static void write_webm_seek_info(EbmlGlobal *ebml) {
             vpx_codec_version_str(),
             sizeof(version_string) - 1 - strlen(version_string));
 
-    if (ebml->last_pts_ms > 0)
-      duration = ebml->last_pts_ms + frame_time;
+    if (ebml->last_pts_ms > ebml->file_start_ms)
+      duration = ebml->last_pts_ms - ebml->file_start_ms + frame_time;
     else
       duration = 0;
 
-    ebml->segment_info_pos = ftello(ebml->stream);
+    ebml->segment_info_pos = ebml_tell(ebml);
     Ebml_StartSubElement(ebml, &startInfo, Info);
     Ebml_SerializeUnsigned(ebml, TimecodeScale, 1000000);
-    Ebml_SerializeFloat(ebml, Segment_Duration, duration);
+    if (!ebml->live)
+      Ebml_SerializeFloat(ebml, Segment_Duration, duration);
     Ebml_SerializeString(ebml, MuxingApp, version_string);
     Ebml_SerializeString(ebml, WritingApp, version_string);
     Ebml_EndSubElement(ebml, &startInfo);
   }
 }
 
-FUNC(void, writeWebmFileHeader, jlong jglob,
-                                            jint width, jint height) {
+FUNC(void, setCueCheckpointInterval, jlong jglob, jlong interval) {
+  EbmlGlobal *glob = reinterpret_cast<EbmlGlobal*>(jglob);
+
+  glob->checkpoint_interval_ms = interval;
+}
+
+/* Registers a track to be described by the header. Returns NULL once the
+ * header has been written or if there are too many tracks.
+ */
+static struct track_entry *add_track(EbmlGlobal *glob, int type, int codec) {
+  struct track_entry *track;
+
+  if (glob->header_written || glob->track_count == WEBM_MAX_TRACKS)
+    return NULL;
+
+  track = &glob->tracks[glob->track_count++];
+  memset(track, 0, sizeof(*track));
+  track->type = type;
+  track->codec = codec;
+  track->last_pts_ms = -1;
+  if (type == TRACK_TYPE_VIDEO)
+    glob->video_tracks++;
+  return track;
+}
+
+FUNC(jint, addVideoTrack, jlong jglob, jint codec, jint width, jint height) {
+  EbmlGlobal *glob = reinterpret_cast<EbmlGlobal*>(jglob);
+  struct track_entry *track;
+
+  if (codec != WEBM_CODEC_VP8 && codec != WEBM_CODEC_VP9)
+    return -1;
+
+  track = add_track(glob, TRACK_TYPE_VIDEO, codec);
+  if (!track)
+    return -1;
+  track->width = width;
+  track->height = height;
+  return glob->track_count;
+}
+
+FUNC(jint, addAudioTrack, jlong jglob, jint codec, jint sampleRate,
+                          jint channels, jbyteArray codecPrivate) {
   EbmlGlobal *glob = reinterpret_cast<EbmlGlobal*>(jglob);
-  stereo_format_t stereo_fmt = STEREO_FORMAT_MONO;
+  struct track_entry *track;
+  unsigned char *data = NULL;
+  jsize len = 0;
+
+  if (codec != WEBM_CODEC_OPUS)
+    return -1;
+
+  if (codecPrivate) {
+    len = env->GetArrayLength(codecPrivate);
+    data = reinterpret_cast<unsigned char*>(malloc(len ? len : 1));
+    if (!data)
+      return -1;
+    env->GetByteArrayRegion(codecPrivate, 0, len,
+                            reinterpret_cast<jbyte*>(data));
+  }
+
+  track = add_track(glob, TRACK_TYPE_AUDIO, codec);
+  if (!track) {
+    free(data);
+    return -1;
+  }
+  track->sample_rate = sampleRate;
+  track->channels = channels;
+  track->codec_private = data;
+  track->codec_private_len = len;
+  return glob->track_count;
+}
+
+static void write_track_entry(EbmlGlobal *glob, unsigned int track_number,
+                              struct track_entry *track) {
+  static const char *codec_ids[] = { "V_VP8", "V_VP9", "A_OPUS" };
+  EbmlLoc start;
+
+  Ebml_StartSubElement(glob, &start, TrackEntry);
+  Ebml_SerializeUnsigned(glob, TrackNumber, track_number);
+  track->uid_pos = ebml_tell(glob);
+  /* The UIDs of a file are patched with the hash passed to the footer. */
+  Ebml_SerializeUnsigned32(glob, TrackUID, glob->live ? track_number : 0);
+  Ebml_SerializeUnsigned(glob, TrackType, track->type);
+  Ebml_SerializeString(glob, CodecID, codec_ids[track->codec]);
+  if (track->codec_private_len) {
+    Ebml_SerializeData(glob, CodecPrivate, track->codec_private,
+                       track->codec_private_len);
+  }
+
+  if (track->type == TRACK_TYPE_VIDEO) {
+    stereo_format_t stereo_fmt = STEREO_FORMAT_MONO;
+    EbmlLoc videoStart;
+
+    Ebml_StartSubElement(glob, &videoStart, Video);
+    Ebml_SerializeUnsigned(glob, PixelWidth, track->width);
+    Ebml_SerializeUnsigned(glob, PixelHeight, track->height);
+    Ebml_SerializeUnsigned(glob, StereoMode, stereo_fmt);
+    //Ebml_SerializeFloat(glob, FrameRate, frameRate);
+    Ebml_EndSubElement(glob, &videoStart);  // Video
+  } else {
+    EbmlLoc audioStart;
+
+    if (track->codec == WEBM_CODEC_OPUS) {
+      /* The decoder discards the pre-skip of the OpusHead, which is in
+       * 48 kHz samples.
+       */
+      if (track->codec_private_len >= 12) {
+        unsigned int pre_skip = track->codec_private[10]
+                                | (track->codec_private[11] << 8);
+
+        Ebml_SerializeUnsigned(glob, CODEC_DELAY_ID,
+                               (uint64_t)pre_skip * 1000000000 / 48000);
+      }
+      Ebml_SerializeUnsigned(glob, SEEK_PRE_ROLL_ID, OPUS_SEEK_PRE_ROLL);
+    }
+
+    Ebml_StartSubElement(glob, &audioStart, Audio);
+    Ebml_SerializeFloat(glob, SamplingFrequency, track->sample_rate);
+    Ebml_SerializeUnsigned(glob, Channels, track->channels);
+    Ebml_EndSubElement(glob, &audioStart);  // Audio
+  }
+  Ebml_EndSubElement(glob, &start);  // Track Entry
+}
 
+static void write_header(EbmlGlobal *glob) {
   EbmlLoc start;
+  /* The header of a stream is patched in memory and sent at once. */
+  if (glob->live)
+    ebml_start_buffering(glob);
+
   Ebml_StartSubElement(glob, &start, EBML);
   Ebml_SerializeUnsigned(glob, EBMLVersion, 1);
   Ebml_SerializeUnsigned(glob, EBMLReadVersion, 1);  // EBML Read Version
@@ -284,139 +937,333 @@ FUNC(void, writeWebmFileHeader, jlong jglob,
   Ebml_SerializeUnsigned(glob, DocTypeReadVersion, 2);  // Doc Type Read Version
   Ebml_EndSubElement(glob, &start);
 
+  glob->header_written = 1;
   {
     Ebml_StartSubElement(glob, &glob->startSegment, Segment);  // segment
-    glob->position_reference = ftello(glob->stream);
+    glob->position_reference = ebml_tell(glob);
     write_webm_seek_info(glob);
 
     {
       EbmlLoc trackStart;
-      glob->track_pos = ftello(glob->stream);
+      unsigned int i;
+
+      glob->track_pos = ebml_tell(glob);
       Ebml_StartSubElement(glob, &trackStart, Tracks);
-      {
-        unsigned int trackNumber = 1;
-        uint64_t     trackID = 0;
-
-        EbmlLoc start;
-        Ebml_StartSubElement(glob, &start, TrackEntry);
-        Ebml_SerializeUnsigned(glob, TrackNumber, trackNumber);
-        glob->track_id_pos = ftello(glob->stream);
-        Ebml_SerializeUnsigned32(glob, TrackUID, trackID);
-        Ebml_SerializeUnsigned(glob, TrackType, 1);  // video is always 1
-        Ebml_SerializeString(glob, CodecID, "V_VP8");
-        {
-          unsigned int pixelWidth = width;
-          unsigned int pixelHeight = height;
-
-          EbmlLoc videoStart;
-          Ebml_StartSubElement(glob, &videoStart, Video);
-          Ebml_SerializeUnsigned(glob, PixelWidth, pixelWidth);
-          Ebml_SerializeUnsigned(glob, PixelHeight, pixelHeight);
-          Ebml_SerializeUnsigned(glob, StereoMode, stereo_fmt);
-          //Ebml_SerializeFloat(glob, FrameRate, frameRate);
-          Ebml_EndSubElement(glob, &videoStart);  // Video
-        }
-        Ebml_EndSubElement(glob, &start);  // Track Entry
-      }
+      for (i = 0; i < glob->track_count; i++)
+        write_track_entry(glob, i + 1, &glob->tracks[i]);
       Ebml_EndSubElement(glob, &trackStart);
     }
     // segment element is open
   }
+
+  if (glob->live)
+    ebml_flush(glob);
 }
 
-FUNC(void, writeWebmBlock, jlong jglob, jobject jfd) {
+FUNC(void, writeWebmFileHeader, jlong jglob) {
   EbmlGlobal *glob = reinterpret_cast<EbmlGlobal*>(jglob);
 
-  jclass frameDescriptor = env->FindClass("org/jitsi/impl/neomedia/recording/WebmWriter$FrameDescriptor");
-  assert(frameDescriptor != NULL);
+  write_header(glob);
+}
+
+/* Saves a cue point at the open cluster. A cue which cannot be stored is
+ * dropped: the file is then less finely indexed but still valid.
+ */
+static void add_cue(EbmlGlobal *glob, unsigned int time, unsigned int track) {
+  struct cue_chunk *chunk = glob->cue_tail;
+  struct cue_entry *cue;
+
+  if (!chunk || chunk->count == CUE_CHUNK_LENGTH) {
+    chunk = reinterpret_cast<struct cue_chunk*>(malloc(sizeof(*chunk)));
+    if (!chunk)
+      return;
+    chunk->next = NULL;
+    chunk->count = 0;
+    if (glob->cue_tail)
+      glob->cue_tail->next = chunk;
+    else
+      glob->cue_head = chunk;
+    glob->cue_tail = chunk;
+  }
+
+  cue = &chunk->entries[chunk->count++];
+  cue->time = time;
+  cue->loc = glob->cluster_pos;
+  cue->track = track;
+  glob->cues++;
+  glob->cluster_cued |= 1U << (track - 1);
+}
+
+/* Writes a Cues element with all the cues so far at the current position of
+ * the stream.
+ */
+static void write_cues(EbmlGlobal *glob) {
+  struct cue_chunk *chunk = glob->cue_head;
+  unsigned int i = 0;
+  EbmlLoc start;
+
+  glob->cue_pos = ftello(glob->stream);
+  Ebml_StartSubElement(glob, &start, Cues);
+  while (chunk && i < chunk->count) {
+    unsigned int time = chunk->entries[i].time;
+    EbmlLoc start;
+
+    /* One cue point holds the positions of all tracks cued at a time. */
+    Ebml_StartSubElement(glob, &start, CuePoint);
+    Ebml_SerializeUnsigned(glob, CueTime, time);
+    while (chunk && chunk->entries[i].time == time) {
+      struct cue_entry *cue = &chunk->entries[i];
+      EbmlLoc start;
+
+      Ebml_StartSubElement(glob, &start, CueTrackPositions);
+      Ebml_SerializeUnsigned(glob, CueTrack, cue->track);
+      Ebml_SerializeUnsigned64(glob, CueClusterPosition,
+                                cue->loc - glob->position_reference);
+      // Ebml_SerializeUnsigned(glob, CueBlockNumber, cue->blockNumber);
+      Ebml_EndSubElement(glob, &start);
+
+      if (++i == chunk->count) {
+        chunk = chunk->next;
+        i = 0;
+      }
+    }
+    Ebml_EndSubElement(glob, &start);
+  }
+  Ebml_EndSubElement(glob, &start);
+  glob->cue_len = ftello(glob->stream) - glob->cue_pos;
+}
+
+/* Turns an element written at a specific position into a Void element of the
+ * same size.
+ */
+static void write_void(EbmlGlobal *glob, off_t pos, off_t len) {
+  unsigned char id = VOID_ID;
+  uint64_t size = (len - 1 - 8) | LITERALU64(0x0100000000000000);
+
+  fseeko(glob->stream, pos, SEEK_SET);
+  Ebml_Write(glob, &id, 1);
+  Ebml_Serialize(glob, &size, sizeof(size), 8ULL);
+}
+
+/* Writes the cues so far between two clusters and points the SeekHead at
+ * them, so that a file which is never finished (e.g. because the recorder
+ * crashed) stays seekable up to here. The Cues of the previous checkpoint are
+ * only voided once the new ones are in place, so every checkpoint leaves all
+ * the cues before it behind as dead bytes.
+ */
+static void write_checkpoint(EbmlGlobal *glob) {
+  off_t prev_pos = glob->cue_pos;
+  off_t prev_len = glob->cue_len;
+  off_t pos;
+
+  ebml_sync(glob);
+  write_cues(glob);
+  pos = ftello(glob->stream);
+  fflush(glob->stream);
+
+  /* Also updates the duration. */
+  write_webm_seek_info(glob);
+  fflush(glob->stream);
+
+  if (prev_pos)
+    write_void(glob, prev_pos, prev_len);
+
+  fseeko(glob->stream, pos, SEEK_SET);
+  fflush(glob->stream);
+
+  glob->checkpoint_ms = glob->last_pts_ms;
+  glob->checkpoint_cues = glob->cues;
+}
+
+static void finish_file(EbmlGlobal *glob, uint64_t hash) {
+  off_t prev_pos, prev_len;
+  unsigned int i;
 
-  jfieldID bufferId = env->GetFieldID(frameDescriptor, "buffer", "[B");
-  assert(bufferId != NULL);
+  prev_pos = glob->cue_pos;
+  prev_len = glob->cue_len;
+  //2
+  write_cues(glob);
+
+  Ebml_EndSubElement(glob, &glob->startSegment);
+
+  /* Patch up the seek info block */
+  write_webm_seek_info(glob);
+
+  /* Drop the Cues of the last checkpoint */
+  if (prev_pos)
+    write_void(glob, prev_pos, prev_len);
+
+  /* Patch up the track ids */
+  for (i = 0; i < glob->track_count; i++) {
+    fseeko(glob->stream, glob->tracks[i].uid_pos, SEEK_SET);
+    Ebml_SerializeUnsigned32(glob, TrackUID, hash + i);
+  }
 
-  jfieldID offsetId = env->GetFieldID(frameDescriptor, "offset", "I");
-  assert(offsetId != NULL);
+  fseeko(glob->stream, 0, SEEK_END);
+}
 
-  jfieldID lengthId = env->GetFieldID(frameDescriptor, "length", "J");
-  assert(lengthId != NULL);
+/* Derives the name of a file of the rotation from that of the first one, e.g.
+ * rec-2.webm from rec.webm.
+ */
+static char *rotation_filename(const char *filename, unsigned int index) {
+  const char *slash = strrchr(filename, '/');
+  const char *dot = strrchr(filename, '.');
+  size_t stem, len;
+  char *name;
+
+  if (!dot || (slash && dot < slash) || dot == (slash ? slash + 1 : filename))
+    dot = filename + strlen(filename);
+  stem = dot - filename;
+  len = strlen(filename) + 12;
+  name = reinterpret_cast<char*>(malloc(len));
+  if (name)
+    snprintf(name, len, "%.*s-%u%s", (int)stem, filename, index, dot);
+  return name;
+}
 
-  jfieldID flagsId = env->GetFieldID(frameDescriptor, "flags", "I");
-  assert(flagsId != NULL);
+static int rotation_due(EbmlGlobal *glob, int64_t pts_ms) {
+  if (glob->live || !glob->filename)
+    return 0;
+  return (glob->rotate_ms > 0
+          && pts_ms - glob->file_start_ms >= glob->rotate_ms)
+         || (glob->rotate_bytes > 0
+             && glob->stream_pos >= glob->rotate_bytes);
+}
 
-  jfieldID ptsId = env->GetFieldID(frameDescriptor, "pts", "J");
-  assert(ptsId != NULL);
+/* Completes the current file, between two clusters, and continues with the
+ * same tracks in the next file of the rotation, whose time stamps start at
+ * pts_ms. Writing goes on in the current file if the next one cannot be
+ * opened, and the rotation is attempted again at the next keyframe.
+ */
+static void rotate_file(EbmlGlobal *glob, int64_t pts_ms) {
+  char *filename = rotation_filename(glob->filename, glob->file_index + 1);
+  FILE *stream;
 
-  jobject jba = env->GetObjectField(jfd, bufferId);
-  assert(jba != NULL);
+  if (!filename)
+    return;
+  stream = fopen(filename, "wb");
+  if (!stream) {
+    free(filename);
+    return;
+  }
 
-  jint offset = env->GetIntField(jfd, offsetId);
+  ebml_sync(glob);
+  finish_file(glob, 0);
+  fclose(glob->stream);
 
-  jint frameFlags = env->GetIntField(jfd, flagsId);
+  /* The I/O thread is idle after ebml_sync. */
+  glob->stream = stream;
+  if (glob->io) {
+    glob->io->stream = stream;
+    __sync_synchronize();
+  }
+  free(glob->current_filename);
+  glob->current_filename = filename;
+  glob->file_index++;
+  glob->rotated = 1;
+
+  free_cues(glob);
+  glob->cue_pos = 0;
+  glob->cue_len = 0;
+  glob->checkpoint_cues = 0;
+  glob->checkpoint_ms = pts_ms;
+  glob->seek_info_pos = 0;
+  glob->segment_info_pos = 0;
+  glob->cluster_open = 0;
+  glob->stream_pos = 0;
+  glob->file_start_ms = pts_ms;
+
+  write_header(glob);
+}
 
+static void write_block(EbmlGlobal *glob, unsigned int track_number,
+                        int64_t pts_ms, int frameFlags,
+                        const void *data, uint64_t frameSz) {
+  struct track_entry *track = &glob->tracks[track_number - 1];
   uint64_t       block_length;
-  unsigned char  track_number;
+  unsigned char  track_byte;
   uint16_t       block_timecode = 0;
   unsigned char  flags;
-  int64_t        pts_ms;
   int            start_cluster = 0, is_keyframe;
 
-  /* Calculate the PTS of this frame in milliseconds */
-  pts_ms = env->GetLongField(jfd, ptsId);
-  if (pts_ms <= glob->last_pts_ms)
-    pts_ms = glob->last_pts_ms + 1;
+  /* A block which waited longer than the other tracks allow is written with
+   * the time stamp of its predecessor so that the blocks stay in order.
+   * Dropping it instead would break the decoding of the video up to the next
+   * keyframe.
+   */
+  if (pts_ms < glob->last_pts_ms) {
+    glob->late_blocks++;
+    pts_ms = glob->last_pts_ms;
+  }
   glob->last_pts_ms = pts_ms;
 
-  /* Calculate the relative time of this block */
-  if (pts_ms - glob->cluster_timecode > SHRT_MAX)
+  /* Every audio frame can be decoded on its own. */
+  is_keyframe = (frameFlags & VPX_FRAME_IS_KEY)
+                || track->type == TRACK_TYPE_AUDIO;
+
+  /* Start clusters at the keyframes of the video, if any, so that they are
+   * seekable, and at regular intervals otherwise.
+   */
+  if (!glob->cluster_open || pts_ms - glob->cluster_timecode > SHRT_MAX)
     start_cluster = 1;
-  else
+  else if (track->type == TRACK_TYPE_VIDEO)
+    start_cluster = is_keyframe;
+  else if (!glob->video_tracks)
+    start_cluster
+        = pts_ms - glob->cluster_timecode >= AUDIO_CLUSTER_DURATION_MS;
+
+  /* Calculate the relative time of this block */
+  if (!start_cluster)
     block_timecode = pts_ms - glob->cluster_timecode;
 
-  is_keyframe = (frameFlags & VPX_FRAME_IS_KEY);
-  if (start_cluster || is_keyframe) {
-    if (glob->cluster_open)
+  if (start_cluster) {
+    if (glob->cluster_open) {
       Ebml_EndSubElement(glob, &glob->startCluster);
+      ebml_flush(glob);
+    }
+
+    /* Only a keyframe of the video, if any, can start a new file. */
+    if (is_keyframe
+        && (track->type == TRACK_TYPE_VIDEO || !glob->video_tracks)
+        && rotation_due(glob, pts_ms))
+      rotate_file(glob, pts_ms);
+
+    if (!glob->live
+        && glob->checkpoint_interval_ms > 0
+        && glob->cues != glob->checkpoint_cues
+        && pts_ms - glob->checkpoint_ms >= glob->checkpoint_interval_ms)
+      write_checkpoint(glob);
 
     /* Open the new cluster */
-    block_timecode = 0;
     glob->cluster_open = 1;
     glob->cluster_timecode = pts_ms;
-    glob->cluster_pos = ftello(glob->stream);
+    glob->cluster_cued = 0;
+    ebml_start_buffering(glob);
+    glob->cluster_pos = ebml_tell(glob);
     Ebml_StartSubElement(glob, &glob->startCluster, Cluster);  // cluster
-    Ebml_SerializeUnsigned(glob, Timecode, glob->cluster_timecode);
-
-    /* Save a cue point if this is a keyframe. */
-    if (is_keyframe) {
-      struct cue_entry *cue, *new_cue_list;
-
-      new_cue_list = reinterpret_cast<cue_entry*>(realloc(glob->cue_list,
-                     (glob->cues+1) * sizeof(struct cue_entry)));
-      if (new_cue_list) {
-        glob->cue_list = new_cue_list;
-      } else {
-        // TODO(frkoenig) : Handle this error better/correctly
-        fprintf(stderr, "\nFailed to realloc cue list.\n");
-        exit(EXIT_FAILURE);
-      }
-
-      cue = &glob->cue_list[glob->cues];
-      cue->time = glob->cluster_timecode;
-      cue->loc = glob->cluster_pos;
-      glob->cues++;
-    }
+    Ebml_SerializeUnsigned(glob, Timecode,
+                           glob->cluster_timecode - glob->file_start_ms);
   }
 
+  /* Save a cue point for the keyframes of the video and for the first block
+   * of each audio track in each cluster. A stream has no cues.
+   */
+  if (!glob->live
+      && (track->type == TRACK_TYPE_VIDEO
+          ? is_keyframe
+          : !(glob->cluster_cued & (1U << (track_number - 1)))))
+    add_cue(glob, pts_ms - glob->file_start_ms, track_number);
+
   /* Write the Simple Block */
   Ebml_WriteID(glob, SimpleBlock);
 
-  jlong frameSz =  env->GetLongField(jfd, lengthId);
-
   block_length = frameSz + 4;
   block_length |= 0x10000000;
   Ebml_Serialize(glob, &block_length, sizeof(block_length), 4ULL);
 
-  track_number = 1;
-  track_number |= 0x80;
-  Ebml_Write(glob, &track_number, 1ULL);
+  track_byte = track_number;
+  track_byte |= 0x80;
+  Ebml_Write(glob, &track_byte, 1ULL);
 
   Ebml_Serialize(glob, &block_timecode, sizeof(block_timecode), 2ULL);
 
@@ -427,57 +1274,302 @@ FUNC(void, writeWebmBlock, jlong jglob, jobject jfd) {
     flags |= 0x08;
   Ebml_Write(glob, &flags, 1ULL);
 
-  jbyte *frameBuf = env->GetByteArrayElements((jbyteArray)jba, 0);
+  Ebml_Write(glob, data, frameSz);
+}
 
-  Ebml_Write(glob, frameBuf + offset, static_cast<uint64_t>(frameSz));
+/* Queues a block of a multi-track file, in time stamp order. Returns zero if
+ * the block could not be queued.
+ */
+static int pending_push(EbmlGlobal *glob, unsigned int track_number,
+                        int64_t pts_ms, int flags,
+                        const void *data, size_t len) {
+  struct pending_block *block;
+  unsigned int i;
+
+  if (glob->pending_count == glob->pending_cap) {
+    unsigned int cap = glob->pending_cap ? glob->pending_cap * 2 : 16;
+    struct pending_block *pending
+        = reinterpret_cast<struct pending_block*>(
+            realloc(glob->pending, cap * sizeof(*pending)));
+
+    if (!pending)
+      return 0;
+    glob->pending = pending;
+    glob->pending_cap = cap;
+  }
 
-  env->ReleaseByteArrayElements((jbyteArray)jba, frameBuf, 0);
+  /* The blocks of each track are in order so the new one is usually last. */
+  for (i = glob->pending_count;
+       i > 0 && glob->pending[i - 1].pts_ms > pts_ms;
+       i--);
+
+  block = &glob->pending[i];
+  memmove(block + 1, block, (glob->pending_count - i) * sizeof(*block));
+  block->data = reinterpret_cast<unsigned char*>(malloc(len ? len : 1));
+  if (!block->data) {
+    memmove(block, block + 1, (glob->pending_count - i) * sizeof(*block));
+    return 0;
+  }
+  memcpy(block->data, data, len);
+  block->len = len;
+  block->pts_ms = pts_ms;
+  block->track = track_number;
+  block->flags = flags;
+  glob->pending_count++;
+  return 1;
 }
 
-FUNC(void, writeWebmFileFooter, jlong jglob, jlong hash) {
-  EbmlGlobal *glob = reinterpret_cast<EbmlGlobal*>(jglob);
+/* Writes the queued blocks which no block of another track can precede any
+ * more, i.e. those not later than the last block of every track, as well as
+ * those which have waited too long. Writes all of them if all is non-zero.
+ */
+static void pending_release(EbmlGlobal *glob, int all) {
+  int64_t horizon = LLONG_MAX;
+  int64_t newest;
+  unsigned int i, n;
 
-  //1
-  if (glob->cluster_open)
-    Ebml_EndSubElement(glob, &glob->startCluster);
+  if (!glob->pending_count)
+    return;
 
-  {
-    EbmlLoc start;
-    unsigned int i;
+  for (i = 0; i < glob->track_count; i++) {
+    if (glob->tracks[i].last_pts_ms < horizon)
+      horizon = glob->tracks[i].last_pts_ms;
+  }
+  newest = glob->pending[glob->pending_count - 1].pts_ms;
 
-    glob->cue_pos = ftello(glob->stream);
-    Ebml_StartSubElement(glob, &start, Cues);
-  //2
-    for (i = 0; i < glob->cues; i++) {
-      struct cue_entry *cue = &glob->cue_list[i];
-      EbmlLoc start;
+  for (n = 0; n < glob->pending_count; n++) {
+    struct pending_block *block = &glob->pending[n];
 
-      Ebml_StartSubElement(glob, &start, CuePoint);
-      {
-        EbmlLoc start;
+    if (!all
+        && block->pts_ms > horizon
+        && newest - block->pts_ms <= INTERLEAVE_MAX_DELAY_MS)
+      break;
+    write_block(glob, block->track, block->pts_ms, block->flags,
+                block->data, block->len);
+    free(block->data);
+  }
+  glob->pending_count -= n;
+  memmove(glob->pending, glob->pending + n,
+          glob->pending_count * sizeof(*glob->pending));
+}
 
-        Ebml_SerializeUnsigned(glob, CueTime, cue->time);
+/* The fields of WebmWriter$FrameDescriptor. */
+static struct {
+  jclass   clazz;
+  jfieldID buffer;
+  jfieldID offset;
+  jfieldID length;
+  jfieldID flags;
+  jfieldID pts;
+  jfieldID track;
+} frame_descriptor;
+
+/* Looks up the fields of WebmWriter$FrameDescriptor once, when the library
+ * is loaded or else (if the class is not visible then) on first use. The
+ * class is kept referenced so that the field IDs stay valid. Returns zero
+ * if the class or one of its fields is not found.
+ */
+static int frame_descriptor_init(JNIEnv *env) {
+  jclass clazz;
 
-        Ebml_StartSubElement(glob, &start, CueTrackPositions);
-        Ebml_SerializeUnsigned(glob, CueTrack, 1);
-        Ebml_SerializeUnsigned64(glob, CueClusterPosition,
-                                  cue->loc - glob->position_reference);
-        // Ebml_SerializeUnsigned(glob, CueBlockNumber, cue->blockNumber);
-        Ebml_EndSubElement(glob, &start);
-      }
-      Ebml_EndSubElement(glob, &start);
+  if (frame_descriptor.clazz)
+    return 1;
+
+  clazz = env->FindClass(
+      "org/jitsi/impl/neomedia/recording/WebmWriter$FrameDescriptor");
+  if (!clazz) {
+    env->ExceptionClear();
+    return 0;
+  }
+
+  frame_descriptor.buffer = env->GetFieldID(clazz, "buffer", "[B");
+  if (frame_descriptor.buffer)
+    frame_descriptor.offset = env->GetFieldID(clazz, "offset", "I");
+  if (frame_descriptor.offset)
+    frame_descriptor.length = env->GetFieldID(clazz, "length", "J");
+  if (frame_descriptor.length)
+    frame_descriptor.flags = env->GetFieldID(clazz, "flags", "I");
+  if (frame_descriptor.flags)
+    frame_descriptor.pts = env->GetFieldID(clazz, "pts", "J");
+  if (frame_descriptor.pts)
+    frame_descriptor.track = env->GetFieldID(clazz, "track", "I");
+  if (!frame_descriptor.track) {
+    env->ExceptionClear();
+    env->DeleteLocalRef(clazz);
+    return 0;
+  }
+
+  frame_descriptor.clazz = reinterpret_cast<jclass>(env->NewGlobalRef(clazz));
+  env->DeleteLocalRef(clazz);
+  return frame_descriptor.clazz != NULL;
+}
+
+extern "C" JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM *vm, void *reserved) {
+  JNIEnv *env;
+
+  if (vm->GetEnv(reinterpret_cast<void **>(&env), JNI_VERSION_1_4) == JNI_OK)
+    frame_descriptor_init(env);
+  return JNI_VERSION_1_4;
+}
+
+extern "C" JNIEXPORT void JNICALL JNI_OnUnload(JavaVM *vm, void *reserved) {
+  JNIEnv *env;
+
+  if (frame_descriptor.clazz
+      && vm->GetEnv(reinterpret_cast<void **>(&env), JNI_VERSION_1_4)
+          == JNI_OK) {
+    env->DeleteGlobalRef(frame_descriptor.clazz);
+    frame_descriptor.clazz = NULL;
+  }
+}
+
+/* Writes a frame of a track, directly if the file has a single track and
+ * after interleaving it with the frames of the other tracks otherwise.
+ */
+static void write_frame(EbmlGlobal *glob, jint track_number, int64_t pts_ms,
+                        int frameFlags, const void *data, size_t frameSz) {
+  struct track_entry *track;
+
+  if (track_number < 1 || (unsigned int)track_number > glob->track_count)
+    return;
+  track = &glob->tracks[track_number - 1];
+
+  if (pts_ms <= track->last_pts_ms)
+    pts_ms = track->last_pts_ms + 1;
+  track->last_pts_ms = pts_ms;
+
+  /* The blocks of a single track are in order already. Those of several
+   * tracks are interleaved by time stamp.
+   */
+  if (glob->track_count == 1
+      || !pending_push(glob, track_number, pts_ms, frameFlags,
+                       data, frameSz)) {
+    pending_release(glob, 1);
+    write_block(glob, track_number, pts_ms, frameFlags, data, frameSz);
+  }
+
+  pending_release(glob, 0);
+}
+
+/* Tells whether the file was rotated since the last call. */
+static jboolean take_rotated(EbmlGlobal *glob) {
+  if (glob->rotated) {
+    glob->rotated = 0;
+    return JNI_TRUE;
+  }
+  return JNI_FALSE;
+}
+
+FUNC(jboolean, writeWebmBlock, jlong jglob, jobject jfd) {
+  EbmlGlobal *glob = reinterpret_cast<EbmlGlobal*>(jglob);
+
+  if (!frame_descriptor_init(env))
+    return JNI_FALSE;
+
+  jbyteArray jba
+      = (jbyteArray)env->GetObjectField(jfd, frame_descriptor.buffer);
+  jint offset = env->GetIntField(jfd, frame_descriptor.offset);
+  jlong frameSz = env->GetLongField(jfd, frame_descriptor.length);
+
+  if (!jba
+      || offset < 0
+      || frameSz < 0
+      || frameSz > env->GetArrayLength(jba) - offset)
+    return JNI_FALSE;
+
+  /* Copy the frame only, rather than the whole array which
+   * GetByteArrayElements may copy.
+   */
+  if ((size_t)frameSz > glob->frame_buf_cap) {
+    unsigned char *buf
+        = reinterpret_cast<unsigned char*>(malloc((size_t)frameSz));
+
+    if (!buf)
+      return JNI_FALSE;
+    free(glob->frame_buf);
+    glob->frame_buf = buf;
+    glob->frame_buf_cap = (size_t)frameSz;
+  }
+  env->GetByteArrayRegion(jba, offset, (jsize)frameSz,
+                          reinterpret_cast<jbyte*>(glob->frame_buf));
+
+  write_frame(glob,
+              env->GetIntField(jfd, frame_descriptor.track),
+              env->GetLongField(jfd, frame_descriptor.pts),
+              env->GetIntField(jfd, frame_descriptor.flags),
+              glob->frame_buf, (size_t)frameSz);
+
+  return take_rotated(glob);
+}
+
+/* The layout of the descriptors of writeWebmBlocks, as in WebmWriter.java,
+ * and the number of descriptors copied from java at a time.
+ */
+#define BLOCK_OFFSET            0
+#define BLOCK_LENGTH            1
+#define BLOCK_PTS               2
+#define BLOCK_FLAGS             3
+#define BLOCK_TRACK             4
+#define BLOCK_DESCRIPTOR_LENGTH 5
+#define BLOCK_BATCH_LENGTH      32
+
+FUNC(jboolean, writeWebmBlocks, jlong jglob, jobject jbuf,
+     jlongArray jdescriptors, jint count) {
+  EbmlGlobal *glob = reinterpret_cast<EbmlGlobal*>(jglob);
+  jlong descriptors[BLOCK_BATCH_LENGTH * BLOCK_DESCRIPTOR_LENGTH];
+  unsigned char *data
+      = reinterpret_cast<unsigned char*>(env->GetDirectBufferAddress(jbuf));
+  jlong capacity = env->GetDirectBufferCapacity(jbuf);
+  jint i, j, n;
+
+  if (!data
+      || capacity < 0
+      || count < 0
+      || (jlong)count * BLOCK_DESCRIPTOR_LENGTH
+          > env->GetArrayLength(jdescriptors))
+    return JNI_FALSE;
+
+  for (i = 0; i < count; i += n) {
+    n = count - i;
+    if (n > BLOCK_BATCH_LENGTH)
+      n = BLOCK_BATCH_LENGTH;
+    env->GetLongArrayRegion(jdescriptors, i * BLOCK_DESCRIPTOR_LENGTH,
+                            n * BLOCK_DESCRIPTOR_LENGTH, descriptors);
+
+    for (j = 0; j < n; j++) {
+      const jlong *block = descriptors + j * BLOCK_DESCRIPTOR_LENGTH;
+      jlong offset = block[BLOCK_OFFSET];
+      jlong length = block[BLOCK_LENGTH];
+
+      if (offset < 0 || length < 0 || offset > capacity - length)
+        continue;
+      write_frame(glob, (jint)block[BLOCK_TRACK], block[BLOCK_PTS],
+                  (int)block[BLOCK_FLAGS], data + offset, (size_t)length);
     }
-    Ebml_EndSubElement(glob, &start);
   }
 
-  Ebml_EndSubElement(glob, &glob->startSegment);
+  return take_rotated(glob);
+}
 
-  /* Patch up the seek info block */
-  write_webm_seek_info(glob);
+/* Completes the file after its last cluster: writes the cues and patches the
+ * sizes, the SeekHead and the track UIDs.
+ */
+FUNC(void, writeWebmFileFooter, jlong jglob, jlong hash) {
+  EbmlGlobal *glob = reinterpret_cast<EbmlGlobal*>(jglob);
 
-  /* Patch up the track id */
-  fseeko(glob->stream, glob->track_id_pos, SEEK_SET);
-  Ebml_SerializeUnsigned32(glob, TrackUID, hash);
+  pending_release(glob, 1);
 
-  fseeko(glob->stream, 0, SEEK_END);
+  //1
+  if (glob->cluster_open) {
+    Ebml_EndSubElement(glob, &glob->startCluster);
+    ebml_flush(glob);
+    glob->cluster_open = 0;
+  }
+  ebml_sync(glob);
+
+  /* The end of a stream is the end of its last cluster. */
+  if (glob->live)
+    return;
+
+  finish_file(glob, hash);
 }
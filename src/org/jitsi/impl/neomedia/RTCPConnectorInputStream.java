@@ -103,8 +103,21 @@ public static void fireRTCPFeedbackMessageReceived(
                     || (pt == RTCPFeedbackMessageEvent.PT_TL))
             {
                 int fmt = buffer[offset] & 0x1F;
+                // The length of the packet in 32-bit words minus one.
+                int words
+                    = ((buffer[offset + 2] & 0xFF) << 8)
+                        | (buffer[offset + 3] & 0xFF);
+                int fciLength = Math.min(length, (words + 1) * 4) - 12;
+                byte[] fci = null;
+
+                if (fciLength > 0)
+                {
+                    fci = new byte[fciLength];
+                    System.arraycopy(buffer, offset + 12, fci, 0, fciLength);
+                }
+
                 RTCPFeedbackMessageEvent ev
-                    = new RTCPFeedbackMessageEvent(source, fmt, pt);
+                    = new RTCPFeedbackMessageEvent(source, fmt, pt, fci);
 
                 for (RTCPFeedbackMessageListener l : listeners)
                     l.rtcpFeedbackMessageReceived(ev);
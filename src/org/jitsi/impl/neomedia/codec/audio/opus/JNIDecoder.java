@@ -23,6 +23,8 @@
 import net.sf.fmj.media.*;
 
 import org.jitsi.impl.neomedia.codec.*;
+import org.jitsi.impl.neomedia.codec.video.*;
+import org.jitsi.impl.neomedia.jmfext.media.protocol.*;
 import org.jitsi.impl.neomedia.jmfext.media.renderer.audio.*;
 import org.jitsi.service.neomedia.codec.*;
 import org.jitsi.service.neomedia.control.*;
@@ -44,6 +46,13 @@
      */
     private static final Logger logger = Logger.getLogger(JNIDecoder.class);
 
+    /**
+     * The pool of native memory shared by the <tt>JNIDecoder</tt> instances,
+     * which reduces the allocations of native memory when calls are set up
+     * and torn down.
+     */
+    private static final ByteBufferPool byteBufferPool = new ByteBufferPool();
+
     /**
      * The list of <tt>Format</tt>s of audio data supported as input by
      * <tt>JNIDecoder</tt> instances.
@@ -81,6 +90,11 @@
         Opus.assertOpusIsFunctional();
     }
 
+    /**
+     * The maximum duration in milliseconds of the audio of an Opus packet.
+     */
+    private static final int MAX_FRAME_DURATION = 120;
+
     /**
      * Number of channels to decode into.
      */
@@ -102,6 +116,19 @@
      */
     private long lastSeqNo = Buffer.SEQUENCE_UNKNOWN;
 
+    /**
+     * The native memory from which the native decoder reads the Opus packet
+     * to be decoded.
+     */
+    private ByteBuffer nativeIn;
+
+    /**
+     * The native memory into which the native decoder writes the decoded
+     * audio, or <tt>null</tt> if the native decoder works on the arrays of the
+     * <tt>Buffer</tt>s because native memory cannot be allocated.
+     */
+    private ByteBuffer nativeOut;
+
     /**
      * Number of packets decoded with FEC
      */
@@ -133,6 +160,90 @@ public JNIDecoder()
         addControl(this);
     }
 
+    /**
+     * Decodes an Opus packet, or conceals a lost one, into the data of a
+     * specific output <tt>Buffer</tt>. The native decoder works on native
+     * memory which, unlike arrays, it can access without stalling the garbage
+     * collector.
+     *
+     * @param in the array which holds the packet, or <tt>null</tt>
+     * @param inOffset the offset in <tt>in</tt> at which the packet begins
+     * @param inLength the length in bytes of the packet, or <tt>0</tt> to
+     * conceal a lost packet
+     * @param outBuf the output <tt>Buffer</tt>
+     * @param outOffset the offset in the data of <tt>outBuf</tt> at which the
+     * decoded audio is to be output
+     * @param outFrameSize the number of samples per channel of the maximum
+     * space available for the decoded audio
+     * @param decodeFEC 0 to decode the packet normally, 1 to decode the FEC
+     * data in the packet
+     * @return the number of decoded samples per channel, or a negative error
+     * code
+     */
+    private int decode(
+            byte[] in, int inOffset, int inLength,
+            Buffer outBuf, int outOffset, int outFrameSize,
+            int decodeFEC)
+    {
+        if (nativeOut == null)
+        {
+            byte[] out
+                = validateByteArraySize(
+                        outBuf,
+                        outOffset + outFrameSize * outputFrameSize,
+                        outOffset != 0);
+
+            return
+                Opus.decode(
+                        decoder,
+                        in, inOffset, inLength,
+                        out, outOffset, outFrameSize,
+                        decodeFEC);
+        }
+
+        long inPtr = 0;
+
+        if ((in != null) && (inLength > 0))
+        {
+            if (nativeIn.getCapacity() < inLength)
+            {
+                nativeIn.free();
+                nativeIn = byteBufferPool.getBuffer(inLength);
+            }
+            FFmpeg.memcpy(nativeIn.getPtr(), in, inOffset, inLength);
+            inPtr = nativeIn.getPtr();
+        }
+
+        // Opus.decodeAddress does not check bounds.
+        int outLength = outFrameSize * outputFrameSize;
+
+        if (nativeOut.getCapacity() < outLength)
+        {
+            nativeOut.free();
+            nativeOut = byteBufferPool.getBuffer(outLength);
+        }
+
+        int frameSize
+            = Opus.decodeAddress(
+                    decoder,
+                    inPtr, inLength,
+                    nativeOut.getPtr(), outFrameSize,
+                    decodeFEC);
+
+        if (frameSize > 0)
+        {
+            int frameSizeInBytes = frameSize * outputFrameSize;
+            byte[] out
+                = validateByteArraySize(
+                        outBuf,
+                        outOffset + frameSizeInBytes,
+                        outOffset != 0);
+
+            FFmpeg.memcpy(out, outOffset, frameSizeInBytes, nativeOut.getPtr());
+        }
+        return frameSize;
+    }
+
     /**
      * @see AbstractCodec2#doClose()
      */
@@ -144,6 +255,17 @@ protected void doClose()
             Opus.decoder_destroy(decoder);
             decoder = 0;
         }
+
+        if (nativeIn != null)
+        {
+            nativeIn.free();
+            nativeIn = null;
+        }
+        if (nativeOut != null)
+        {
+            nativeOut.free();
+            nativeOut = null;
+        }
     }
 
     /**
@@ -169,9 +291,40 @@ protected void doOpen()
 
             lastFrameSizeInSamplesPerChannel = 0;
             lastSeqNo = Buffer.SEQUENCE_UNKNOWN;
+
+            try
+            {
+                nativeIn = byteBufferPool.getBuffer(Opus.MAX_PACKET);
+                nativeOut
+                    = byteBufferPool.getBuffer(
+                            getMaxFrameSizeInSamplesPerChannel()
+                                * outputFrameSize);
+            }
+            catch (LinkageError le)
+            {
+                // FFmpeg, which allocates the native memory, is not
+                // available.
+                logger.warn("Decoding Opus from and into arrays.", le);
+                if (nativeIn != null)
+                {
+                    nativeIn.free();
+                    nativeIn = null;
+                }
+            }
         }
     }
 
+    /**
+     * Gets the number of samples per channel of the longest Opus packet in
+     * the terms of the output <tt>AudioFormat</tt> of this instance.
+     *
+     * @return the number of samples per channel of the longest Opus packet
+     */
+    private int getMaxFrameSizeInSamplesPerChannel()
+    {
+        return outputSampleRate * MAX_FRAME_DURATION / 1000;
+    }
+
     /**
      * {@inheritDoc}
      *
@@ -236,18 +389,10 @@ protected int doProcess(Buffer inBuf, Buffer outBuf)
         {
             inLength = (lostSeqNoCount == 1) ? inLength /* FEC */ : 0 /* PLC */;
 
-            byte[] out
-                = validateByteArraySize(
-                        outBuf,
-                        outOffset
-                            + lastFrameSizeInSamplesPerChannel
-                                * outputFrameSize,
-                        outOffset != 0);
             int frameSizeInSamplesPerChannel
-                = Opus.decode(
-                        decoder,
+                = decode(
                         in, inOffset, inLength,
-                        out, outOffset, lastFrameSizeInSamplesPerChannel,
+                        outBuf, outOffset, lastFrameSizeInSamplesPerChannel,
                         /* decodeFEC */ 1);
 
             if (frameSizeInSamplesPerChannel > 0)
@@ -279,20 +424,12 @@ protected int doProcess(Buffer inBuf, Buffer outBuf)
         }
         else
         {
+            // Decode into space for the longest packet rather than asking the
+            // decoder for the duration of this one first.
             int frameSizeInSamplesPerChannel
-                = Opus.decoder_get_nb_samples(decoder, in, inOffset, inLength);
-            byte[] out
-                = validateByteArraySize(
-                        outBuf,
-                        outOffset
-                            + frameSizeInSamplesPerChannel * outputFrameSize,
-                        outOffset != 0);
-
-            frameSizeInSamplesPerChannel
-                = Opus.decode(
-                        decoder,
+                = decode(
                         in, inOffset, inLength,
-                        out, outOffset, frameSizeInSamplesPerChannel,
+                        outBuf, outOffset, getMaxFrameSizeInSamplesPerChannel(),
                         /* decodeFEC */ 0);
             if (frameSizeInSamplesPerChannel > 0)
             {
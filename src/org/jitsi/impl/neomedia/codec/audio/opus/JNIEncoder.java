@@ -24,6 +24,8 @@
 import net.sf.fmj.media.*;
 
 import org.jitsi.impl.neomedia.codec.*;
+import org.jitsi.impl.neomedia.codec.video.*;
+import org.jitsi.impl.neomedia.jmfext.media.protocol.*;
 import org.jitsi.impl.neomedia.jmfext.media.renderer.audio.*;
 import org.jitsi.service.configuration.*;
 import org.jitsi.service.libjitsi.*;
@@ -49,6 +51,13 @@
      */
     private static final Logger logger = Logger.getLogger(JNIEncoder.class);
 
+    /**
+     * The pool of native memory shared by the <tt>JNIEncoder</tt> instances,
+     * which reduces the allocations of native memory when calls are set up
+     * and torn down.
+     */
+    private static final ByteBufferPool byteBufferPool = new ByteBufferPool();
+
     /**
      * The list of <tt>Format</tt>s of audio data supported as input by
      * <tt>JNIEncoder</tt> instances.
@@ -164,6 +173,19 @@
      */
     private long encoder = 0;
 
+    /**
+     * The native memory from which the native encoder reads the audio frame
+     * to be encoded.
+     */
+    private ByteBuffer nativeIn;
+
+    /**
+     * The native memory into which the native encoder writes the encoded
+     * packet, or <tt>null</tt> if the native encoder works on the arrays of
+     * the <tt>Buffer</tt>s because native memory cannot be allocated.
+     */
+    private ByteBuffer nativeOut;
+
     /**
      * The size in bytes of an audio frame input by this instance. Automatically
      * calculated, based on {@link #frameSizeInMillis} and the
@@ -244,6 +266,17 @@ protected void doClose()
            Opus.encoder_destroy(encoder);
            encoder = 0;
         }
+
+        if (nativeIn != null)
+        {
+            nativeIn.free();
+            nativeIn = null;
+        }
+        if (nativeOut != null)
+        {
+            nativeOut.free();
+            nativeOut = null;
+        }
     }
 
     /**
@@ -269,6 +302,16 @@ protected void doOpen()
         if (encoder == 0)
             throw new ResourceUnavailableException("opus_encoder_create()");
 
+        try
+        {
+            nativeOut = byteBufferPool.getBuffer(Opus.MAX_PACKET);
+        }
+        catch (LinkageError le)
+        {
+            // FFmpeg, which allocates the native memory, is not available.
+            logger.warn("Encoding Opus from and into arrays.", le);
+        }
+
         //Set encoder options according to user configuration
         ConfigurationService cfg = LibJitsi.getConfigurationService();
         String bandwidthStr
@@ -429,13 +472,38 @@ else if (inLength < frameSizeInBytes)
             inBuffer.setOffset(inOffset + frameSizeInBytes);
         }
 
-        // At long last, do the actual encoding.
+        // At long last, do the actual encoding. The native encoder works on
+        // native memory which, unlike arrays, it can access without stalling
+        // the garbage collector.
         byte[] out = validateByteArraySize(outBuffer, Opus.MAX_PACKET, false);
-        int outLength
-            = Opus.encode(
-                    encoder,
-                    in, inOffset, frameSizeInSamplesPerChannel,
-                    out, 0, out.length);
+        int outLength;
+
+        if (nativeOut == null)
+        {
+            outLength
+                = Opus.encode(
+                        encoder,
+                        in, inOffset, frameSizeInSamplesPerChannel,
+                        out, 0, out.length);
+        }
+        else
+        {
+            if ((nativeIn == null)
+                    || (nativeIn.getCapacity() < frameSizeInBytes))
+            {
+                if (nativeIn != null)
+                    nativeIn.free();
+                nativeIn = byteBufferPool.getBuffer(frameSizeInBytes);
+            }
+            FFmpeg.memcpy(nativeIn.getPtr(), in, inOffset, frameSizeInBytes);
+            outLength
+                = Opus.encodeAddress(
+                        encoder,
+                        nativeIn.getPtr(), frameSizeInSamplesPerChannel,
+                        nativeOut.getPtr(), Opus.MAX_PACKET);
+            if (outLength > 0)
+                FFmpeg.memcpy(out, 0, outLength, nativeOut.getPtr());
+        }
 
         if (outLength < 0)  // error from opus_encode
             return BUFFER_PROCESSED_FAILED;
@@ -63,6 +63,12 @@
      */
     public static final int MAX_PACKET = 1+1275;
 
+    /**
+     * Opus constant for an invalid argument, e.g. a buffer which is not
+     * direct or too small
+     */
+    public static final int OPUS_BAD_ARG = -1;
+
     /**
      * Constant used to set various settings to "automatic"
      */
@@ -123,6 +129,63 @@ public static native int decode(
             byte[] output, int outputOffset, int outputFrameSize,
             int decodeFEC);
 
+    /**
+     * Decodes an opus packet from native memory into native memory, e.g. the
+     * memory of <tt>org.jitsi.impl.neomedia.codec.video.ByteBuffer</tt>s.
+     * Unlike the other variants, no bounds are checked.
+     *
+     * @param decoder the <tt>OpusDecoder</tt> state to perform the decoding
+     * @param input the address of the payload to decode. If <tt>0</tt>,
+     * indicates packet loss.
+     * @param inputLength the length in bytes of the payload to be decoded
+     * @param output the address at which the decoded signal is to be output
+     * @param outputFrameSize the number of samples per channel at
+     * <tt>output</tt> of the maximum space available for output of the
+     * decoded signal
+     * @param decodeFEC 0 to decode the packet normally, 1 to decode the FEC
+     * data in the packet
+     * @return the number of decoded samples written at <tt>output</tt>
+     */
+    public static native int decodeAddress(
+            long decoder,
+            long input, int inputLength,
+            long output, int outputFrameSize,
+            int decodeFEC);
+
+    /**
+     * Decodes an opus packet from <tt>input</tt> into <tt>output</tt>. The
+     * buffers are accessed in place, without pinning the memory of the Java
+     * heap, and their positions and limits are ignored.
+     *
+     * @param decoder the <tt>OpusDecoder</tt> state to perform the decoding
+     * @param input a direct <tt>ByteBuffer</tt> which holds the payload to
+     * decode. If <tt>null</tt>, indicates packet loss.
+     * @param inputOffset the offset in <tt>input</tt> at which the payload to
+     * be decoded begins
+     * @param inputLength the length in bytes in <tt>input</tt> beginning at
+     * <tt>inputOffset</tt> of the payload to be decoded
+     * @param output a direct <tt>ByteBuffer</tt> into which the decoded signal
+     * is to be output
+     * @param outputOffset the offset in <tt>output</tt> at which the output of
+     * the decoded signal is to begin
+     * @param outputFrameSize the number of samples per channel <tt>output</tt>
+     * beginning at <tt>outputOffset</tt> of the maximum space available for
+     * output of the decoded signal
+     * @param channels the number of channels of <tt>decoder</tt>, which
+     * <tt>output</tt> is checked to have room for
+     * @param decodeFEC 0 to decode the packet normally, 1 to decode the FEC
+     * data in the packet
+     * @return the number of decoded samples written into <tt>output</tt>
+     * (beginning at <tt>outputOffset</tt>), or {@link #OPUS_BAD_ARG} if a
+     * buffer is not direct or too small
+     */
+    public static native int decodeDirect(
+            long decoder,
+            java.nio.ByteBuffer input, int inputOffset, int inputLength,
+            java.nio.ByteBuffer output, int outputOffset, int outputFrameSize,
+            int channels,
+            int decodeFEC);
+
     /**
      * Creates an OpusDecoder structure, returns a pointer to it or 0 on error.
      *
@@ -183,6 +246,57 @@ public static native int encode(
             byte[] input, int inputOffset, int inputFrameSize,
             byte[] output, int outputOffset, int outputLength);
 
+    /**
+     * Encodes the input from native memory into native memory, e.g. the
+     * memory of <tt>org.jitsi.impl.neomedia.codec.video.ByteBuffer</tt>s.
+     * Unlike the other variants, no bounds are checked.
+     *
+     * @param encoder the <tt>OpusEncoder</tt> state to perform the encoding
+     * @param input the address of 16-bit PCM input signal (interleaved if 2
+     * channels)
+     * @param inputFrameSize the number of samples per channel at
+     * <tt>input</tt>
+     * @param output the address at which the encoded payload is to be output
+     * @param outputLength the number of bytes at <tt>output</tt> available
+     * for the encoded payload
+     * @return the length of the encoded packet in bytes, or a negative error
+     * code
+     */
+    public static native int encodeAddress(
+            long encoder,
+            long input, int inputFrameSize,
+            long output, int outputLength);
+
+    /**
+     * Encodes the input from <tt>input</tt> into <tt>output</tt>. The buffers
+     * are accessed in place, without pinning the memory of the Java heap, and
+     * their positions and limits are ignored.
+     *
+     * @param encoder the <tt>OpusEncoder</tt> state to perform the encoding
+     * @param input a direct <tt>ByteBuffer</tt> which holds 16-bit PCM input
+     * signal (interleaved if 2 channels) in native byte order
+     * @param inputOffset the offset in <tt>input</tt> at which the input
+     * signal begins
+     * @param inputFrameSize the number of samples per channel in
+     * <tt>input</tt> beginning at <tt>inputOffset</tt>
+     * @param channels the number of channels of <tt>encoder</tt>, which
+     * <tt>input</tt> is checked to hold
+     * @param output a direct <tt>ByteBuffer</tt> into which the encoded
+     * payload is to be output
+     * @param outputOffset the offset in <tt>output</tt> at which the encoded
+     * payload is to begin
+     * @param outputLength the number of bytes in <tt>output</tt> beginning at
+     * <tt>outputOffset</tt> available for the encoded payload
+     * @return the length of the encoded packet in bytes, or a negative error
+     * code, e.g. {@link #OPUS_BAD_ARG} if a buffer is not direct or too
+     * small
+     */
+    public static native int encodeDirect(
+            long encoder,
+            java.nio.ByteBuffer input, int inputOffset, int inputFrameSize,
+            int channels,
+            java.nio.ByteBuffer output, int outputOffset, int outputLength);
+
     /**
      * Creates an OpusEncoder structure, returns a pointer to it casted to long.
      * The native function's <tt>application</tt> parameter is always set to
@@ -30,6 +30,19 @@ public class VPX {
      */
     public static final int CODEC_OK = 0;
 
+    /**
+     * Memory operation failed.
+     * Corresponds to <tt>VPX_CODEC_MEM_ERROR</tt> from <tt>vpx/vpx_codec.h</tt>
+     */
+    public static final int CODEC_MEM_ERROR = 2;
+
+    /**
+     * An application-supplied parameter is not valid.
+     * Corresponds to <tt>VPX_CODEC_INVALID_PARAM</tt> from
+     * <tt>vpx/vpx_codec.h</tt>
+     */
+    public static final int CODEC_INVALID_PARAM = 8;
+
     /**
      * An iterator reached the end of list.
      * Corresponds to <tt>VPX_CODEC_LIST_END</tt> from <tt>vpx/vpx_codec.h</tt>
@@ -48,6 +61,25 @@ public class VPX {
      */
     public static final int CODEC_USE_OUTPUT_PARTITION = 0x20000;
 
+    /**
+     * Decoder flag which enables error concealment: macroblocks of corrupt or
+     * missing partitions are concealed instead of failing the whole frame.
+     * Requires libvpx to be configured with <tt>--enable-error-concealment</tt>,
+     * otherwise the initialization fails.
+     * Corresponds to <tt>VPX_CODEC_USE_ERROR_CONCEALMENT</tt> from
+     * <tt>vpx/vpx_decoder.h</tt>
+     */
+    public static final int CODEC_USE_ERROR_CONCEALMENT = 0x20000;
+
+    /**
+     * Decoder flag which makes the decoder accept a frame as several
+     * fragments (the first partition and the token partitions), see
+     * {@link #codec_decode_fragments(long, byte[], int, int[], int, long)}.
+     * Corresponds to <tt>VPX_CODEC_USE_INPUT_FRAGMENTS</tt> from
+     * <tt>vpx/vpx_decoder.h</tt>
+     */
+    public static final int CODEC_USE_INPUT_FRAGMENTS = 0x40000;
+
     /**
      * Improve resiliency against losses of whole frames.
      *
@@ -125,6 +157,100 @@ public class VPX {
      */
     public static final int CODEC_CX_FRAME_PKT = 0;
 
+    /**
+     * Compressed frame flag which indicates a keyframe.
+     * Corresponds to <tt>VPX_FRAME_IS_KEY</tt> from
+     * <tt>vpx/vpx_encoder.h</tt>
+     */
+    public static final int FRAME_IS_KEY = 0x1;
+
+    /**
+     * Compressed frame flag which indicates a frame which no other frame
+     * references.
+     * Corresponds to <tt>VPX_FRAME_IS_DROPPABLE</tt> from
+     * <tt>vpx/vpx_encoder.h</tt>
+     */
+    public static final int FRAME_IS_DROPPABLE = 0x2;
+
+    /**
+     * Frame flag which forces this frame to be a keyframe.
+     * Corresponds to <tt>VPX_EFLAG_FORCE_KF</tt> from
+     * <tt>vpx/vpx_encoder.h</tt>
+     */
+    public static final int EFLAG_FORCE_KF = 1;
+
+    /**
+     * Frame flag which prevents this frame from referencing the last frame.
+     * Corresponds to <tt>VP8_EFLAG_NO_REF_LAST</tt> from <tt>vpx/vp8cx.h</tt>
+     */
+    public static final int EFLAG_NO_REF_LAST = 1 << 16;
+
+    /**
+     * Frame flag which prevents this frame from referencing the golden frame.
+     * Corresponds to <tt>VP8_EFLAG_NO_REF_GF</tt> from <tt>vpx/vp8cx.h</tt>
+     */
+    public static final int EFLAG_NO_REF_GF = 1 << 17;
+
+    /**
+     * Frame flag which prevents this frame from updating the last frame.
+     * Corresponds to <tt>VP8_EFLAG_NO_UPD_LAST</tt> from <tt>vpx/vp8cx.h</tt>
+     */
+    public static final int EFLAG_NO_UPD_LAST = 1 << 18;
+
+    /**
+     * Frame flag which forces this frame to update the golden frame, e.g. to
+     * refresh a long-term reference which loss recovery can fall back on.
+     * Corresponds to <tt>VP8_EFLAG_FORCE_GF</tt> from <tt>vpx/vp8cx.h</tt>
+     */
+    public static final int EFLAG_FORCE_GF = 1 << 19;
+
+    /**
+     * Frame flag which prevents this frame from updating the entropy context.
+     * Corresponds to <tt>VP8_EFLAG_NO_UPD_ENTROPY</tt> from
+     * <tt>vpx/vp8cx.h</tt>
+     */
+    public static final int EFLAG_NO_UPD_ENTROPY = 1 << 20;
+
+    /**
+     * Frame flag which prevents this frame from referencing the alternate
+     * reference frame.
+     * Corresponds to <tt>VP8_EFLAG_NO_REF_ARF</tt> from <tt>vpx/vp8cx.h</tt>
+     */
+    public static final int EFLAG_NO_REF_ARF = 1 << 21;
+
+    /**
+     * Frame flag which prevents this frame from updating the golden frame.
+     * Corresponds to <tt>VP8_EFLAG_NO_UPD_GF</tt> from <tt>vpx/vp8cx.h</tt>
+     */
+    public static final int EFLAG_NO_UPD_GF = 1 << 22;
+
+    /**
+     * Frame flag which prevents this frame from updating the alternate
+     * reference frame.
+     * Corresponds to <tt>VP8_EFLAG_NO_UPD_ARF</tt> from <tt>vpx/vp8cx.h</tt>
+     */
+    public static final int EFLAG_NO_UPD_ARF = 1 << 23;
+
+    /**
+     * Frame flag which forces this frame to update the alternate reference
+     * frame.
+     * Corresponds to <tt>VP8_EFLAG_FORCE_ARF</tt> from <tt>vpx/vp8cx.h</tt>
+     */
+    public static final int EFLAG_FORCE_ARF = 1 << 24;
+
+    /**
+     * The maximum number of temporal layers.
+     * Corresponds to <tt>VPX_TS_MAX_LAYERS</tt> from <tt>vpx/vpx_encoder.h</tt>
+     */
+    public static final int TS_MAX_LAYERS = 5;
+
+    /**
+     * The maximum length of the temporal layer id pattern.
+     * Corresponds to <tt>VPX_TS_MAX_PERIODICITY</tt> from
+     * <tt>vpx/vpx_encoder.h</tt>
+     */
+    public static final int TS_MAX_PERIODICITY = 16;
+
 
     /**
      * Constant for VP8 decoder interface
@@ -136,6 +262,127 @@ public class VPX {
      */
     public static final int INTERFACE_VP8_ENC = 1;
 
+    /**
+     * Constant for VP9 decoder interface
+     */
+    public static final int INTERFACE_VP9_DEC = 2;
+
+    /**
+     * Constant for VP9 encoder interface
+     */
+    public static final int INTERFACE_VP9_ENC = 3;
+
+    /**
+     * The maximum number of layers of a simulcast encoder allocated with
+     * {@link #simulcast_malloc(int)}.
+     */
+    public static final int SIMULCAST_MAX_LAYERS = 4;
+
+    /**
+     * The maximum number of frame buffers of a pool allocated with
+     * {@link #frame_buffer_pool_malloc(int)}.
+     */
+    public static final int FRAME_BUFFER_POOL_MAX_SIZE = 32;
+
+    /**
+     * The maximum number of fragments of a VP8 frame: the first partition and
+     * up to eight token partitions.
+     */
+    public static final int MAX_FRAGMENTS = 9;
+
+    /**
+     * The size in bytes of the header which
+     * {@link #codec_decode_export(long, byte[], int, int, byte[], int, int, long)}
+     * writes in front of each decoded frame. The header consists of three
+     * 32-bit integers in network byte order: the displayed width, the
+     * displayed height and the number of bytes of I420 data which follow.
+     */
+    public static final int DECODE_EXPORT_HEADER_SIZE = 12;
+
+    /**
+     * The number of elements which
+     * {@link #codec_encode_batch(long, long, byte[], int, int, int, long, long, long, long, byte[], int, int, long[])}
+     * and {@link #codec_get_cx_data_batch(long, byte[], int, int, long[])}
+     * write in the packet table for each compressed frame packet: the offset
+     * of the data in the output array, its size in bytes, its
+     * <tt>vpx_codec_frame_flags_t</tt> (e.g. {@link #FRAME_IS_KEY}) and its
+     * presentation timestamp.
+     */
+    public static final int CX_PKT_INFO_LENGTH = 4;
+
+    /**
+     * The maximum length in bytes of a VP8 payload descriptor passed to
+     * {@link #codec_get_cx_data_packetized(long, byte[], int, int, byte[], int, int, long[])}.
+     */
+    public static final int MAX_PAYLOAD_DESCRIPTOR_LENGTH = 6;
+
+    /**
+     * The flag which
+     * {@link #codec_get_cx_data_packetized(long, byte[], int, int, byte[], int, int, long[])}
+     * sets in the packet table for the last RTP payload of a frame, i.e. the
+     * one to send with the RTP marker bit set. It does not collide with the
+     * <tt>vpx_codec_frame_flags_t</tt> values.
+     */
+    public static final int PAYLOAD_END_OF_FRAME = 0x10000;
+
+    /**
+     * The flag which a frame assembler sets for a frame which is a temporal
+     * layer sync point, i.e. has the Y bit set in its payload descriptor.
+     */
+    public static final int FRAME_IS_LAYER_SYNC = 0x20000;
+
+    /**
+     * The number of out-of-order RTP packets a frame assembler allocated with
+     * {@link #frame_assembler_malloc()} can hold, i.e. the range of sequence
+     * numbers within which it reorders packets. It does not limit the size of
+     * the frames.
+     */
+    public static final int FRAME_ASSEMBLER_WINDOW = 128;
+
+    /**
+     * The maximum size of the VP8 payload (excluding the payload descriptor)
+     * of an RTP packet accepted by a frame assembler.
+     */
+    public static final int FRAME_ASSEMBLER_MAX_PAYLOAD_SIZE = 1500;
+
+    /**
+     * The status bit which
+     * {@link #frame_assembler_push(long, byte[], int, int, int, long, boolean, long[])}
+     * sets when the packet completed a frame, which is then available through
+     * {@link #frame_assembler_get_frame(long)}.
+     */
+    public static final int FRAME_ASSEMBLER_FRAME_READY = 0x1;
+
+    /**
+     * The status bit which
+     * {@link #frame_assembler_push(long, byte[], int, int, int, long, boolean, long[])}
+     * sets when the packet was discarded because it is invalid, too large, a
+     * duplicate or older than the last assembled frame.
+     */
+    public static final int FRAME_ASSEMBLER_DISCARDED = 0x2;
+
+    /**
+     * The status bit which
+     * {@link #frame_assembler_push(long, byte[], int, int, int, long, boolean, long[])}
+     * sets when an incomplete frame was dropped, because a subsequent frame
+     * was assembled or because a packet it is missing can no longer be
+     * reordered within {@link #FRAME_ASSEMBLER_WINDOW}, or when the sequence
+     * numbers jumped backwards by more than {@link #FRAME_ASSEMBLER_WINDOW}
+     * and the assembler was reset.
+     */
+    public static final int FRAME_ASSEMBLER_FRAME_DROPPED = 0x4;
+
+    /**
+     * The number of elements which
+     * {@link #frame_assembler_push(long, byte[], int, int, int, long, boolean, long[])}
+     * writes in its <tt>info</tt> argument for an assembled frame: the size
+     * of the frame in bytes, its RTP timestamp, the RTP sequence number of
+     * its last packet, its temporal layer index (TID) or -1, and its flags
+     * ({@link #FRAME_IS_KEY}, {@link #FRAME_IS_DROPPABLE} and
+     * {@link #FRAME_IS_LAYER_SYNC}).
+     */
+    public static final int ASSEMBLED_FRAME_INFO_LENGTH = 5;
+
     /**
      * Allocates memory for a <tt>vpx_codec_ctx_t</tt> on the heap.
      *
@@ -183,6 +430,33 @@ public static native int codec_decode(long context,
                                           long user_priv,
                                           long deadline);
 
+    /**
+     * Decodes the frame in the direct <tt>java.nio.ByteBuffer</tt>
+     * <tt>buf</tt>, at offset <tt>buf_offset</tt>. Unlike
+     * {@link #codec_decode(long, byte[], int, int, long, long)} the native
+     * decoder reads the frame in place and the memory of <tt>buf</tt> is
+     * neither copied nor pinned.
+     *
+     * @param context The context to use.
+     * @param buf A direct <tt>java.nio.ByteBuffer</tt> containing the encoded
+     * frame. The position and limit of <tt>buf</tt> are ignored.
+     * @param buf_offset Offset into <tt>buf</tt> where the encoded frame begins.
+     * @param buf_size Size of the encoded frame.
+     * @param user_priv Application specific data to associate with this frame.
+     * @param deadline Soft deadline the decoder should attempt to meet,
+     * in microseconds. Set to zero for unlimited.
+     *
+     * @return <tt>CODEC_OK</tt> on success, or an error code otherwise. The
+     * error code can be converted to a <tt>String</tt> with
+     * {@link VPX#codec_err_to_string(int)}
+     */
+    public static native int codec_decode(long context,
+                                          java.nio.ByteBuffer buf,
+                                          int buf_offset,
+                                          int buf_size,
+                                          long user_priv,
+                                          long deadline);
+
     /**
      * Gets the next frame available to display from the decoder context
      * <tt>context</tt>.
@@ -200,6 +474,90 @@ public static native int codec_decode(long context,
     public static native long codec_get_frame(long context,
                                               long[] iter);
 
+    /**
+     * Decodes the frame in <tt>buf</tt> and exports all frames which the
+     * decoder made available into <tt>out</tt>, in a single call. This is
+     * equivalent to calling <tt>codec_decode</tt>, then draining
+     * <tt>codec_get_frame</tt> and copying the planes of each image, but
+     * crosses the JNI boundary only once.
+     *
+     * Each exported frame is written as a header of
+     * {@link #DECODE_EXPORT_HEADER_SIZE} bytes (see there), followed by the
+     * Y, U and V planes of the frame in I420 layout without any row padding.
+     * Frames are written back to back, starting at <tt>out_offset</tt>.
+     *
+     * @param context The decoder context to use.
+     * @param buf Encoded frame buffer.
+     * @param buf_offset Offset into <tt>buf</tt> where the encoded frame begins.
+     * @param buf_size Size of the encoded frame.
+     * @param out The buffer into which to write the decoded frames.
+     * @param out_offset Offset into <tt>out</tt> at which to start writing.
+     * @param out_size The number of bytes available in <tt>out</tt>, starting
+     * at <tt>out_offset</tt>.
+     * @param deadline Soft deadline the decoder should attempt to meet,
+     * in microseconds. Set to zero for unlimited.
+     *
+     * @return The number of bytes written to <tt>out</tt> (<tt>0</tt> if the
+     * decoder produced no frame), or a negated error code on failure. In
+     * particular, <tt>-CODEC_MEM_ERROR</tt> is returned if <tt>out</tt> is too
+     * small to hold all decoded frames, and <tt>-CODEC_INVALID_PARAM</tt> if
+     * the given ranges do not lie within <tt>buf</tt> and <tt>out</tt>.
+     */
+    public static native int codec_decode_export(long context,
+                                                 byte[] buf,
+                                                 int buf_offset,
+                                                 int buf_size,
+                                                 byte[] out,
+                                                 int out_offset,
+                                                 int out_size,
+                                                 long deadline);
+
+    /**
+     * Decodes a frame which is given as consecutive fragments of
+     * <tt>buf</tt>, on a decoder context initialized with
+     * {@link #CODEC_USE_INPUT_FRAGMENTS}. Each fragment is either the whole
+     * frame, or the first partition followed by the token partitions, one per
+     * fragment. Missing trailing partitions are concealed if the context was
+     * initialized with {@link #CODEC_USE_ERROR_CONCEALMENT}.
+     *
+     * @param context Pointer to the <tt>vpx_codec_ctx_t</tt> context to use.
+     * @param buf Input buffer
+     * @param buf_offset Offset into <tt>buf</tt> where the first fragment
+     * begins
+     * @param fragmentSizes The sizes of the fragments.
+     * @param fragmentCount The number of fragments, at most
+     * {@link #MAX_FRAGMENTS}.
+     * @param deadline Soft deadline the decoder should attempt to meet,
+     * in microseconds. Set to 0 for unlimited.
+     *
+     * @return <tt>CODEC_OK</tt> on success, or an error code otherwise. The
+     * error code can be converted to a <tt>String</tt> with
+     * {@link VPX#codec_err_to_string(int)}
+     */
+    public static native int codec_decode_fragments(long context,
+                                                    byte[] buf,
+                                                    int buf_offset,
+                                                    int[] fragmentSizes,
+                                                    int fragmentCount,
+                                                    long deadline);
+
+    /**
+     * Signals the end of a frame to a decoder context initialized with
+     * {@link #CODEC_USE_INPUT_FRAGMENTS}, which decodes the fragments passed
+     * to <tt>codec_decode</tt> since the previous end of frame. The memory of
+     * these fragments must still be valid, e.g. a direct
+     * <tt>java.nio.ByteBuffer</tt>.
+     *
+     * @param context Pointer to the <tt>vpx_codec_ctx_t</tt> context to use.
+     * @param deadline Soft deadline the decoder should attempt to meet,
+     * in microseconds. Set to 0 for unlimited.
+     *
+     * @return <tt>CODEC_OK</tt> on success, or an error code otherwise. The
+     * error code can be converted to a <tt>String</tt> with
+     * {@link VPX#codec_err_to_string(int)}
+     */
+    public static native int codec_decode_flush(long context, long deadline);
+
     /**
      * Destroys a codec context, freeing any associated memory buffers.
      *
@@ -231,9 +589,12 @@ public static native int codec_enc_init(long context,
                                             long flags);
 
     /**
+     * Applies a new configuration to an initialized encoder context without
+     * re-initializing it. Some changes, e.g. increasing the width or the
+     * height beyond their initial values, are not supported and fail.
      *
      * @param context Pointer to the codec context on which to set the
-     * confirutation
+     * configuration
      * @param cfg Pointer to a <tt>vpx_codec_enc_cfg_t</tt> to set.
      *
      * @return <tt>CODEC_OK</tt> on success, or an error code otherwise. The
@@ -299,6 +660,125 @@ public static native int codec_encode(long context,
     public static native long codec_get_cx_data(long context,
                                                 long[] iter);
 
+    /**
+     * Encodes a frame like
+     * {@link #codec_encode(long, long, byte[], int, int, int, long, long, long, long)}
+     * and copies all compressed frame packets which the encoder produced into
+     * <tt>out</tt>, in a single call. This replaces the per-packet
+     * <tt>codec_get_cx_data</tt>/<tt>codec_cx_pkt_get_*</tt>/<tt>memcpy</tt>
+     * loop.
+     *
+     * The packets are written back to back starting at <tt>outOffset</tt> and
+     * are described in <tt>info</tt>, {@link #CX_PKT_INFO_LENGTH} elements per
+     * packet. If they do not all fit in <tt>out</tt> or <tt>info</tt>, nothing
+     * is written, <tt>-CODEC_MEM_ERROR</tt> is returned and the packets can
+     * be retrieved with
+     * {@link #codec_get_cx_data_batch(long, byte[], int, int, long[])} (or
+     * <tt>codec_get_cx_data</tt>) until the next frame is encoded.
+     *
+     * @param context Pointer to the <tt>vpx_codec_ctx_t</tt>.
+     * @param img Pointer to a <tt>vpx_image_t</tt> describing the raw frame.
+     * @param buf Contains the raw frame.
+     * @param offset0 Offset of the plane 0 (Y) in <tt>buf</tt>.
+     * @param offset1 Offset of the plane 1 (U) in <tt>buf</tt>.
+     * @param offset2 Offset of the plane 2 (V) in <tt>buf</tt>.
+     * @param pts Presentation time stamp, in timebase units.
+     * @param duration Duration to show frame, in timebase units.
+     * @param flags Flags to use for encoding this frame.
+     * @param deadline Time to spend encoding, in microseconds.
+     * @param out The array to write the compressed data into.
+     * @param outOffset The offset in <tt>out</tt> at which to start writing.
+     * @param outSize The number of bytes available in <tt>out</tt> starting
+     * at <tt>outOffset</tt>.
+     * @param info The packet table.
+     *
+     * @return the number of packets written, or a negated libvpx error code.
+     */
+    public static native int codec_encode_batch(long context,
+                                                long img,
+                                                byte[] buf,
+                                                int offset0,
+                                                int offset1,
+                                                int offset2,
+                                                long pts,
+                                                long duration,
+                                                long flags,
+                                                long deadline,
+                                                byte[] out,
+                                                int outOffset,
+                                                int outSize,
+                                                long[] info);
+
+    /**
+     * Copies all compressed frame packets which the last call to
+     * <tt>codec_encode</tt> or <tt>codec_encode_batch</tt> produced into
+     * <tt>out</tt>, in a single call. See
+     * {@link #codec_encode_batch(long, long, byte[], int, int, int, long, long, long, long, byte[], int, int, long[])}
+     * for the layout of <tt>out</tt> and <tt>info</tt>.
+     *
+     * @param context Pointer to the <tt>vpx_codec_ctx_t</tt>.
+     * @param out The array to write the compressed data into.
+     * @param outOffset The offset in <tt>out</tt> at which to start writing.
+     * @param outSize The number of bytes available in <tt>out</tt> starting
+     * at <tt>outOffset</tt>.
+     * @param info The packet table.
+     *
+     * @return the number of packets written, or a negated libvpx error code.
+     */
+    public static native int codec_get_cx_data_batch(long context,
+                                                     byte[] out,
+                                                     int outOffset,
+                                                     int outSize,
+                                                     long[] info);
+
+    /**
+     * Packetizes all compressed frame packets which the last call to
+     * <tt>codec_encode</tt> or <tt>codec_encode_batch</tt> produced into VP8
+     * RTP payloads, copying the compressed data out of libvpx exactly once.
+     *
+     * Each compressed frame packet is split into payloads of at most
+     * <tt>maxPayloadSize</tt> bytes of compressed data, each one preceded by
+     * a copy of the payload descriptor <tt>pd</tt> in which the S bit and
+     * the PartID are set: the S bit for the first payload of each packet and
+     * the PartID to the index of the partition when the encoder outputs
+     * partitions (<tt>CODEC_USE_OUTPUT_PARTITION</tt>). A 15-bit PictureID in
+     * <tt>pd</tt> is that of the first frame and is incremented for each
+     * subsequent frame. The other extension fields of <tt>pd</tt> (a 7-bit
+     * PictureID, TL0PICIDX, TID) are copied as they are.
+     *
+     * The payloads are written back to back starting at <tt>outOffset</tt>
+     * and are described in <tt>info</tt>, {@link #CX_PKT_INFO_LENGTH}
+     * elements per payload, as in
+     * {@link #codec_get_cx_data_batch(long, byte[], int, int, long[])}. The
+     * size includes the payload descriptor and the last payload of each frame
+     * has {@link #PAYLOAD_END_OF_FRAME} set in its flags. If the payloads do
+     * not all fit in <tt>out</tt> or <tt>info</tt>, nothing is written and
+     * <tt>-CODEC_MEM_ERROR</tt> is returned, and the call can be repeated
+     * with larger arrays until the next frame is encoded.
+     *
+     * @param context Pointer to the <tt>vpx_codec_ctx_t</tt>.
+     * @param pd The payload descriptor to use as a template.
+     * @param pdLength The length of the payload descriptor, at most
+     * {@link #MAX_PAYLOAD_DESCRIPTOR_LENGTH}.
+     * @param maxPayloadSize The maximum number of bytes of compressed data in
+     * a payload.
+     * @param out The array to write the payloads into.
+     * @param outOffset The offset in <tt>out</tt> at which to start writing.
+     * @param outSize The number of bytes available in <tt>out</tt> starting
+     * at <tt>outOffset</tt>.
+     * @param info The payload table.
+     *
+     * @return the number of payloads written, or a negated libvpx error code.
+     */
+    public static native int codec_get_cx_data_packetized(long context,
+                                                          byte[] pd,
+                                                          int pdLength,
+                                                          int maxPayloadSize,
+                                                          byte[] out,
+                                                          int outOffset,
+                                                          int outSize,
+                                                          long[] info);
+
     /**
      * Returns the <tt>kind</tt> of the <tt>vpx_codec_cx_pkt_t</tt> pointed to
      * by <tt>pkt</tt>.
@@ -539,6 +1019,42 @@ public static native void img_wrap(long img,
                                        int align,
                                        long data);
 
+    /**
+     * Allocates a <tt>vpx_image_t</tt> along with the storage for an image of
+     * the given format and size. Free with {@link #img_free(long)}.
+     *
+     * @param fmt Format of the image.
+     * @param d_w Width of the image.
+     * @param d_h Height of the image.
+     * @param align Alignment, in bytes, of each row in the image.
+     * @return A pointer to the allocated <tt>vpx_image_t</tt>, or 0 if the
+     * allocation failed.
+     */
+    public static native long img_alloc(int fmt, int d_w, int d_h, int align);
+
+    /**
+     * Frees a <tt>vpx_image_t</tt> allocated with
+     * {@link #img_alloc(int, int, int, int)}.
+     *
+     * @param img Pointer to a <tt>vpx_image_t</tt>.
+     */
+    public static native void img_free(long img);
+
+    /**
+     * Downscales an I420 image into another, by averaging the area of the
+     * source image which each destination pixel covers. Cheaper than
+     * converting the full size image to the output size later on, e.g. for
+     * small thumbnails of a decoded stream.
+     *
+     * @param src Pointer to the source <tt>vpx_image_t</tt>.
+     * @param dst Pointer to the destination <tt>vpx_image_t</tt>, the display
+     * size of which (<tt>d_w</tt> and <tt>d_h</tt>) is the size to scale to.
+     * It must not be larger than that of <tt>src</tt>.
+     * @return <tt>0</tt> on success, or {@link #CODEC_INVALID_PARAM} negated if the
+     * images are not I420 or <tt>dst</tt> is larger than <tt>src</tt>.
+     */
+    public static native int img_scale(long src, long dst);
+
     /**
      * Allocates memory for a <tt>vpx_codec_dec_cfg_t</tt> on the heap.
      *
@@ -562,6 +1078,231 @@ public static native void img_wrap(long img,
      */
     public static native void codec_dec_cfg_set_h(long cfg, int value);
 
+    /**
+     * Sets the <tt>threads</tt> field of a <tt>vpx_codec_dec_cfg_t</tt>.
+     *
+     * @param cfg Pointer to a <tt>vpx_codec_dec_cfg_t</tt>.
+     * @param value The value to set.
+     */
+    public static native void codec_dec_cfg_set_threads(long cfg, int value);
+
+    /**
+     * Enables or disables row-based multi-threaded decoding on a VP9 decoder
+     * context (<tt>VP9D_SET_ROW_MT</tt>).
+     *
+     * @param context Pointer to an initialized VP9 decoder context.
+     * @param value <tt>1</tt> to enable row-based multi-threading, <tt>0</tt>
+     * to disable it.
+     *
+     * @return <tt>CODEC_OK</tt> on success, or an error code otherwise. The
+     * error code can be converted to a <tt>String</tt> with
+     * {@link VPX#codec_err_to_string(int)}
+     */
+    public static native int codec_dec_set_row_mt(long context, int value);
+
+    /**
+     * Checks whether the last frame decoded by a VP8 decoder context was
+     * corrupt, e.g. because parts of it were concealed
+     * (<tt>VP8D_GET_FRAME_CORRUPTED</tt>).
+     *
+     * @param context Pointer to an initialized decoder context.
+     *
+     * @return <tt>1</tt> if the last frame was corrupt, <tt>0</tt> if it was
+     * not, or a negated libvpx error code.
+     */
+    public static native int codec_dec_get_frame_corrupted(long context);
+
+    /**
+     * Allocates a pool of frame buffers which a decoder context can decode
+     * into (see {@link #codec_set_frame_buffer_pool(long, long)}). The memory
+     * of the buffers is allocated on demand.
+     *
+     * @param size The number of frame buffers, at most
+     * {@link #FRAME_BUFFER_POOL_MAX_SIZE}. It has to cover the reference
+     * frames of the decoder (8 for VP9), the frames being decoded and the
+     * frames held by the application.
+     *
+     * @return A pointer to the pool, or 0 on failure.
+     */
+    public static native long frame_buffer_pool_malloc(int size);
+
+    /**
+     * Releases a pool allocated with {@link #frame_buffer_pool_malloc(int)}.
+     * The decoder context using it must have been destroyed. The memory is
+     * freed once all frame buffers referenced by the application have been
+     * released with {@link #frame_buffer_release(long)}.
+     *
+     * @param pool Pointer to the pool.
+     */
+    public static native void frame_buffer_pool_free(long pool);
+
+    /**
+     * Makes an initialized decoder context allocate the frames it decodes
+     * from a pool allocated with {@link #frame_buffer_pool_malloc(int)}
+     * (<tt>vpx_codec_set_frame_buffer_functions</tt>). Has to be called before
+     * the first frame is decoded. Only the VP9 decoder supports external frame
+     * buffers, the VP8 decoder fails with <tt>VPX_CODEC_INCAPABLE</tt>.
+     *
+     * @param context Pointer to an initialized decoder context.
+     * @param pool Pointer to the pool.
+     *
+     * @return <tt>CODEC_OK</tt> on success, or an error code otherwise. The
+     * error code can be converted to a <tt>String</tt> with
+     * {@link VPX#codec_err_to_string(int)}
+     */
+    public static native int codec_set_frame_buffer_pool(long context,
+                                                         long pool);
+
+    /**
+     * Takes a reference to the pooled frame buffer holding a decoded image
+     * returned by {@link #codec_get_frame(long, long[])}. The frame can then
+     * be read in place, even after the next frame is decoded, until the
+     * reference is given back with {@link #frame_buffer_release(long)}.
+     *
+     * @param pool Pointer to the pool set on the decoder with
+     * {@link #codec_set_frame_buffer_pool(long, long)}.
+     * @param img Pointer to a <tt>vpx_image_t</tt> returned by the decoder.
+     *
+     * @return A handle to the frame buffer, or 0 if the image was not
+     * allocated from <tt>pool</tt>, e.g. if the decoder uses its internal
+     * buffers.
+     */
+    public static native long img_ref_frame_buffer(long pool, long img);
+
+    /**
+     * Takes an additional reference to a frame buffer.
+     *
+     * @param fb A handle returned by {@link #img_ref_frame_buffer(long, long)}.
+     */
+    public static native void frame_buffer_ref(long fb);
+
+    /**
+     * Gives back a reference to a frame buffer taken with
+     * {@link #img_ref_frame_buffer(long, long)} or
+     * {@link #frame_buffer_ref(long)}.
+     * The buffer is reused once neither the application nor the decoder
+     * references it.
+     *
+     * @param fb A handle to the frame buffer.
+     */
+    public static native void frame_buffer_release(long fb);
+
+    /**
+     * Returns the displayed width of the frame held by a frame buffer.
+     *
+     * @param fb A handle to the frame buffer.
+     * @return The displayed width of the frame held by <tt>fb</tt>.
+     */
+    public static native int frame_buffer_get_w(long fb);
+
+    /**
+     * Returns the displayed height of the frame held by a frame buffer.
+     *
+     * @param fb A handle to the frame buffer.
+     * @return The displayed height of the frame held by <tt>fb</tt>.
+     */
+    public static native int frame_buffer_get_h(long fb);
+
+    /**
+     * Returns the stride of a plane of the frame held by a frame buffer.
+     *
+     * @param fb A handle to the frame buffer.
+     * @param plane The plane: 0 (Y), 1 (U) or 2 (V).
+     * @return The stride of the plane in bytes.
+     */
+    public static native int frame_buffer_get_stride(long fb, int plane);
+
+    /**
+     * Returns a direct <tt>java.nio.ByteBuffer</tt> over a plane of the frame
+     * held by a frame buffer, without copying it. The buffer must not be
+     * accessed after the reference to the frame buffer has been released.
+     *
+     * @param fb A handle to the frame buffer.
+     * @param plane The plane: 0 (Y), 1 (U) or 2 (V).
+     * @return A direct <tt>java.nio.ByteBuffer</tt> over the plane, including
+     * the padding at the end of each row, or <tt>null</tt>.
+     */
+    public static native java.nio.ByteBuffer frame_buffer_get_plane(
+            long fb,
+            int plane);
+
+    /**
+     * Allocates a native VP8 frame assembler, which reassembles VP8 frames
+     * from RTP payloads in native memory, so that they can be passed to
+     * {@link #codec_decode(long, java.nio.ByteBuffer, int, int, long, long)}
+     * without being copied into Java memory. Free with
+     * {@link #frame_assembler_free(long)}.
+     *
+     * @return A handle to the frame assembler, or 0 if the allocation failed.
+     */
+    public static native long frame_assembler_malloc();
+
+    /**
+     * Frees a frame assembler allocated with
+     * {@link #frame_assembler_malloc()}.
+     *
+     * @param assembler A handle to the frame assembler.
+     */
+    public static native void frame_assembler_free(long assembler);
+
+    /**
+     * Drops all packets held by a frame assembler and forgets the last
+     * assembled frame, e.g. after the RTP stream has been restarted.
+     *
+     * @param assembler A handle to the frame assembler.
+     */
+    public static native void frame_assembler_reset(long assembler);
+
+    /**
+     * Adds an RTP payload (starting with the VP8 payload descriptor) to a
+     * frame assembler. The payload descriptor is parsed and the VP8 payload
+     * of a packet which continues the frame in order is copied straight after
+     * the preceding packets, so that the frame is contiguous in native memory
+     * once the packet with the marker bit has been added. A packet received
+     * out of order is held until the packets preceding it in its frame have
+     * been received within {@link #FRAME_ASSEMBLER_WINDOW} sequence numbers,
+     * and is then copied into its frame. The size of a frame is not limited.
+     * A packet more than {@link #FRAME_ASSEMBLER_WINDOW} sequence numbers
+     * behind the last assembled frame is taken as a restart of the sequence
+     * numbers (it may e.g. be ahead by more than half of the sequence number
+     * space) and the assembler is reset instead of discarding it.
+     *
+     * @param assembler A handle to the frame assembler.
+     * @param buf The array holding the RTP payload.
+     * @param bufOffset The offset of the RTP payload in <tt>buf</tt>.
+     * @param bufSize The size of the RTP payload.
+     * @param seq The RTP sequence number of the packet.
+     * @param timestamp The RTP timestamp of the packet.
+     * @param marker Whether the RTP marker bit of the packet is set.
+     * @param info An array of at least {@link #ASSEMBLED_FRAME_INFO_LENGTH}
+     * elements which receives the description of the assembled frame.
+     * @return A combination of {@link #FRAME_ASSEMBLER_FRAME_READY},
+     * {@link #FRAME_ASSEMBLER_DISCARDED} and
+     * {@link #FRAME_ASSEMBLER_FRAME_DROPPED}, or a negated libvpx error code.
+     */
+    public static native int frame_assembler_push(long assembler,
+                                                  byte[] buf,
+                                                  int bufOffset,
+                                                  int bufSize,
+                                                  int seq,
+                                                  long timestamp,
+                                                  boolean marker,
+                                                  long[] info);
+
+    /**
+     * Returns a direct <tt>java.nio.ByteBuffer</tt> over the last frame
+     * assembled by a frame assembler, without copying it. The native memory
+     * of the buffer may be overwritten or reallocated by the next call to
+     * {@link #frame_assembler_push(long, byte[], int, int, int, long, boolean, long[])},
+     * so the buffer must not be accessed after it.
+     *
+     * @param assembler A handle to the frame assembler.
+     * @return A direct <tt>java.nio.ByteBuffer</tt> over the last assembled
+     * frame, or <tt>null</tt> if no frame has been assembled.
+     */
+    public static native java.nio.ByteBuffer frame_assembler_get_frame(
+            long assembler);
+
     /**
      * Allocates memory for a <tt>vpx_codec_enc_cfg_t</tt> on the heap.
      *
@@ -621,6 +1362,20 @@ public static native void codec_enc_cfg_set_w(long cfg,
     public static native void codec_enc_cfg_set_h(long cfg,
                                                   int value);
 
+    /**
+     * Sets the <tt>g_timebase</tt> field of a <tt>vpx_codec_enc_cfg_t</tt>,
+     * i.e. the unit in which the presentation timestamps and durations passed
+     * to {@link #codec_encode(long, long, byte[], int, int, int, long, long, long, long)}
+     * are expressed.
+     *
+     * @param cfg Pointer to a <tt>vpx_codec_enc_cfg_t</tt>.
+     * @param num The numerator of the time base.
+     * @param den The denominator of the time base.
+     */
+    public static native void codec_enc_cfg_set_timebase(long cfg,
+                                                         int num,
+                                                         int den);
+
     /**
      * Sets the <tt>g_error_resilient</tt> field of a
      * <tt>vpx_codec_enc_cfg_t</tt>.
@@ -783,6 +1538,375 @@ public static native void codec_enc_cfg_set_kf_min_dist(long cfg,
     public static native void codec_enc_cfg_set_kf_max_dist(long cfg,
                                                             int value);
 
+    /**
+     * Sets the <tt>ts_number_layers</tt> (number of temporal layers) field of
+     * a <tt>vpx_codec_enc_cfg_t</tt>.
+     *
+     * @param cfg Pointer to a <tt>vpx_codec_enc_cfg_t</tt>.
+     * @param value The value to set.
+     */
+    public static native void codec_enc_cfg_set_ts_number_layers(long cfg,
+                                                                 int value);
+
+    /**
+     * Sets the <tt>ts_periodicity</tt> (length of the temporal layer id
+     * pattern) field of a <tt>vpx_codec_enc_cfg_t</tt>.
+     *
+     * @param cfg Pointer to a <tt>vpx_codec_enc_cfg_t</tt>.
+     * @param value The value to set.
+     */
+    public static native void codec_enc_cfg_set_ts_periodicity(long cfg,
+                                                               int value);
+
+    /**
+     * Sets the <tt>ts_target_bitrate</tt> field of a
+     * <tt>vpx_codec_enc_cfg_t</tt>. Element <tt>i</tt> is the cumulative
+     * target bitrate in kbps of temporal layers <tt>0</tt> to <tt>i</tt>.
+     *
+     * @param cfg Pointer to a <tt>vpx_codec_enc_cfg_t</tt>.
+     * @param values The values to set, at most {@link #TS_MAX_LAYERS}.
+     */
+    public static native void codec_enc_cfg_set_ts_target_bitrate(
+            long cfg,
+            int[] values);
+
+    /**
+     * Sets the <tt>ts_rate_decimator</tt> field of a
+     * <tt>vpx_codec_enc_cfg_t</tt>. Element <tt>i</tt> is the factor by
+     * which the frame rate of temporal layers <tt>0</tt> to <tt>i</tt> is
+     * lower than the input frame rate.
+     *
+     * @param cfg Pointer to a <tt>vpx_codec_enc_cfg_t</tt>.
+     * @param values The values to set, at most {@link #TS_MAX_LAYERS}.
+     */
+    public static native void codec_enc_cfg_set_ts_rate_decimator(
+            long cfg,
+            int[] values);
+
+    /**
+     * Sets the <tt>ts_layer_id</tt> field of a <tt>vpx_codec_enc_cfg_t</tt>,
+     * i.e. the temporal layer id of each frame of the pattern.
+     *
+     * @param cfg Pointer to a <tt>vpx_codec_enc_cfg_t</tt>.
+     * @param values The values to set, at most {@link #TS_MAX_PERIODICITY}.
+     */
+    public static native void codec_enc_cfg_set_ts_layer_id(long cfg,
+                                                            int[] values);
+
+    /**
+     * Sets the temporal layer of the next frame to be encoded
+     * (<tt>VP8E_SET_TEMPORAL_LAYER_ID</tt>).
+     *
+     * @param context Pointer to an initialized encoder context.
+     * @param value The temporal layer id.
+     *
+     * @return <tt>CODEC_OK</tt> on success, or an error code otherwise. The
+     * error code can be converted to a <tt>String</tt> with
+     * {@link VPX#codec_err_to_string(int)}
+     */
+    public static native int codec_enc_set_temporal_layer_id(long context,
+                                                             int value);
+
+    /**
+     * Sets the speed/quality trade-off of a VP8 encoder context
+     * (<tt>VP8E_SET_CPUUSED</tt>). In realtime mode a negative value
+     * <tt>-n</tt> selects a fixed speed <tt>n</tt> (higher is faster), while a
+     * non-negative value lets libvpx pick the speed itself.
+     *
+     * @param context Pointer to an initialized encoder context.
+     * @param value The value to set, between <tt>-16</tt> and <tt>16</tt>.
+     *
+     * @return <tt>CODEC_OK</tt> on success, or an error code otherwise. The
+     * error code can be converted to a <tt>String</tt> with
+     * {@link VPX#codec_err_to_string(int)}
+     */
+    public static native int codec_enc_set_cpu_used(long context, int value);
+
+    /**
+     * Sets the strength of the temporal noise reduction of a VP8 encoder
+     * context (<tt>VP8E_SET_NOISE_SENSITIVITY</tt>).
+     *
+     * @param context Pointer to an initialized encoder context.
+     * @param value The value to set, <tt>0</tt> (off) to <tt>6</tt>.
+     *
+     * @return <tt>CODEC_OK</tt> on success, or an error code otherwise. The
+     * error code can be converted to a <tt>String</tt> with
+     * {@link VPX#codec_err_to_string(int)}
+     */
+    public static native int codec_enc_set_noise_sensitivity(long context,
+                                                             int value);
+
+    /**
+     * Sets the screen content mode of a VP8 encoder context
+     * (<tt>VP8E_SET_SCREEN_CONTENT_MODE</tt>).
+     *
+     * @param context Pointer to an initialized encoder context.
+     * @param value <tt>0</tt> for camera content, <tt>1</tt> for screen
+     * content, <tt>2</tt> for screen content with more aggressive rate
+     * control.
+     *
+     * @return <tt>CODEC_OK</tt> on success, or an error code otherwise. The
+     * error code can be converted to a <tt>String</tt> with
+     * {@link VPX#codec_err_to_string(int)}
+     */
+    public static native int codec_enc_set_screen_content_mode(long context,
+                                                               int value);
+
+    /**
+     * Sets the threshold below which macroblocks are considered static and
+     * are skipped by a VP8 encoder context
+     * (<tt>VP8E_SET_STATIC_THRESHOLD</tt>).
+     *
+     * @param context Pointer to an initialized encoder context.
+     * @param value The value to set.
+     *
+     * @return <tt>CODEC_OK</tt> on success, or an error code otherwise. The
+     * error code can be converted to a <tt>String</tt> with
+     * {@link VPX#codec_err_to_string(int)}
+     */
+    public static native int codec_enc_set_static_threshold(long context,
+                                                            int value);
+
+    /**
+     * Sets the number of DCT token partitions of a VP8 encoder context
+     * (<tt>VP8E_SET_TOKEN_PARTITIONS</tt>).
+     *
+     * @param context Pointer to an initialized encoder context.
+     * @param value The base 2 logarithm of the number of partitions,
+     * <tt>0</tt> to <tt>3</tt>.
+     *
+     * @return <tt>CODEC_OK</tt> on success, or an error code otherwise. The
+     * error code can be converted to a <tt>String</tt> with
+     * {@link VPX#codec_err_to_string(int)}
+     */
+    public static native int codec_enc_set_token_partitions(long context,
+                                                            int value);
+
+    /**
+     * Gets the quantizer used for the last frame encoded by a VP8 encoder
+     * context (<tt>VP8E_GET_LAST_QUANTIZER</tt>).
+     *
+     * @param context Pointer to an initialized encoder context.
+     *
+     * @return the quantizer (<tt>0</tt> to <tt>127</tt>) used for the last
+     * encoded frame, or a negated libvpx error code.
+     */
+    public static native int codec_enc_get_last_quantizer(long context);
+
+    /**
+     * Sets the active map of a VP8 encoder context
+     * (<tt>VP8E_SET_ACTIVEMAP</tt>). The macroblocks which are not active in
+     * the map are skipped (coded as unchanged) in the following inter frames,
+     * until the map is changed again.
+     *
+     * @param context Pointer to an initialized encoder context.
+     * @param map One byte per 16x16 macroblock, in raster order, non-zero for
+     * the active macroblocks, or <tt>null</tt> to make all macroblocks active
+     * again.
+     * @param rows The number of macroblock rows of the frame. libvpx rejects
+     * the map, including a <tt>null</tt> one, unless <tt>rows</tt> and
+     * <tt>cols</tt> match the frame size the encoder is configured with.
+     * @param cols The number of macroblock columns of the frame.
+     *
+     * @return <tt>CODEC_OK</tt> on success, or an error code otherwise. The
+     * error code can be converted to a <tt>String</tt> with
+     * {@link VPX#codec_err_to_string(int)}
+     */
+    public static native int codec_enc_set_active_map(long context,
+                                                      byte[] map,
+                                                      int rows,
+                                                      int cols);
+
+    /**
+     * Enables or disables row-based multi-threaded encoding on a VP9 encoder
+     * context (<tt>VP9E_SET_ROW_MT</tt>).
+     *
+     * @param context Pointer to an initialized VP9 encoder context.
+     * @param value <tt>1</tt> to enable row-based multi-threading, <tt>0</tt>
+     * to disable it.
+     *
+     * @return <tt>CODEC_OK</tt> on success, or an error code otherwise. The
+     * error code can be converted to a <tt>String</tt> with
+     * {@link VPX#codec_err_to_string(int)}
+     */
+    public static native int codec_enc_set_row_mt(long context, int value);
+
+    /**
+     * Sets the number of tile columns of a VP9 encoder context
+     * (<tt>VP9E_SET_TILE_COLUMNS</tt>). Tile columns can be encoded and
+     * decoded in parallel.
+     *
+     * @param context Pointer to an initialized VP9 encoder context.
+     * @param value The base 2 logarithm of the number of tile columns. The
+     * encoder caps it according to the frame width.
+     *
+     * @return <tt>CODEC_OK</tt> on success, or an error code otherwise. The
+     * error code can be converted to a <tt>String</tt> with
+     * {@link VPX#codec_err_to_string(int)}
+     */
+    public static native int codec_enc_set_tile_columns(long context,
+                                                         int value);
+
+    /**
+     * Enables or disables frame parallel decoding mode on a VP9 encoder
+     * context (<tt>VP9E_SET_FRAME_PARALLEL_DECODING</tt>). When enabled, the
+     * encoder does not use backward context updates, so that a decoder can
+     * decode consecutive frames in parallel.
+     *
+     * @param context Pointer to an initialized VP9 encoder context.
+     * @param value <tt>1</tt> to enable frame parallel decoding mode,
+     * <tt>0</tt> to disable it.
+     *
+     * @return <tt>CODEC_OK</tt> on success, or an error code otherwise. The
+     * error code can be converted to a <tt>String</tt> with
+     * {@link VPX#codec_err_to_string(int)}
+     */
+    public static native int codec_enc_set_frame_parallel_decoding(
+            long context,
+            int value);
+
+    /**
+     * Allocates a simulcast encoder, which uses libvpx's multi-resolution
+     * encoding to encode the same raw frame at <tt>num_layers</tt>
+     * resolutions in a single call. Layer 0 has the highest resolution, but
+     * libvpx encodes the lowest resolution layer first and the higher
+     * resolution layers reuse its motion analysis.
+     *
+     * To set it up:
+     * <ol>
+     * <li>initialize the configuration of layer 0 (see
+     * {@link #simulcast_get_cfg(long, int)}) with
+     * {@link #codec_enc_config_default(int, long, int)} and the
+     * <tt>codec_enc_cfg_set_*</tt> functions;</li>
+     * <li>optionally change the down-sampling factors with
+     * {@link #simulcast_set_dsf(long, int, int, int)} (the default is 2 for
+     * each layer);</li>
+     * <li>call {@link #simulcast_enc_cfg_derive(long)} and then adjust the
+     * configuration of the other layers (e.g. their target bitrate);</li>
+     * <li>call {@link #simulcast_enc_init(long, int, long)}.</li>
+     * </ol>
+     * The simulcast encoder has to be freed with
+     * {@link #simulcast_destroy(long)}.
+     *
+     * Multi-resolution encoding requires libvpx to be configured with
+     * <tt>--enable-multi-res-encoding</tt>.
+     *
+     * @param num_layers The number of layers, between 1 and
+     * {@link #SIMULCAST_MAX_LAYERS}.
+     *
+     * @return A pointer to the simulcast encoder, or 0 on failure.
+     */
+    public static native long simulcast_malloc(int num_layers);
+
+    /**
+     * Returns a pointer to the <tt>vpx_codec_enc_cfg_t</tt> of a layer of a
+     * simulcast encoder. It may be modified with the
+     * <tt>codec_enc_cfg_set_*</tt> functions until the simulcast encoder is
+     * initialized.
+     *
+     * @param sc Pointer to a simulcast encoder.
+     * @param layer The index of the layer, 0 being the highest resolution.
+     *
+     * @return A pointer to the configuration of the layer, or 0 if
+     * <tt>layer</tt> is out of range.
+     */
+    public static native long simulcast_get_cfg(long sc, int layer);
+
+    /**
+     * Returns a pointer to the <tt>vpx_codec_ctx_t</tt> of a layer of an
+     * initialized simulcast encoder. After
+     * {@link #simulcast_encode(long, long, byte[], int, int, int, long, long,
+     * long, long)}, the packets of the layer can be obtained from it with
+     * {@link #codec_get_cx_data(long, long[])}. The context is owned by the
+     * simulcast encoder and must not be destroyed or freed separately.
+     *
+     * @param sc Pointer to a simulcast encoder.
+     * @param layer The index of the layer, 0 being the highest resolution.
+     *
+     * @return A pointer to the context of the layer, or 0 if <tt>layer</tt> is
+     * out of range.
+     */
+    public static native long simulcast_get_ctx(long sc, int layer);
+
+    /**
+     * Sets the down-sampling factor <tt>num/den</tt> between a layer of a
+     * simulcast encoder and the next (lower resolution) layer.
+     *
+     * @param sc Pointer to a simulcast encoder.
+     * @param layer The index of the layer.
+     * @param num The numerator of the down-sampling factor.
+     * @param den The denominator of the down-sampling factor.
+     */
+    public static native void simulcast_set_dsf(long sc,
+                                                int layer,
+                                                int num,
+                                                int den);
+
+    /**
+     * Initializes the configuration of every layer of a simulcast encoder
+     * but the first one as a copy of the configuration of the layer above
+     * it, with the width and height reduced by the down-sampling factor.
+     *
+     * @param sc Pointer to a simulcast encoder.
+     */
+    public static native void simulcast_enc_cfg_derive(long sc);
+
+    /**
+     * Initializes the encoders of all layers of a simulcast encoder.
+     *
+     * @param sc Pointer to a simulcast encoder.
+     * @param iface Interface to be used. Only <tt>INTERFACE_VP8_ENC</tt>
+     * supports multi-resolution encoding.
+     * @param flags Flags.
+     *
+     * @return <tt>CODEC_OK</tt> on success, or an error code otherwise. The
+     * error code can be converted to a <tt>String</tt> with
+     * {@link VPX#codec_err_to_string(int)}
+     */
+    public static native int simulcast_enc_init(long sc, int iface, long flags);
+
+    /**
+     * Encodes the frame described by <tt>img</tt>, <tt>buf</tt> and the
+     * offsets at every layer of a simulcast encoder. The frame is downscaled
+     * natively for the lower layers. The parameters have the same meaning as
+     * for {@link #codec_encode(long, long, byte[], int, int, int, long, long,
+     * long, long)}; the dimensions of <tt>img</tt> have to match those of the
+     * configuration of layer 0.
+     *
+     * @param sc Pointer to an initialized simulcast encoder.
+     * @param img Pointer to a <tt>vpx_image_t</tt> describing the raw frame
+     * @param buf Contains the raw frame
+     * @param offset0 Offset of the first plane
+     * @param offset1 Offset of the second plane
+     * @param offset2 Offset of the third plane
+     * @param pts Presentation time stamp, in timebase units.
+     * @param duration Duration to show frame, in timebase units.
+     * @param flags Flags to use for encoding this frame.
+     * @param deadline Time to spend encoding, in microseconds. (0=infinite)
+     *
+     * @return <tt>CODEC_OK</tt> on success, or an error code otherwise. The
+     * error code can be converted to a <tt>String</tt> with
+     * {@link VPX#codec_err_to_string(int)}
+     */
+    public static native int simulcast_encode(long sc,
+                                              long img,
+                                              byte[] buf,
+                                              int offset0,
+                                              int offset1,
+                                              int offset2,
+                                              long pts,
+                                              long duration,
+                                              long flags,
+                                              long deadline);
+
+    /**
+     * Destroys the encoders of a simulcast encoder (if it has been
+     * initialized) and frees all memory associated with it.
+     *
+     * @param sc Pointer to the simulcast encoder to destroy.
+     */
+    public static native void simulcast_destroy(long sc);
+
     /**
      * Allocates memory for a <tt>vpx_codec_stream_info_t</tt> on the heap.
      *
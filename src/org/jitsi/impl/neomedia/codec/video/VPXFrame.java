@@ -0,0 +1,148 @@
+/*
+ * Copyright @ 2015 Atlassian Pty Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.jitsi.impl.neomedia.codec.video;
+
+/**
+ * A reference to a decoded I420 frame which a VPX decoder context allocated
+ * from a frame buffer pool (see {@link VPX#frame_buffer_pool_malloc(int)}).
+ * The frame can be read in place, without copying it out of the decoder,
+ * until the reference is released. Each <tt>VPXFrame</tt> instance holds one
+ * reference; {@link #retain()} returns a new instance holding another one,
+ * e.g. for a renderer and a re-encoder which consume the same frame.
+ *
+ * @author agent
+ */
+public class VPXFrame
+{
+    /**
+     * Takes a reference to the frame buffer holding a decoded image.
+     *
+     * @param pool pointer to the frame buffer pool of the decoder.
+     * @param img pointer to a <tt>vpx_image_t</tt> returned by
+     * {@link VPX#codec_get_frame(long, long[])}.
+     * @return a new <tt>VPXFrame</tt> referencing the frame buffer of
+     * <tt>img</tt>, or <tt>null</tt> if <tt>img</tt> was not allocated from
+     * <tt>pool</tt>.
+     */
+    public static VPXFrame ref(long pool, long img)
+    {
+        long fb = VPX.img_ref_frame_buffer(pool, img);
+
+        return (fb == 0) ? null : new VPXFrame(fb);
+    }
+
+    /**
+     * The handle to the native frame buffer, or 0 if this reference has been
+     * released.
+     */
+    private long fb;
+
+    /**
+     * Initializes a new <tt>VPXFrame</tt> which owns a reference to a frame
+     * buffer.
+     *
+     * @param fb the handle to the native frame buffer.
+     */
+    private VPXFrame(long fb)
+    {
+        this.fb = fb;
+    }
+
+    /**
+     * Gets the handle to the native frame buffer.
+     *
+     * @return the handle to the native frame buffer.
+     * @throws IllegalStateException if this reference has been released.
+     */
+    private synchronized long getFrameBuffer()
+    {
+        if (fb == 0)
+            throw new IllegalStateException("released");
+        return fb;
+    }
+
+    /**
+     * Gets the displayed height of the frame.
+     *
+     * @return the displayed height of the frame.
+     */
+    public int getHeight()
+    {
+        return VPX.frame_buffer_get_h(getFrameBuffer());
+    }
+
+    /**
+     * Gets a plane of the frame, without copying it. The returned buffer must
+     * not be accessed after this reference has been released.
+     *
+     * @param plane the plane: 0 (Y), 1 (U) or 2 (V).
+     * @return a direct <tt>java.nio.ByteBuffer</tt> over the plane, rows
+     * {@link #getStride(int)} bytes apart.
+     */
+    public java.nio.ByteBuffer getPlane(int plane)
+    {
+        return VPX.frame_buffer_get_plane(getFrameBuffer(), plane);
+    }
+
+    /**
+     * Gets the stride of a plane of the frame.
+     *
+     * @param plane the plane: 0 (Y), 1 (U) or 2 (V).
+     * @return the stride of the plane in bytes.
+     */
+    public int getStride(int plane)
+    {
+        return VPX.frame_buffer_get_stride(getFrameBuffer(), plane);
+    }
+
+    /**
+     * Gets the displayed width of the frame.
+     *
+     * @return the displayed width of the frame.
+     */
+    public int getWidth()
+    {
+        return VPX.frame_buffer_get_w(getFrameBuffer());
+    }
+
+    /**
+     * Releases this reference to the frame. The frame buffer is returned to
+     * its pool once it is not referenced anymore. Calling this method more
+     * than once has no effect.
+     */
+    public synchronized void release()
+    {
+        if (fb != 0)
+        {
+            VPX.frame_buffer_release(fb);
+            fb = 0;
+        }
+    }
+
+    /**
+     * Takes another reference to the frame.
+     *
+     * @return a new <tt>VPXFrame</tt> holding the new reference, which has to
+     * be released independently of this one.
+     */
+    public synchronized VPXFrame retain()
+    {
+        long fb = getFrameBuffer();
+
+        VPX.frame_buffer_ref(fb);
+        return new VPXFrame(fb);
+    }
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright @ 2015 Atlassian Pty Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.jitsi.impl.neomedia.codec.video.vp8;
+
+import java.awt.*;
+import java.util.*;
+
+/**
+ * A VP8 active map, i.e. the set of 16x16 macroblocks of a frame which the
+ * encoder codes, built from the rectangles of the frame which have changed.
+ * The rectangles accumulate until {@link #clear()} is called, so that the
+ * changes of frames which the encoder dropped are not lost.
+ *
+ * @author agent
+ */
+public class ActiveMap
+{
+    /**
+     * The width and height of a VP8 macroblock in pixels.
+     */
+    private static final int MACROBLOCK_SIZE = 16;
+
+    /**
+     * The number of macroblock columns of the frame.
+     */
+    private final int cols;
+
+    /**
+     * One byte per macroblock, in raster order, <tt>1</tt> for the active
+     * macroblocks.
+     */
+    private final byte[] map;
+
+    /**
+     * The height of the frame in pixels.
+     */
+    private final int height;
+
+    /**
+     * The number of macroblock rows of the frame.
+     */
+    private final int rows;
+
+    /**
+     * The width of the frame in pixels.
+     */
+    private final int width;
+
+    /**
+     * Initializes a new <tt>ActiveMap</tt> for frames of a specific size,
+     * with no active macroblock.
+     *
+     * @param width the width of the frames in pixels.
+     * @param height the height of the frames in pixels.
+     */
+    public ActiveMap(int width, int height)
+    {
+        this.width = width;
+        this.height = height;
+        cols = (width + MACROBLOCK_SIZE - 1) / MACROBLOCK_SIZE;
+        rows = (height + MACROBLOCK_SIZE - 1) / MACROBLOCK_SIZE;
+        map = new byte[rows * cols];
+    }
+
+    /**
+     * Marks the macroblocks which intersect a set of changed rectangles as
+     * active.
+     *
+     * @param dirty the changed rectangles, in pixels. Rectangles outside of
+     * the frame are clipped.
+     */
+    public void add(Rectangle[] dirty)
+    {
+        for (Rectangle r : dirty)
+        {
+            if (r == null || r.isEmpty())
+                continue;
+
+            int x0 = Math.max(0, r.x);
+            int y0 = Math.max(0, r.y);
+            int x1 = Math.min(width, r.x + r.width);
+            int y1 = Math.min(height, r.y + r.height);
+
+            if (x0 >= x1 || y0 >= y1)
+                continue;
+
+            int col0 = x0 / MACROBLOCK_SIZE;
+            int col1 = (x1 - 1) / MACROBLOCK_SIZE;
+
+            for (int row = y0 / MACROBLOCK_SIZE;
+                    row <= (y1 - 1) / MACROBLOCK_SIZE;
+                    row++)
+            {
+                Arrays.fill(map, row * cols + col0, row * cols + col1 + 1,
+                        (byte) 1);
+            }
+        }
+    }
+
+    /**
+     * Marks all macroblocks as inactive.
+     */
+    public void clear()
+    {
+        Arrays.fill(map, (byte) 0);
+    }
+
+    /**
+     * Marks all macroblocks as active.
+     */
+    public void fill()
+    {
+        Arrays.fill(map, (byte) 1);
+    }
+
+    /**
+     * Gets the number of macroblock columns of the frame.
+     *
+     * @return the number of macroblock columns of the frame.
+     */
+    public int getCols()
+    {
+        return cols;
+    }
+
+    /**
+     * Gets the map, one byte per macroblock in raster order, non-zero for the
+     * active macroblocks.
+     *
+     * @return the map.
+     */
+    public byte[] getMap()
+    {
+        return map;
+    }
+
+    /**
+     * Gets the number of macroblock rows of the frame.
+     *
+     * @return the number of macroblock rows of the frame.
+     */
+    public int getRows()
+    {
+        return rows;
+    }
+
+    /**
+     * Determines whether this map is for frames of a specific size.
+     *
+     * @param width the width of the frames in pixels.
+     * @param height the height of the frames in pixels.
+     * @return <tt>true</tt> if this map is for frames of the given size.
+     */
+    public boolean hasSize(int width, int height)
+    {
+        return this.width == width && this.height == height;
+    }
+}
@@ -16,6 +16,7 @@
 package org.jitsi.impl.neomedia.codec.video.vp8;
 
 import org.jitsi.impl.neomedia.codec.*;
+import org.jitsi.impl.neomedia.codec.video.*;
 import org.jitsi.service.neomedia.codec.*;
 import org.jitsi.util.*;
 import org.jitsi.utils.*;
@@ -47,6 +48,17 @@
      */
     private static final boolean TRACE = logger.isTraceEnabled();
 
+    /**
+     * The name of the boolean <tt>ConfigurationService</tt> property which
+     * specifies whether the <tt>DePacketizer</tt>s which feed a
+     * {@link VPXDecoder} are to reassemble frames in native memory (see
+     * {@link #setNativeFrameAssembly(boolean)}). The property does not affect
+     * other <tt>DePacketizer</tt>s, e.g. the ones of recorders. The default
+     * value is <tt>false</tt>.
+     */
+    public static final String NATIVE_FRAME_ASSEMBLY_PNAME
+        = "org.jitsi.impl.neomedia.codec.video.vp8.nativeFrameAssembly";
+
     /**
      * Stores the RTP payloads (VP8 payload descriptor stripped) from RTP packets
      * belonging to a single VP8 compressed frame.
@@ -109,12 +121,55 @@
      */
     private int frameLength = 0;
 
+    /**
+     * The temporal layer index (TID) of the VP8 compressed frame, parts of
+     * which are currently stored in <tt>data</tt>, or -1 if it is not known.
+     */
+    private int frameTemporalLayerId = -1;
+
+    /**
+     * Whether the VP8 compressed frame, parts of which are currently stored
+     * in <tt>data</tt>, is a layer sync point.
+     */
+    private boolean frameLayerSync = false;
+
+    /**
+     * Whether the VP8 compressed frame, parts of which are currently stored
+     * in <tt>data</tt>, may be referenced by subsequent frames.
+     */
+    private boolean frameReference = true;
+
     /**
      * The sequence number of the last RTP packet, which was included in the
      * output.
      */
     private int lastSentSeq = -1;
 
+    /**
+     * Whether to output frames split into {@link FrameFragments} and, when
+     * packets are missing, the received part of the frame, for a decoder
+     * which conceals errors. See {@link #setOutputPartialFrames(boolean)}.
+     */
+    private boolean outputFragments = false;
+
+    /**
+     * The handle to the native frame assembler, or 0 if frames are
+     * reassembled in Java.
+     */
+    private long assembler = 0;
+
+    /**
+     * Whether frames are to be reassembled in native memory when this
+     * instance is opened.
+     */
+    private boolean nativeFrameAssembly = false;
+
+    /**
+     * Receives the description of the frames assembled by {@link #assembler}.
+     */
+    private final long[] assembledFrameInfo
+        = new long[VPX.ASSEMBLED_FRAME_INFO_LENGTH];
+
     /**
      * Initializes a new <tt>JNIEncoder</tt> instance.
      */
@@ -132,6 +187,11 @@ public DePacketizer()
     @Override
     protected void doClose()
     {
+        if (assembler != 0)
+        {
+            VPX.frame_assembler_free(assembler);
+            assembler = 0;
+        }
     }
 
     /**
@@ -140,10 +200,50 @@ protected void doClose()
     @Override
     protected void doOpen() throws ResourceUnavailableException
     {
+        if (nativeFrameAssembly)
+        {
+            assembler = VPX.frame_assembler_malloc();
+            if (assembler == 0)
+                logger.warn("Failed to allocate a native frame assembler.");
+        }
+
         if(logger.isInfoEnabled())
             logger.info("Opened VP8 depacketizer");
     }
 
+    /**
+     * Sets whether this instance is to reassemble frames in native memory
+     * (see {@link VPX#frame_assembler_malloc()}) and output them as direct
+     * <tt>java.nio.ByteBuffer</tt>s, which {@link VPXDecoder} reads without
+     * copying them. Such a frame is only valid until the next call to
+     * {@link #process(Buffer, Buffer)}, and partial frames are not output, so
+     * this is only to be enabled on an instance which feeds a
+     * <tt>VPXDecoder</tt>. Takes effect when this instance is opened.
+     *
+     * @param nativeFrameAssembly <tt>true</tt> to reassemble frames in native
+     * memory, <tt>false</tt> to reassemble them in Java.
+     */
+    public void setNativeFrameAssembly(boolean nativeFrameAssembly)
+    {
+        this.nativeFrameAssembly = nativeFrameAssembly;
+    }
+
+    /**
+     * Sets whether this instance is to output frames split into
+     * {@link FrameFragments} and, when packets are missing, the received part
+     * of a frame. This is only to be enabled on an instance which feeds a
+     * {@link VPXDecoder} with error concealment (see
+     * {@link VPXDecoder#ERROR_CONCEALMENT_PNAME}), because other consumers,
+     * e.g. recorders, would take a partial frame for a whole one.
+     *
+     * @param outputPartialFrames <tt>true</tt> to output partial frames,
+     * <tt>false</tt> to only output whole frames.
+     */
+    public void setOutputPartialFrames(boolean outputPartialFrames)
+    {
+        outputFragments = outputPartialFrames;
+    }
+
     /**
      * Re-initializes the fields which store information about the currently
      * held data. Empties <tt>data</tt>.
@@ -156,6 +256,9 @@ private void reinit()
         empty = true;
         haveEnd = haveStart = false;
         frameLength = 0;
+        frameTemporalLayerId = -1;
+        frameLayerSync = false;
+        frameReference = true;
 
         Iterator<Map.Entry<Integer,Container>> it = data.entrySet().iterator();
         Map.Entry<Integer, Container> e;
@@ -205,6 +308,9 @@ private boolean haveMissing()
     @Override
     protected int doProcess(Buffer inBuffer, Buffer outBuffer)
     {
+        if (assembler != 0)
+            return doProcessNative(inBuffer, outBuffer);
+
         byte[] inData = (byte[])inBuffer.getData();
         int inOffset = inBuffer.getOffset();
         int inLength = inBuffer.getLength();
@@ -261,6 +367,14 @@ protected int doProcess(Buffer inBuffer, Buffer outBuffer)
                     // the packet belongs to a subsequent frame (to the one
                     // currently being held). Drop the current frame.
 
+                    // If the decoder conceals errors, give it what was received
+                    // of the frame and process the packet again afterwards.
+                    if (outputFragments && outputPartialFrame(outBuffer))
+                    {
+                        reinit();
+                        return INPUT_BUFFER_NOT_CONSUMED;
+                    }
+
                     if (logger.isInfoEnabled())
                         logger.info("Discarding saved packets on arrival of" +
                                 " a packet for a subsequent frame: " + inSeq);
@@ -287,6 +401,15 @@ protected int doProcess(Buffer inBuffer, Buffer outBuffer)
             outBuffer.setOffset(0);
             outBuffer.setLength(inPayloadLength);
             outBuffer.setRtpTimeStamp(inBuffer.getRtpTimeStamp());
+            outBuffer.setHeader(
+                    new FrameHeader(
+                            VP8PayloadDescriptor.getTemporalLayerIndex(
+                                    inData, inOffset, inLength),
+                            VP8PayloadDescriptor.isLayerSync(
+                                    inData, inOffset, inLength),
+                            VP8PayloadDescriptor.isReference(
+                                    inData, inOffset, inLength),
+                            null));
 
             if (TRACE)
                 logger.trace("Out PictureID=" + inPictureId);
@@ -319,6 +442,10 @@ protected int doProcess(Buffer inBuffer, Buffer outBuffer)
                 0,
                 inPayloadLength);
         container.len = inPayloadLength;
+        container.partitionId
+            = VP8PayloadDescriptor.getPartitionId(inData, inOffset);
+        container.startOfPartition
+            = VP8PayloadDescriptor.isStartOfPartition(inData, inOffset);
         data.put(inSeq, container);
 
         // update fields
@@ -343,7 +470,16 @@ protected int doProcess(Buffer inBuffer, Buffer outBuffer)
         if (inMarker)
             haveEnd = true;
         if (inIsStartOfFrame)
+        {
             haveStart = true;
+            frameTemporalLayerId
+                = VP8PayloadDescriptor.getTemporalLayerIndex(
+                        inData, inOffset, inLength);
+            frameLayerSync
+                = VP8PayloadDescriptor.isLayerSync(inData, inOffset, inLength);
+            frameReference
+                = VP8PayloadDescriptor.isReference(inData, inOffset, inLength);
+        }
 
         // check if we have a full frame
         if (frameComplete())
@@ -367,6 +503,14 @@ protected int doProcess(Buffer inBuffer, Buffer outBuffer)
             outBuffer.setOffset(0);
             outBuffer.setLength(frameLength);
             outBuffer.setRtpTimeStamp(inBuffer.getRtpTimeStamp());
+            outBuffer.setHeader(
+                    new FrameHeader(
+                            frameTemporalLayerId,
+                            frameLayerSync,
+                            frameReference,
+                            outputFragments
+                                ? getFragments(data.size(), false)
+                                : null));
 
             if (TRACE)
                 logger.trace("Out PictureID=" + inPictureId);
@@ -385,6 +529,199 @@ protected int doProcess(Buffer inBuffer, Buffer outBuffer)
         }
     }
 
+    /**
+     * Processes an RTP packet with the native frame assembler, and outputs
+     * the frame it completes, if any, as a direct <tt>java.nio.ByteBuffer</tt>
+     * over native memory.
+     *
+     * @param inBuffer the <tt>Buffer</tt> holding the RTP payload.
+     * @param outBuffer the <tt>Buffer</tt> to output the frame in.
+     * @return the result of the processing, as for
+     * {@link #doProcess(Buffer, Buffer)}.
+     */
+    private int doProcessNative(Buffer inBuffer, Buffer outBuffer)
+    {
+        int inSeq = (int) inBuffer.getSequenceNumber();
+        int status
+            = VPX.frame_assembler_push(
+                    assembler,
+                    (byte[]) inBuffer.getData(),
+                    inBuffer.getOffset(),
+                    inBuffer.getLength(),
+                    inSeq,
+                    inBuffer.getRtpTimeStamp(),
+                    (inBuffer.getFlags() & Buffer.FLAG_RTP_MARKER) != 0,
+                    assembledFrameInfo);
+
+        if (status < 0)
+        {
+            logger.warn("Failed to assemble a VP8 frame: "
+                    + VPX.codec_err_to_string(-status));
+            outBuffer.setDiscard(true);
+            return BUFFER_PROCESSED_FAILED;
+        }
+        if ((status & VPX.FRAME_ASSEMBLER_DISCARDED) != 0)
+        {
+            if (logger.isInfoEnabled())
+                logger.info("Discarding packet " + inSeq);
+            outBuffer.setDiscard(true);
+            return BUFFER_PROCESSED_OK;
+        }
+        if ((status & VPX.FRAME_ASSEMBLER_FRAME_DROPPED) != 0
+                && logger.isInfoEnabled())
+        {
+            logger.info("Dropped an incomplete frame on receipt of packet "
+                    + inSeq);
+        }
+        if ((status & VPX.FRAME_ASSEMBLER_FRAME_READY) == 0)
+        {
+            // frame not complete yet
+            outBuffer.setDiscard(true);
+            return OUTPUT_BUFFER_NOT_FILLED;
+        }
+
+        int flags = (int) assembledFrameInfo[4];
+
+        outBuffer.setData(VPX.frame_assembler_get_frame(assembler));
+        outBuffer.setOffset(0);
+        outBuffer.setLength((int) assembledFrameInfo[0]);
+        outBuffer.setRtpTimeStamp(assembledFrameInfo[1]);
+        outBuffer.setHeader(
+                new FrameHeader(
+                        (int) assembledFrameInfo[3],
+                        (flags & VPX.FRAME_IS_LAYER_SYNC) != 0,
+                        (flags & VPX.FRAME_IS_DROPPABLE) == 0,
+                        null));
+        lastSentSeq = (int) assembledFrameInfo[2];
+        return BUFFER_PROCESSED_OK;
+    }
+
+    /**
+     * Splits the first <tt>packetCount</tt> packets stored in <tt>data</tt>
+     * into fragments along the partition boundaries signalled in their
+     * payload descriptors.
+     *
+     * @param packetCount the number of packets, in sequence number order, to
+     * split.
+     * @param partial whether the packets are only the received part of the
+     * frame.
+     * @return the <tt>FrameFragments</tt> describing the packets.
+     */
+    private FrameFragments getFragments(int packetCount, boolean partial)
+    {
+        int[] sizes = new int[VPX.MAX_FRAGMENTS];
+        int count = 0;
+        int partitionId = -1;
+        int total = 0;
+        boolean split = true;
+        Iterator<Container> it = data.values().iterator();
+
+        for (int i = 0; i < packetCount && it.hasNext(); i++)
+        {
+            Container c = it.next();
+
+            if (count == 0
+                    || (c.startOfPartition && c.partitionId != partitionId))
+            {
+                // A PartID of 7 may hold several partitions, and libvpx needs
+                // exactly one partition per fragment.
+                if (count == VPX.MAX_FRAGMENTS || c.partitionId >= 7)
+                    split = false;
+                else
+                {
+                    sizes[count++] = 0;
+                    partitionId = c.partitionId;
+                }
+            }
+            if (count > 0)
+                sizes[count - 1] += c.len;
+            total += c.len;
+        }
+        if (!split)
+        {
+            sizes[0] = total;
+            count = 1;
+        }
+        return new FrameFragments(sizes, count, partial);
+    }
+
+    /**
+     * Outputs the contiguous part of the currently held (incomplete) frame,
+     * starting with its first packet, if it contains the whole first
+     * partition. The decoder can then conceal the missing token partitions
+     * instead of the whole frame being lost.
+     *
+     * @param outBuffer the <tt>Buffer</tt> to output the frame in.
+     * @return <tt>true</tt> if a frame was output, <tt>false</tt> otherwise.
+     */
+    private boolean outputPartialFrame(Buffer outBuffer)
+    {
+        if (!haveStart)
+            return false;
+
+        int length = 0;
+        int packetCount = 0;
+        int expectedSeq = firstSeq;
+        int seq = -1;
+
+        for (Map.Entry<Integer, Container> entry : data.entrySet())
+        {
+            if (entry.getKey() != expectedSeq)
+                break;
+            seq = expectedSeq;
+            length += entry.getValue().len;
+            packetCount++;
+            expectedSeq = (expectedSeq + 1) & 0xffff;
+        }
+        if (packetCount == 0)
+            return false;
+
+        byte[] outData = validateByteArraySize(outBuffer, length, false);
+        int ptr = 0;
+        Iterator<Container> it = data.values().iterator();
+
+        for (int i = 0; i < packetCount; i++)
+        {
+            Container b = it.next();
+
+            System.arraycopy(b.buf, 0, outData, ptr, b.len);
+            ptr += b.len;
+        }
+
+        // RFC 6386, 9.1: a 3 byte frame tag (and for keyframes a 7 byte
+        // start code and size) precede the first partition, the size of
+        // which is in the frame tag.
+        if (length < 3)
+            return false;
+        int firstPartitionSize
+            = (((outData[0] & 0xff)
+                    | ((outData[1] & 0xff) << 8)
+                    | ((outData[2] & 0xff) << 16))
+                >> 5)
+                & 0x7ffff;
+        int headerSize = ((outData[0] & 0x01) == 0) ? 10 : 3;
+
+        if (length < headerSize + firstPartitionSize)
+            return false;
+
+        outBuffer.setOffset(0);
+        outBuffer.setLength(length);
+        outBuffer.setRtpTimeStamp(timestamp);
+        outBuffer.setHeader(
+                new FrameHeader(
+                        frameTemporalLayerId,
+                        frameLayerSync,
+                        frameReference,
+                        getFragments(packetCount, true)));
+
+        if (logger.isInfoEnabled())
+            logger.info("Outputting a partial frame of " + packetCount
+                    + " packets, " + seq + " is the last one received in"
+                    + " order.");
+        lastSentSeq = lastSeq;
+        return true;
+    }
+
     /**
      * Returns true if the buffer contains a VP8 key frame at offset
      * <tt>offset</tt>.
@@ -474,6 +811,11 @@ public static boolean isKeyFrame(byte[] buf, int off, int len)
          */
         private static final byte N_BIT = (byte) 0x20;
 
+        /**
+         * Y bit from the TID/Y/KEYIDX byte of the Payload Descriptor.
+         */
+        private static final byte Y_BIT = (byte) 0x20;
+
         /**
          * Gets the temporal layer index (TID), if that's set.
          *
@@ -504,6 +846,28 @@ public static int getTemporalLayerIndex(byte[] buf, int off, int len)
             return (buf[off + sz - 1] & 0xc0) >> 6;
         }
 
+        /**
+         * Gets whether the layer sync (Y) bit is set.
+         *
+         * @param buf the byte buffer that holds the VP8 packet.
+         * @param off the offset in the byte buffer where the VP8 packet starts.
+         * @param len the length of the VP8 packet.
+         *
+         * @return <tt>true</tt> if the TID field is present and the Y bit is
+         * set, <tt>false</tt> otherwise.
+         */
+        public static boolean isLayerSync(byte[] buf, int off, int len)
+        {
+            if (getTemporalLayerIndex(buf, off, len) == -1)
+            {
+                return false;
+            }
+
+            int sz = getSize(buf, off, len);
+
+            return (buf[off + sz - 1] & Y_BIT) != 0;
+        }
+
         /**
          * Returns a simple Payload Descriptor, with PartID = 0, the 'start
          * of partition' bit set according to <tt>startOfPartition</tt>, and
@@ -521,6 +885,81 @@ public static byte[] create(boolean startOfPartition)
             return pd;
         }
 
+        /**
+         * Returns a Payload Descriptor with PartID = 0, the 'start of
+         * partition' bit set according to <tt>startOfPartition</tt> and a
+         * 15-bit PictureID.
+         *
+         * @param startOfPartition whether to 'start of partition' bit should be
+         * set
+         * @param pictureId the PictureID of the frame.
+         * @return a Payload Descriptor with the I extension set according to
+         * the specified arguments.
+         */
+        public static byte[] create(boolean startOfPartition, int pictureId)
+        {
+            byte[] pd = new byte[4];
+
+            pd[0] = (byte) (X_BIT | (startOfPartition ? S_BIT : 0));
+            pd[1] = I_BIT;
+            setPictureId(pd, 2, pictureId);
+            return pd;
+        }
+
+        /**
+         * Returns a Payload Descriptor with PartID = 0, the 'start of
+         * partition' and non-reference bits set according to
+         * <tt>startOfPartition</tt> and <tt>nonReference</tt>, a 15-bit
+         * PictureID and the TL0PICIDX and TID/Y extension fields set to the
+         * given values.
+         *
+         * @param startOfPartition whether to 'start of partition' bit should be
+         * set
+         * @param nonReference whether the frame is not referenced by any other
+         * frame (i.e. the N bit should be set).
+         * @param pictureId the PictureID of the frame.
+         * @param tl0PicIdx the value of the TL0PICIDX field.
+         * @param tid the temporal layer index (TID) of the frame.
+         * @param layerSync whether the frame is a layer sync point (i.e. the
+         * Y bit should be set).
+         * @return a Payload Descriptor with the I, L and T extensions set
+         * according to the specified arguments.
+         */
+        public static byte[] create(
+                boolean startOfPartition,
+                boolean nonReference,
+                int pictureId,
+                int tl0PicIdx,
+                int tid,
+                boolean layerSync)
+        {
+            byte[] pd = new byte[6];
+
+            pd[0]
+                = (byte)
+                    (X_BIT
+                        | (nonReference ? N_BIT : 0)
+                        | (startOfPartition ? S_BIT : 0));
+            pd[1] = (byte) (I_BIT | L_BIT | T_BIT);
+            setPictureId(pd, 2, pictureId);
+            pd[4] = (byte) (tl0PicIdx & TL0PICIDX_MASK);
+            pd[5] = (byte) (((tid & 0x03) << 6) | (layerSync ? Y_BIT : 0));
+            return pd;
+        }
+
+        /**
+         * Writes a 15-bit PictureID, i.e. with the M bit set.
+         *
+         * @param buf the array to write to.
+         * @param off the offset of the PictureID field in <tt>buf</tt>.
+         * @param pictureId the PictureID.
+         */
+        private static void setPictureId(byte[] buf, int off, int pictureId)
+        {
+            buf[off] = (byte) (M_BIT | ((pictureId >> 8) & 0x7f));
+            buf[off + 1] = (byte) pictureId;
+        }
+
         /**
          * The size in bytes of the Payload Descriptor at offset
          * <tt>offset</tt> in <tt>input</tt>. The size is between 1 and 6.
@@ -874,5 +1313,182 @@ public static int getHeight(byte[] buf, int off)
          * Length used.
          */
         private int len = 0;
+
+        /**
+         * The PartID of the payload descriptor of the packet.
+         */
+        private int partitionId = 0;
+
+        /**
+         * Whether the packet starts a partition.
+         */
+        private boolean startOfPartition = false;
+    }
+
+    /**
+     * Carries the information from the payload descriptors of a VP8 frame
+     * output by the <tt>DePacketizer</tt> which a decoder may use, e.g. to
+     * skip frames it does not need. Set as the header of the output
+     * <tt>Buffer</tt>.
+     */
+    public static class FrameHeader
+    {
+        /**
+         * The partitions of the frame, or <tt>null</tt>.
+         */
+        private final FrameFragments fragments;
+
+        /**
+         * Whether the frame is a layer sync point.
+         */
+        private final boolean layerSync;
+
+        /**
+         * Whether the frame may be referenced by subsequent frames.
+         */
+        private final boolean reference;
+
+        /**
+         * The temporal layer index (TID) of the frame, or -1.
+         */
+        private final int temporalLayerId;
+
+        /**
+         * Initializes a new <tt>FrameHeader</tt> instance.
+         *
+         * @param temporalLayerId the temporal layer index (TID) of the frame,
+         * or -1 if it is not known.
+         * @param layerSync whether the frame is a layer sync point.
+         * @param reference whether the frame may be referenced by subsequent
+         * frames.
+         * @param fragments the partitions of the frame, or <tt>null</tt>.
+         */
+        public FrameHeader(
+                int temporalLayerId,
+                boolean layerSync,
+                boolean reference,
+                FrameFragments fragments)
+        {
+            this.temporalLayerId = temporalLayerId;
+            this.layerSync = layerSync;
+            this.reference = reference;
+            this.fragments = fragments;
+        }
+
+        /**
+         * Gets the partitions of the frame.
+         *
+         * @return the partitions of the frame, or <tt>null</tt> if the
+         * <tt>DePacketizer</tt> is not configured to output them.
+         */
+        public FrameFragments getFragments()
+        {
+            return fragments;
+        }
+
+        /**
+         * Gets the temporal layer index (TID) of the frame.
+         *
+         * @return the temporal layer index (TID) of the frame, or -1 if it is
+         * not known.
+         */
+        public int getTemporalLayerId()
+        {
+            return temporalLayerId;
+        }
+
+        /**
+         * Gets whether the frame is a layer sync point, i.e. depends only on
+         * frames of the base layer.
+         *
+         * @return <tt>true</tt> if the frame is a layer sync point.
+         */
+        public boolean isLayerSync()
+        {
+            return layerSync;
+        }
+
+        /**
+         * Gets whether the frame may be referenced by subsequent frames.
+         *
+         * @return <tt>false</tt> if the frame is signalled as a non-reference
+         * frame, <tt>true</tt> otherwise.
+         */
+        public boolean isReference()
+        {
+            return reference;
+        }
+    }
+
+    /**
+     * Describes how a VP8 frame output by the <tt>DePacketizer</tt> is split
+     * into partitions, so that a decoder using
+     * {@link VPX#CODEC_USE_INPUT_FRAGMENTS} can feed them separately. Carried
+     * by the {@link FrameHeader} of the output <tt>Buffer</tt>.
+     */
+    public static class FrameFragments
+    {
+        /**
+         * The number of fragments.
+         */
+        private final int count;
+
+        /**
+         * Whether the frame is only the part which was received, i.e. it ends
+         * with missing partitions.
+         */
+        private final boolean partial;
+
+        /**
+         * The sizes of the fragments.
+         */
+        private final int[] sizes;
+
+        /**
+         * Initializes a new <tt>FrameFragments</tt> instance.
+         *
+         * @param sizes the sizes of the fragments.
+         * @param count the number of fragments.
+         * @param partial whether the frame is only the part which was
+         * received.
+         */
+        public FrameFragments(int[] sizes, int count, boolean partial)
+        {
+            this.sizes = sizes;
+            this.count = count;
+            this.partial = partial;
+        }
+
+        /**
+         * Gets the number of fragments.
+         *
+         * @return the number of fragments.
+         */
+        public int getCount()
+        {
+            return count;
+        }
+
+        /**
+         * Gets the sizes of the fragments. Only the first {@link #getCount()}
+         * elements are valid.
+         *
+         * @return the sizes of the fragments.
+         */
+        public int[] getSizes()
+        {
+            return sizes;
+        }
+
+        /**
+         * Gets whether the frame is only the part which was received.
+         *
+         * @return <tt>true</tt> if the frame is only the part which was
+         * received.
+         */
+        public boolean isPartial()
+        {
+            return partial;
+        }
     }
 }
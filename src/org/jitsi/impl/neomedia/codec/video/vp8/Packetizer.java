@@ -15,10 +15,13 @@
  */
 package org.jitsi.impl.neomedia.codec.video.vp8;
 
+import java.util.*;
+
 import javax.media.*;
 import javax.media.format.*;
 
 import org.jitsi.impl.neomedia.codec.*;
+import org.jitsi.impl.neomedia.codec.video.*;
 import org.jitsi.service.neomedia.codec.*;
 import org.jitsi.utils.logging.*;
 
@@ -26,10 +29,17 @@
  * Packetizes VP8 encoded frames in accord with
  * {@link "http://tools.ietf.org/html/draft-ietf-payload-vp8-07"}
  *
- * Uses the simplest possible scheme, only splitting large packets. Extended
- * bits are never added, and PartID is always set to 0. The only bit that
- * changes is the Start of Partition bit, which is set only for the first packet
- * encoding a frame.
+ * Uses the simplest possible scheme, only splitting large packets. PartID is
+ * always set to 0 and the Start of Partition bit is set only for the first
+ * packet encoding a frame. Every frame carries a 15-bit PictureID, the one
+ * which the encoder has attached to the frame in a {@link FrameHeader} or
+ * else the one following that of the previous frame. The TL0PICIDX and TID/Y
+ * fields are set when the <tt>FrameHeader</tt> has temporal layering
+ * information.
+ *
+ * If the encoder has already packetized the frame natively (see
+ * {@link PacketizedFrame}), the payloads are output as they are, without
+ * copying them.
  *
  * @author Boris Grozev
  */
@@ -46,13 +56,72 @@
      * Maximum size of packets (excluding the payload descriptor and any other
      * headers (RTP, UDP))
      */
-    private static final int MAX_SIZE = 1350;
+    static final int MAX_SIZE = 1350;
+
+    /**
+     * Creates the payload descriptor for a packet of a frame.
+     *
+     * @param frameInfo the temporal layering properties of the frame, or
+     * <tt>null</tt>.
+     * @param pictureId the PictureID of the frame.
+     * @param startOfPartition whether the packet is the first one of the
+     * frame.
+     * @return the payload descriptor for a packet of the frame.
+     */
+    static byte[] createPayloadDescriptor(
+            TemporalLayering.FrameInfo frameInfo,
+            int pictureId,
+            boolean startOfPartition)
+    {
+        if (frameInfo != null)
+        {
+            return
+                DePacketizer.VP8PayloadDescriptor.create(
+                        startOfPartition,
+                        !frameInfo.isReference(),
+                        pictureId,
+                        frameInfo.getTL0PicIdx(),
+                        frameInfo.getTemporalLayerId(),
+                        frameInfo.isLayerSync());
+        }
+        else
+        {
+            return
+                DePacketizer.VP8PayloadDescriptor.create(
+                        startOfPartition,
+                        pictureId);
+        }
+    }
+
+    /**
+     * Gets a random PictureID to number the frames of a stream from, as
+     * recommended by RFC 7741.
+     *
+     * @return a random 15-bit PictureID.
+     */
+    static int createInitialPictureId()
+    {
+        return
+            new Random().nextInt(
+                    DePacketizer.VP8PayloadDescriptor.EXTENDED_PICTURE_ID_MASK
+                        + 1);
+    }
 
     /**
      * Whether this is the first packet from the frame.
      */
     private boolean firstPacket = true;
 
+    /**
+     * The PictureID of the frame being packetized.
+     */
+    private int pictureId = createInitialPictureId();
+
+    /**
+     * The index of the next payload to output of a {@link PacketizedFrame}.
+     */
+    private int nextPayload = 0;
+
     /**
      * Initializes a new <tt>Packetizer</tt> instance.
      */
@@ -98,6 +167,20 @@ protected int doProcess(Buffer inputBuffer, Buffer outputBuffer)
             return BUFFER_PROCESSED_OK;
         }
 
+        Object header = inputBuffer.getHeader();
+
+        if (header instanceof PacketizedFrame)
+            return
+                outputPayload(
+                        (PacketizedFrame) header,
+                        inputBuffer,
+                        outputBuffer);
+
+        //the data of the output Buffer may be that of a previous input Buffer
+        //which held a PacketizedFrame
+        if (outputBuffer.getData() == inputBuffer.getData())
+            outputBuffer.setData(null);
+
         byte[] output;
         int offset;
         int pdMaxLen = DePacketizer.VP8PayloadDescriptor.MAX_LENGTH;
@@ -108,13 +191,46 @@ protected int doProcess(Buffer inputBuffer, Buffer outputBuffer)
 
         offset = pdMaxLen;
         output = validateByteArraySize(outputBuffer, offset + len, true);
-        System.arraycopy(
-                inputBuffer.getData(), inOff,
-                output, offset,
-                len);
 
-        //get the payload descriptor and copy it to the output
-        byte[] pd = DePacketizer.VP8PayloadDescriptor.create(firstPacket);
+        Object input = inputBuffer.getData();
+
+        if (input instanceof java.nio.ByteBuffer)
+        {
+            // e.g. a frame of a memory-mapped file. Leave the position of the
+            // buffer of the input alone.
+            java.nio.ByteBuffer src = ((java.nio.ByteBuffer) input).duplicate();
+
+            src.position(inOff);
+            src.get(output, offset, len);
+        }
+        else
+        {
+            System.arraycopy(input, inOff, output, offset, len);
+        }
+
+        //get the payload descriptor and copy it to the output. If the encoder
+        //attached a FrameHeader to the frame, signal its PictureID and
+        //temporal layer information.
+        TemporalLayering.FrameInfo frameInfo = null;
+
+        if (header instanceof FrameHeader)
+        {
+            FrameHeader frameHeader = (FrameHeader) header;
+
+            if (firstPacket)
+                pictureId = frameHeader.getPictureId();
+            frameInfo = frameHeader.getFrameInfo();
+        }
+        else if (firstPacket)
+        {
+            pictureId
+                = (pictureId + 1)
+                    & DePacketizer.VP8PayloadDescriptor
+                        .EXTENDED_PICTURE_ID_MASK;
+        }
+
+        byte[] pd = createPayloadDescriptor(frameInfo, pictureId, firstPacket);
+
         System.arraycopy(
                 pd, 0,
                 output, offset - pd.length,
@@ -140,4 +256,173 @@ protected int doProcess(Buffer inputBuffer, Buffer outputBuffer)
             return INPUT_BUFFER_NOT_CONSUMED;
         }
     }
+
+    /**
+     * Outputs the next payload of a frame which the encoder has packetized
+     * natively. The payloads are output in place, i.e. <tt>outputBuffer</tt>
+     * shares the data of <tt>inputBuffer</tt>.
+     *
+     * @param frame the payloads of the frame.
+     * @param inputBuffer the input <tt>Buffer</tt> which holds the payloads.
+     * @param outputBuffer the output <tt>Buffer</tt>.
+     * @return <tt>INPUT_BUFFER_NOT_CONSUMED</tt> if there are more payloads
+     * to output, <tt>BUFFER_PROCESSED_OK</tt> otherwise.
+     */
+    private int outputPayload(
+            PacketizedFrame frame,
+            Buffer inputBuffer,
+            Buffer outputBuffer)
+    {
+        int i = nextPayload;
+        int flags = outputBuffer.getFlags();
+
+        if (frame.isEndOfFrame(i))
+            flags |= Buffer.FLAG_RTP_MARKER;
+        else
+            flags &= ~Buffer.FLAG_RTP_MARKER;
+
+        outputBuffer.setFormat(new VideoFormat(Constants.VP8_RTP));
+        outputBuffer.setData(inputBuffer.getData());
+        outputBuffer.setOffset(frame.getOffset(i));
+        outputBuffer.setLength(frame.getLength(i));
+        outputBuffer.setFlags(flags);
+
+        if (++nextPayload < frame.getCount())
+            return INPUT_BUFFER_NOT_CONSUMED;
+
+        nextPayload = 0;
+        return BUFFER_PROCESSED_OK;
+    }
+
+    /**
+     * Describes an encoded frame to be packetized: its PictureID and its
+     * temporal layering properties, if any. The encoder sets it as the header
+     * of the <tt>Buffer</tt> holding the frame, so that it knows which
+     * PictureID an RTCP feedback message refers to.
+     */
+    public static class FrameHeader
+    {
+        /**
+         * The temporal layering properties of the frame, or <tt>null</tt>.
+         */
+        private final TemporalLayering.FrameInfo frameInfo;
+
+        /**
+         * The PictureID of the frame.
+         */
+        private final int pictureId;
+
+        /**
+         * Initializes a new <tt>FrameHeader</tt> instance.
+         *
+         * @param pictureId the PictureID of the frame.
+         * @param frameInfo the temporal layering properties of the frame, or
+         * <tt>null</tt>.
+         */
+        public FrameHeader(int pictureId, TemporalLayering.FrameInfo frameInfo)
+        {
+            this.pictureId = pictureId;
+            this.frameInfo = frameInfo;
+        }
+
+        /**
+         * Gets the temporal layering properties of the frame.
+         *
+         * @return the temporal layering properties of the frame, or
+         * <tt>null</tt>.
+         */
+        public TemporalLayering.FrameInfo getFrameInfo()
+        {
+            return frameInfo;
+        }
+
+        /**
+         * Gets the PictureID of the frame.
+         *
+         * @return the PictureID of the frame.
+         */
+        public int getPictureId()
+        {
+            return pictureId;
+        }
+    }
+
+    /**
+     * Describes the RTP payloads of a frame which the encoder has packetized
+     * natively with
+     * {@link VPX#codec_get_cx_data_packetized(long, byte[], int, int, byte[], int, int, long[])}.
+     * Set as the header of the <tt>Buffer</tt> holding the payloads.
+     */
+    public static class PacketizedFrame
+    {
+        /**
+         * The number of payloads.
+         */
+        private final int count;
+
+        /**
+         * The payload table, {@link VPX#CX_PKT_INFO_LENGTH} elements per
+         * payload.
+         */
+        private final long[] info;
+
+        /**
+         * Initializes a new <tt>PacketizedFrame</tt> instance.
+         *
+         * @param info the payload table filled in by
+         * <tt>codec_get_cx_data_packetized</tt>.
+         * @param count the number of payloads.
+         */
+        public PacketizedFrame(long[] info, int count)
+        {
+            this.info = info;
+            this.count = count;
+        }
+
+        /**
+         * Gets the number of payloads.
+         *
+         * @return the number of payloads.
+         */
+        public int getCount()
+        {
+            return count;
+        }
+
+        /**
+         * Gets the length of a payload, including its payload descriptor.
+         *
+         * @param i the index of the payload.
+         * @return the length of the payload.
+         */
+        public int getLength(int i)
+        {
+            return (int) info[i * VPX.CX_PKT_INFO_LENGTH + 1];
+        }
+
+        /**
+         * Gets the offset of a payload in the data of the <tt>Buffer</tt>.
+         *
+         * @param i the index of the payload.
+         * @return the offset of the payload.
+         */
+        public int getOffset(int i)
+        {
+            return (int) info[i * VPX.CX_PKT_INFO_LENGTH];
+        }
+
+        /**
+         * Gets whether a payload is the last one of a frame.
+         *
+         * @param i the index of the payload.
+         * @return <tt>true</tt> if the payload is the last one of a frame.
+         */
+        public boolean isEndOfFrame(int i)
+        {
+            return
+                (info[i * VPX.CX_PKT_INFO_LENGTH + 2]
+                        & VPX.PAYLOAD_END_OF_FRAME)
+                    != 0;
+        }
+    }
 }
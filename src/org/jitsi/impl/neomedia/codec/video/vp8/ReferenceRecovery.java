@@ -0,0 +1,327 @@
+/*
+ * Copyright @ 2015 Atlassian Pty Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.jitsi.impl.neomedia.codec.video.vp8;
+
+import java.util.*;
+
+import org.jitsi.impl.neomedia.codec.video.*;
+
+/**
+ * Recovers a VP8 stream from loss with a frame predicted from a long-term
+ * reference which the receiver has acknowledged, instead of with a keyframe.
+ *
+ * The golden frame buffer (and the alt-ref frame buffer, when it is not used
+ * for temporal scalability) is refreshed periodically with a base layer
+ * frame and is otherwise left untouched, so that it keeps a frame which the
+ * receiver may have decoded. Once the receiver acknowledges that frame, a
+ * request for recovery is served by a frame which references that buffer
+ * only. A keyframe is forced if there is no acknowledged reference. When two
+ * buffers are available, they are refreshed in turn so that one of them
+ * holds an acknowledged reference while the other waits for its
+ * acknowledgement.
+ *
+ * Frames are identified by their PictureID, which the receiver acknowledges
+ * them with in RTCP RPSI messages.
+ *
+ * @author agent
+ */
+public class ReferenceRecovery
+{
+    /**
+     * The default number of frames between two refreshes of a long-term
+     * reference.
+     */
+    public static final int DEFAULT_REFRESH_INTERVAL = 30;
+
+    /**
+     * The flags which force the update of each reference buffer.
+     */
+    private static final int[] FORCE_UPDATE
+        = { VPX.EFLAG_FORCE_GF, VPX.EFLAG_FORCE_ARF };
+
+    /**
+     * The flags which prevent a frame from referencing each reference buffer.
+     */
+    private static final int[] NO_REFERENCE
+        = { VPX.EFLAG_NO_REF_GF, VPX.EFLAG_NO_REF_ARF };
+
+    /**
+     * The flags which prevent a frame from updating each reference buffer.
+     */
+    private static final int[] NO_UPDATE
+        = { VPX.EFLAG_NO_UPD_GF, VPX.EFLAG_NO_UPD_ARF };
+
+    /**
+     * Whether each reference buffer holds a frame which the receiver has
+     * acknowledged.
+     */
+    private final boolean[] acknowledged;
+
+    /**
+     * The index of the frame which each reference buffer holds, used to
+     * find the most recent acknowledged reference, or <tt>-1</tt> if it is
+     * unknown.
+     */
+    private final long[] frameIndices;
+
+    /**
+     * The index of the next frame to be encoded.
+     */
+    private long frameIndex = 0;
+
+    /**
+     * The number of frames encoded since the last refresh.
+     */
+    private int framesSinceRefresh = 0;
+
+    /**
+     * The reference buffer which the frame last passed to
+     * {@link #getFlags(int, int, int)} refreshes, or <tt>-1</tt>.
+     */
+    private int pendingRefresh = -1;
+
+    /**
+     * Whether the frame last passed to {@link #getFlags(int, int, int)} is a
+     * recovery frame.
+     */
+    private boolean pendingRecovery = false;
+
+    /**
+     * The PictureID of the frame last passed to
+     * {@link #getFlags(int, int, int)}.
+     */
+    private int pendingPictureId;
+
+    /**
+     * Whether the next frame is to recover from loss.
+     */
+    private boolean recoveryRequested = false;
+
+    /**
+     * The number of frames between two refreshes of a long-term reference.
+     */
+    private final int refreshInterval;
+
+    /**
+     * The PictureID of the frame which each reference buffer holds.
+     */
+    private final int[] pictureIds;
+
+    /**
+     * Initializes a new <tt>ReferenceRecovery</tt> instance.
+     *
+     * @param useAltRef whether the alt-ref frame buffer can hold a long-term
+     * reference in addition to the golden frame buffer, i.e. whether it is
+     * not used for temporal scalability.
+     * @param refreshInterval the number of frames between two refreshes of a
+     * long-term reference.
+     */
+    public ReferenceRecovery(boolean useAltRef, int refreshInterval)
+    {
+        int buffers = useAltRef ? 2 : 1;
+
+        acknowledged = new boolean[buffers];
+        frameIndices = new long[buffers];
+        pictureIds = new int[buffers];
+        Arrays.fill(frameIndices, -1);
+        this.refreshInterval = Math.max(1, refreshInterval);
+    }
+
+    /**
+     * Notifies this instance that the receiver has decoded a specific frame.
+     *
+     * @param pictureId the PictureID of the frame.
+     * @return <tt>true</tt> if the frame is held in a reference buffer and can
+     * now be used for recovery, <tt>false</tt> otherwise.
+     */
+    public synchronized boolean acknowledge(int pictureId)
+    {
+        boolean found = false;
+
+        for (int i = 0; i < pictureIds.length; i++)
+        {
+            if (frameIndices[i] >= 0 && pictureIds[i] == pictureId)
+            {
+                acknowledged[i] = true;
+                found = true;
+            }
+        }
+        return found;
+    }
+
+    /**
+     * Notifies this instance of the outcome of encoding the frame last passed
+     * to {@link #getFlags(int, int, int)}.
+     *
+     * @param encoded whether the encoder produced the frame, as opposed to
+     * dropping it or failing.
+     * @param keyframe whether the frame is a keyframe, which updates all
+     * reference buffers.
+     */
+    public synchronized void frameEncoded(boolean encoded, boolean keyframe)
+    {
+        if (encoded)
+        {
+            if (keyframe)
+            {
+                for (int i = 0; i < pictureIds.length; i++)
+                    setReference(i);
+                framesSinceRefresh = 0;
+                recoveryRequested = false;
+            }
+            else
+            {
+                if (pendingRefresh >= 0)
+                {
+                    setReference(pendingRefresh);
+                    framesSinceRefresh = 0;
+                }
+                if (pendingRecovery)
+                    recoveryRequested = false;
+            }
+            framesSinceRefresh++;
+            frameIndex++;
+        }
+        pendingRefresh = -1;
+        pendingRecovery = false;
+    }
+
+    /**
+     * Gets the most recent acknowledged reference buffer.
+     *
+     * @return the index of the most recent acknowledged reference buffer, or
+     * <tt>-1</tt> if there is none.
+     */
+    private int getAcknowledgedReference()
+    {
+        int reference = -1;
+
+        for (int i = 0; i < acknowledged.length; i++)
+        {
+            if (acknowledged[i]
+                    && (reference < 0
+                        || frameIndices[i] > frameIndices[reference]))
+                reference = i;
+        }
+        return reference;
+    }
+
+    /**
+     * Gets the encoder flags of the next frame, i.e. amends the flags which
+     * the frame would have been encoded with so that the frame refreshes a
+     * long-term reference, recovers from loss, or leaves the long-term
+     * references untouched.
+     *
+     * @param flags the flags which the frame would have been encoded with.
+     * @param temporalLayerId the temporal layer of the frame. Only base layer
+     * frames refresh a long-term reference.
+     * @param pictureId the PictureID of the frame.
+     * @return the flags to encode the frame with.
+     */
+    public synchronized int getFlags(
+            int flags,
+            int temporalLayerId,
+            int pictureId)
+    {
+        pendingPictureId = pictureId;
+        pendingRefresh = -1;
+        pendingRecovery = false;
+
+        if (recoveryRequested)
+        {
+            int reference = getAcknowledgedReference();
+
+            if (reference < 0)
+                return flags | VPX.EFLAG_FORCE_KF;
+
+            // Predict from the acknowledged reference only, and update the
+            // last frame buffer so that the following frames are predicted
+            // from this one.
+            pendingRecovery = true;
+            flags = VPX.EFLAG_NO_REF_LAST;
+            for (int i = 0; i < NO_REFERENCE.length; i++)
+            {
+                if (i != reference)
+                    flags |= NO_REFERENCE[i];
+                flags |= NO_UPDATE[i];
+            }
+            return flags;
+        }
+
+        for (int i = 0; i < pictureIds.length; i++)
+            flags |= NO_UPDATE[i];
+
+        if (temporalLayerId == 0 && framesSinceRefresh >= refreshInterval)
+        {
+            // Refresh the buffer which does not hold the most recent
+            // acknowledged reference.
+            int reference = getAcknowledgedReference();
+            int refresh;
+
+            if (reference < 0)
+            {
+                refresh = 0;
+                for (int i = 1; i < frameIndices.length; i++)
+                {
+                    if (frameIndices[i] < frameIndices[refresh])
+                        refresh = i;
+                }
+            }
+            else
+            {
+                refresh = (reference + 1) % pictureIds.length;
+            }
+
+            pendingRefresh = refresh;
+            flags &= ~NO_UPDATE[refresh];
+            flags |= FORCE_UPDATE[refresh];
+        }
+        return flags;
+    }
+
+    /**
+     * Determines whether the next frame is to recover from loss.
+     *
+     * @return <tt>true</tt> if the next frame is to recover from loss.
+     */
+    public synchronized boolean isRecoveryRequested()
+    {
+        return recoveryRequested;
+    }
+
+    /**
+     * Requests that the next frame recovers from loss, from an acknowledged
+     * long-term reference if there is one, or else as a keyframe.
+     */
+    public synchronized void requestRecovery()
+    {
+        recoveryRequested = true;
+    }
+
+    /**
+     * Records that the frame last passed to {@link #getFlags(int, int, int)}
+     * is now held in a specific reference buffer, which the receiver has yet
+     * to acknowledge.
+     *
+     * @param i the index of the reference buffer.
+     */
+    private void setReference(int i)
+    {
+        acknowledged[i] = false;
+        frameIndices[i] = frameIndex;
+        pictureIds[i] = pendingPictureId;
+    }
+}
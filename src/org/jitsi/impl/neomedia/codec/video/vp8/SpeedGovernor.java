@@ -0,0 +1,167 @@
+/*
+ * Copyright @ 2015 Atlassian Pty Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.jitsi.impl.neomedia.codec.video.vp8;
+
+/**
+ * Adapts the speed (<tt>cpu-used</tt>) of a VP8 encoder to the time it takes
+ * to encode a frame. The speed is raised when the average encode time gets
+ * close to the time budget of a frame, and lowered again (but not below the
+ * initial speed) when there is plenty of headroom.
+ *
+ * @author agent
+ */
+public class SpeedGovernor
+{
+    /**
+     * The lowest speed to select when none is configured. It is the default
+     * speed of the VP8 encoder of libvpx built with
+     * <tt>--enable-realtime-only</tt>.
+     */
+    public static final int DEFAULT_MIN_SPEED = 4;
+
+    /**
+     * The fraction of the frame budget above which the speed is raised.
+     */
+    private static final double HIGH_WATERMARK = 0.85;
+
+    /**
+     * The number of frames to wait after a speed change before considering
+     * another one, so that the average reflects the new speed.
+     */
+    private static final int HOLD_FRAMES = 30;
+
+    /**
+     * The fraction of the frame budget below which the speed is lowered.
+     */
+    private static final double LOW_WATERMARK = 0.4;
+
+    /**
+     * The maximum speed of the VP8 encoder.
+     */
+    public static final int MAX_SPEED = 16;
+
+    /**
+     * The weight of a new sample in the moving average of the encode time.
+     */
+    private static final double SMOOTHING = 0.1;
+
+    /**
+     * The moving average of the encode time in nanoseconds, or <tt>-1</tt> if
+     * no sample has been taken since the last speed change.
+     */
+    private double averageNanos = -1;
+
+    /**
+     * The time budget of a frame in nanoseconds.
+     */
+    private long budgetNanos;
+
+    /**
+     * The number of frames encoded since the last speed change.
+     */
+    private int framesSinceChange = 0;
+
+    /**
+     * The lowest speed this governor will select.
+     */
+    private final int minSpeed;
+
+    /**
+     * The currently selected speed.
+     */
+    private int speed;
+
+    /**
+     * Initializes a new <tt>SpeedGovernor</tt> instance.
+     *
+     * @param minSpeed the initial and lowest speed to select, between
+     * <tt>1</tt> and {@link #MAX_SPEED}.
+     * @param frameRate the frame rate which determines the time budget of a
+     * frame.
+     */
+    public SpeedGovernor(int minSpeed, float frameRate)
+    {
+        this.minSpeed = Math.max(1, Math.min(minSpeed, MAX_SPEED));
+        speed = this.minSpeed;
+        setFrameRate(frameRate);
+    }
+
+    /**
+     * Gets the value of the <tt>cpu-used</tt> control which selects the
+     * current speed in realtime mode.
+     *
+     * @return the value of the <tt>cpu-used</tt> control which selects the
+     * current speed.
+     */
+    public int getCpuUsed()
+    {
+        return -speed;
+    }
+
+    /**
+     * Gets the currently selected speed.
+     *
+     * @return the currently selected speed.
+     */
+    public int getSpeed()
+    {
+        return speed;
+    }
+
+    /**
+     * Sets the frame rate which determines the time budget of a frame.
+     *
+     * @param frameRate the frame rate. Non-positive values are ignored.
+     */
+    public void setFrameRate(float frameRate)
+    {
+        if (frameRate > 0)
+            budgetNanos = (long) (1000000000L / frameRate);
+    }
+
+    /**
+     * Records the time it took to encode a frame and updates the speed.
+     *
+     * @param encodeNanos the time in nanoseconds it took to encode a frame.
+     * @return <tt>true</tt> if the speed has changed and has to be applied to
+     * the encoder, <tt>false</tt> otherwise.
+     */
+    public boolean update(long encodeNanos)
+    {
+        if (averageNanos < 0)
+            averageNanos = encodeNanos;
+        else
+            averageNanos += SMOOTHING * (encodeNanos - averageNanos);
+
+        if (++framesSinceChange < HOLD_FRAMES)
+            return false;
+
+        int newSpeed = speed;
+
+        if (averageNanos > HIGH_WATERMARK * budgetNanos)
+            newSpeed = Math.min(speed + 1, MAX_SPEED);
+        else if (averageNanos < LOW_WATERMARK * budgetNanos)
+            newSpeed = Math.max(speed - 1, minSpeed);
+
+        if (newSpeed == speed)
+            return false;
+
+        speed = newSpeed;
+        framesSinceChange = 0;
+        averageNanos = -1;
+        return true;
+    }
+}
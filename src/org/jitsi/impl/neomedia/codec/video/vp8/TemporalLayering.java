@@ -0,0 +1,389 @@
+/*
+ * Copyright @ 2015 Atlassian Pty Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.jitsi.impl.neomedia.codec.video.vp8;
+
+import org.jitsi.impl.neomedia.codec.video.*;
+
+/**
+ * Describes a VP8 temporal scalability structure, i.e. the temporal layer
+ * and the reference buffer flags of each frame of a repeating pattern, and
+ * keeps track of the position in the pattern and of the TL0PICIDX of the
+ * frames fed to the encoder.
+ *
+ * The base layer (TL0) only references and updates the last frame buffer.
+ * Higher layers never update the last frame buffer, so any of them can be
+ * dropped (e.g. by a forwarding middlebox) without breaking the decoding of
+ * the layers below. Every higher layer has a layer sync point (a frame which
+ * references the last frame only) in each period of the pattern, so that a
+ * receiver which has dropped the layer can decode it again from there.
+ *
+ * @author agent
+ */
+public class TemporalLayering
+{
+    /**
+     * The encoder flags of a base layer (TL0) frame: reference and update the
+     * last frame only.
+     */
+    private static final int TL0_FLAGS
+        = VPX.EFLAG_NO_REF_GF
+            | VPX.EFLAG_NO_REF_ARF
+            | VPX.EFLAG_NO_UPD_GF
+            | VPX.EFLAG_NO_UPD_ARF;
+
+    /**
+     * The encoder flags of the TL1 frames of a two-layer structure: reference
+     * the last frame, update nothing.
+     */
+    private static final int TL1_OF_2_FLAGS
+        = VPX.EFLAG_NO_REF_GF
+            | VPX.EFLAG_NO_REF_ARF
+            | VPX.EFLAG_NO_UPD_LAST
+            | VPX.EFLAG_NO_UPD_GF
+            | VPX.EFLAG_NO_UPD_ARF
+            | VPX.EFLAG_NO_UPD_ENTROPY;
+
+    /**
+     * The encoder flags of the TL1 frames of a three-layer structure:
+     * reference the last frame and update the alt-ref frame, which is then
+     * referenced by TL2.
+     */
+    private static final int TL1_OF_3_FLAGS
+        = VPX.EFLAG_NO_REF_GF
+            | VPX.EFLAG_NO_REF_ARF
+            | VPX.EFLAG_NO_UPD_LAST
+            | VPX.EFLAG_NO_UPD_GF
+            | VPX.EFLAG_NO_UPD_ENTROPY;
+
+    /**
+     * The encoder flags of the first TL2 frame of each period of a
+     * three-layer structure: reference the last frame only, i.e. be a layer
+     * sync point, update nothing.
+     */
+    private static final int TL2_SYNC_OF_3_FLAGS
+        = VPX.EFLAG_NO_REF_GF
+            | VPX.EFLAG_NO_REF_ARF
+            | VPX.EFLAG_NO_UPD_LAST
+            | VPX.EFLAG_NO_UPD_GF
+            | VPX.EFLAG_NO_UPD_ARF
+            | VPX.EFLAG_NO_UPD_ENTROPY;
+
+    /**
+     * The encoder flags of the other TL2 frames of a three-layer structure:
+     * reference the last and alt-ref frames, update nothing.
+     */
+    private static final int TL2_OF_3_FLAGS
+        = VPX.EFLAG_NO_REF_GF
+            | VPX.EFLAG_NO_UPD_LAST
+            | VPX.EFLAG_NO_UPD_GF
+            | VPX.EFLAG_NO_UPD_ARF
+            | VPX.EFLAG_NO_UPD_ENTROPY;
+
+    /**
+     * Initializes a new <tt>TemporalLayering</tt> instance for a specific
+     * number of temporal layers.
+     *
+     * @param numberOfLayers the number of temporal layers.
+     * @return a new <tt>TemporalLayering</tt> instance, or <tt>null</tt> if
+     * <tt>numberOfLayers</tt> is not greater than 1 or is not supported.
+     */
+    public static TemporalLayering create(int numberOfLayers)
+    {
+        switch (numberOfLayers)
+        {
+        case 2:
+            return
+                new TemporalLayering(
+                        new int[] { 0, 1 },
+                        new int[] { TL0_FLAGS, TL1_OF_2_FLAGS },
+                        new boolean[] { false, true },
+                        new int[] { 2, 1 },
+                        new int[] { 60, 100 });
+        case 3:
+            return
+                new TemporalLayering(
+                        new int[] { 0, 2, 1, 2 },
+                        new int[]
+                            {
+                                TL0_FLAGS,
+                                TL2_SYNC_OF_3_FLAGS,
+                                TL1_OF_3_FLAGS,
+                                TL2_OF_3_FLAGS
+                            },
+                        new boolean[] { false, true, true, false },
+                        new int[] { 4, 2, 1 },
+                        new int[] { 40, 60, 100 });
+        default:
+            return null;
+        }
+    }
+
+    /**
+     * The cumulative share (in percent) of the target bitrate of layers
+     * <tt>0</tt> to <tt>i</tt>.
+     */
+    private final int[] bitrateShares;
+
+    /**
+     * The encoder flags of each frame of the pattern.
+     */
+    private final int[] flags;
+
+    /**
+     * The index in the pattern of the next frame.
+     */
+    private int index = 0;
+
+    /**
+     * The temporal layer id of each frame of the pattern.
+     */
+    private final int[] layerIds;
+
+    /**
+     * Whether each frame of the pattern is a layer sync point, i.e. depends
+     * only on base layer frames.
+     */
+    private final boolean[] layerSync;
+
+    /**
+     * The factor by which the frame rate of layers <tt>0</tt> to <tt>i</tt>
+     * is lower than the input frame rate.
+     */
+    private final int[] rateDecimators;
+
+    /**
+     * The TL0PICIDX of the last base layer frame, or <tt>-1</tt> if no frame
+     * has been produced yet.
+     */
+    private int tl0PicIdx = -1;
+
+    /**
+     * Initializes a new <tt>TemporalLayering</tt> instance.
+     *
+     * @param layerIds the temporal layer id of each frame of the pattern.
+     * @param flags the encoder flags of each frame of the pattern.
+     * @param layerSync whether each frame of the pattern is a layer sync
+     * point.
+     * @param rateDecimators the rate decimator of each layer.
+     * @param bitrateShares the cumulative bitrate share of each layer.
+     */
+    private TemporalLayering(
+            int[] layerIds,
+            int[] flags,
+            boolean[] layerSync,
+            int[] rateDecimators,
+            int[] bitrateShares)
+    {
+        this.layerIds = layerIds;
+        this.flags = flags;
+        this.layerSync = layerSync;
+        this.rateDecimators = rateDecimators;
+        this.bitrateShares = bitrateShares;
+    }
+
+    /**
+     * Sets the temporal scalability fields of a <tt>vpx_codec_enc_cfg_t</tt>
+     * according to this structure.
+     *
+     * @param cfg pointer to a <tt>vpx_codec_enc_cfg_t</tt>.
+     * @param bitrate the total target bitrate in kbps.
+     */
+    public void configure(long cfg, int bitrate)
+    {
+        int[] targetBitrates = new int[bitrateShares.length];
+
+        for (int i = 0; i < targetBitrates.length; i++)
+            targetBitrates[i] = bitrate * bitrateShares[i] / 100;
+
+        VPX.codec_enc_cfg_set_ts_number_layers(cfg, getNumberOfLayers());
+        VPX.codec_enc_cfg_set_ts_periodicity(cfg, layerIds.length);
+        VPX.codec_enc_cfg_set_ts_layer_id(cfg, layerIds);
+        VPX.codec_enc_cfg_set_ts_rate_decimator(cfg, rateDecimators);
+        VPX.codec_enc_cfg_set_ts_target_bitrate(cfg, targetBitrates);
+    }
+
+    /**
+     * Gets the number of temporal layers of this structure.
+     *
+     * @return the number of temporal layers of this structure.
+     */
+    public int getNumberOfLayers()
+    {
+        return rateDecimators.length;
+    }
+
+    /**
+     * Determines whether this structure uses the alt-ref frame buffer, i.e.
+     * whether any frame of the pattern updates it.
+     *
+     * @return <tt>true</tt> if this structure uses the alt-ref frame buffer.
+     */
+    public boolean usesAltRef()
+    {
+        for (int f : flags)
+        {
+            if ((f & VPX.EFLAG_NO_UPD_ARF) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    /**
+     * Advances to the next frame of the pattern.
+     *
+     * @param keyframe whether the next frame is going to be a keyframe, in
+     * which case the pattern is restarted so that the keyframe is in the base
+     * layer.
+     * @return the <tt>FrameInfo</tt> describing the next frame.
+     */
+    public FrameInfo next(boolean keyframe)
+    {
+        if (keyframe)
+            index = 0;
+
+        int i = index;
+        int tid = layerIds[i];
+
+        index = (i + 1) % layerIds.length;
+        if (tid == 0)
+            tl0PicIdx = (tl0PicIdx + 1) & 0xff;
+
+        return
+            new FrameInfo(
+                    tid,
+                    tl0PicIdx < 0 ? 0 : tl0PicIdx,
+                    layerSync[i],
+                    flags[i]);
+    }
+
+    /**
+     * Restarts the pattern, e.g. after the encoder has been re-initialized
+     * and is going to produce a keyframe. The TL0PICIDX keeps increasing.
+     */
+    public void reset()
+    {
+        index = 0;
+    }
+
+    /**
+     * Describes the temporal layering properties of an encoded frame. The
+     * encoder attaches it to the output <tt>Buffer</tt> in a
+     * {@link Packetizer.FrameHeader} so that the <tt>Packetizer</tt> can
+     * signal it in the payload descriptor.
+     */
+    public static class FrameInfo
+    {
+        /**
+         * The encoder flags to use for the frame.
+         */
+        private final int flags;
+
+        /**
+         * Whether the frame is a layer sync point.
+         */
+        private final boolean layerSync;
+
+        /**
+         * The temporal layer id of the frame.
+         */
+        private final int temporalLayerId;
+
+        /**
+         * The TL0PICIDX of the frame.
+         */
+        private final int tl0PicIdx;
+
+        /**
+         * Initializes a new <tt>FrameInfo</tt> instance.
+         *
+         * @param temporalLayerId the temporal layer id of the frame.
+         * @param tl0PicIdx the TL0PICIDX of the frame.
+         * @param layerSync whether the frame is a layer sync point.
+         * @param flags the encoder flags to use for the frame.
+         */
+        public FrameInfo(
+                int temporalLayerId,
+                int tl0PicIdx,
+                boolean layerSync,
+                int flags)
+        {
+            this.temporalLayerId = temporalLayerId;
+            this.tl0PicIdx = tl0PicIdx;
+            this.layerSync = layerSync;
+            this.flags = flags;
+        }
+
+        /**
+         * Gets the encoder flags to use for the frame.
+         *
+         * @return the encoder flags to use for the frame.
+         */
+        public int getFlags()
+        {
+            return flags;
+        }
+
+        /**
+         * Gets the temporal layer id of the frame.
+         *
+         * @return the temporal layer id of the frame.
+         */
+        public int getTemporalLayerId()
+        {
+            return temporalLayerId;
+        }
+
+        /**
+         * Gets the TL0PICIDX of the frame, i.e. the index of the last base
+         * layer frame up to and including this one.
+         *
+         * @return the TL0PICIDX of the frame.
+         */
+        public int getTL0PicIdx()
+        {
+            return tl0PicIdx;
+        }
+
+        /**
+         * Gets whether the frame is a layer sync point, i.e. depends only on
+         * base layer frames.
+         *
+         * @return <tt>true</tt> if the frame is a layer sync point.
+         */
+        public boolean isLayerSync()
+        {
+            return layerSync;
+        }
+
+        /**
+         * Gets whether the frame updates any reference frame buffer, i.e.
+         * whether it may be referenced by subsequent frames. Frames which are
+         * not are signalled with the N bit of the payload descriptor.
+         *
+         * @return <tt>true</tt> if the frame may be referenced by subsequent
+         * frames.
+         */
+        public boolean isReference()
+        {
+            int noUpdate
+                = VPX.EFLAG_NO_UPD_LAST
+                    | VPX.EFLAG_NO_UPD_GF
+                    | VPX.EFLAG_NO_UPD_ARF;
+
+            return (flags & noUpdate) != noUpdate;
+        }
+    }
+}
@@ -22,7 +22,10 @@
 
 import org.jitsi.impl.neomedia.codec.*;
 import org.jitsi.impl.neomedia.codec.video.*;
+import org.jitsi.service.configuration.*;
+import org.jitsi.service.libjitsi.*;
 import org.jitsi.service.neomedia.codec.*;
+import org.jitsi.service.neomedia.control.*;
 import org.jitsi.utils.logging.*;
 
 /**
@@ -33,11 +36,68 @@
 public class VPXDecoder
     extends AbstractCodec2
 {
+    /**
+     * The decode mode in which all frames are decoded.
+     */
+    public static final int DECODE_ALL = 0;
+
+    /**
+     * The decode mode in which only keyframes and frames of the base temporal
+     * layer (TID 0) are decoded, and non-reference frames are skipped.
+     * Streams without temporal layers are decoded as with
+     * {@link #DECODE_REFERENCE}.
+     */
+    public static final int DECODE_BASE_LAYER = 2;
+
+    /**
+     * The decode mode in which only keyframes are decoded.
+     */
+    public static final int DECODE_KEYFRAMES = 3;
+
+    /**
+     * The name of the integer <tt>ConfigurationService</tt> property which
+     * specifies the initial decode mode, one of {@link #DECODE_ALL},
+     * {@link #DECODE_REFERENCE}, {@link #DECODE_BASE_LAYER} and
+     * {@link #DECODE_KEYFRAMES}. The default value is {@link #DECODE_ALL}.
+     */
+    public static final String DECODE_MODE_PNAME
+        = "org.jitsi.impl.neomedia.codec.video.vp8.decodeMode";
+
+    /**
+     * The decode mode in which frames signalled as non-reference frames are
+     * skipped.
+     */
+    public static final int DECODE_REFERENCE = 1;
+
+    /**
+     * The name of the boolean <tt>ConfigurationService</tt> property which
+     * specifies whether the decoder is to conceal errors in frames which are
+     * missing partitions, instead of such frames being dropped. Requires
+     * libvpx to be built with <tt>--enable-error-concealment</tt>. The default
+     * value is <tt>false</tt>.
+     */
+    public static final String ERROR_CONCEALMENT_PNAME
+        = "org.jitsi.impl.neomedia.codec.video.vp8.errorConcealment";
+
     /**
      * The decoder interface to use
      */
     private static final int INTERFACE = VPX.INTEFACE_VP8_DEC;
 
+    /**
+     * The minimum interval in milliseconds between two keyframe requests
+     * while waiting for a keyframe, so that a lost request is repeated
+     * without flooding the sender.
+     */
+    private static final long KEY_FRAME_REQUEST_INTERVAL = 1000;
+
+    /**
+     * The time in milliseconds to wait for a layer sync point of a higher
+     * temporal layer before a keyframe is requested instead, e.g. if the
+     * remote peer does not signal any.
+     */
+    private static final long LAYER_SYNC_TIMEOUT = 1000;
+
     /**
      * The <tt>Logger</tt> used by the <tt>VPXDecoder</tt> class
      * for logging output.
@@ -62,6 +122,25 @@
      */
     private long context = 0;
 
+    /**
+     * The decode mode, one of {@link #DECODE_ALL}, {@link #DECODE_REFERENCE},
+     * {@link #DECODE_BASE_LAYER} and {@link #DECODE_KEYFRAMES}.
+     */
+    private int decodeMode = DECODE_ALL;
+
+    /**
+     * Whether the decoder context was initialized with
+     * {@link VPX#CODEC_USE_INPUT_FRAGMENTS} and
+     * {@link VPX#CODEC_USE_ERROR_CONCEALMENT}.
+     */
+    private boolean errorConcealment = false;
+
+    /**
+     * The fragment sizes passed to the decoder for frames which do not carry
+     * {@link DePacketizer.FrameFragments}.
+     */
+    private final int[] fragmentSizes = new int[1];
+
     /**
      * The last known width of the video output by this
      * <tt>VPXDecoder</tt>. Used to detect changes in the output size.
@@ -81,12 +160,55 @@
      */
     private long[] iter = new long[1];
 
+    /**
+     * The <tt>KeyFrameControl</tt> through which this decoder requests
+     * keyframes from the remote peer, or <tt>null</tt>.
+     */
+    private KeyFrameControl keyFrameControl;
+
+    /**
+     * The time in milliseconds of the last keyframe request since the last
+     * keyframe, or <tt>-1</tt> if no keyframe has been requested since.
+     */
+    private long lastKeyFrameRequestTime = -1;
+
+    /**
+     * The time in milliseconds since when frames of a higher temporal layer
+     * have been skipped while waiting for a layer sync point, or <tt>-1</tt>.
+     */
+    private long layerSyncWaitStartTime = -1;
+
     /**
      * Whether there are unprocessed frames left from a previous call to
      * VP8.codec_decode()
      */
     private boolean leftoverFrames = false;
 
+    /**
+     * The highest temporal layer index (TID) up to which the frames
+     * referenced by subsequent frames have been decoded. Lowered when frames
+     * of higher layers are skipped and raised at layer sync points.
+     */
+    private int maxTemporalLayerId = Integer.MAX_VALUE;
+
+    /**
+     * The maximum size of the output, or <tt>null</tt> to output frames at
+     * their decoded size.
+     */
+    private Dimension maxOutputSize = null;
+
+    /**
+     * Whether all frames referenced by subsequent frames have been decoded,
+     * i.e. no keyframe has to be waited for.
+     */
+    private boolean referencesValid = true;
+
+    /**
+     * Pointer to a native vpx_image structure allocated to hold the frames
+     * downscaled to {@link #maxOutputSize}, or 0.
+     */
+    private long scaledImg = 0;
+
     /**
      * The last known height of the video output by this
      * <tt>VPXDecoder</tt>. Used to detect changes in the output size.
@@ -121,6 +243,11 @@ protected void doClose()
         }
         if(cfg != 0)
             VPX.free(cfg);
+        if (scaledImg != 0)
+        {
+            VPX.img_free(scaledImg);
+            scaledImg = 0;
+        }
     }
 
     /**
@@ -134,8 +261,36 @@ protected void doOpen() throws ResourceUnavailableException
         context = VPX.codec_ctx_malloc();
         //cfg = VPX.codec_dec_cfg_malloc();
         long flags = 0; //VPX.CODEC_USE_XMA;
+        ConfigurationService cfg = LibJitsi.getConfigurationService();
 
-        int ret = VPX.codec_dec_init(context, INTERFACE, 0, flags);
+        errorConcealment
+            = cfg != null && cfg.getBoolean(ERROR_CONCEALMENT_PNAME, false);
+        if (cfg != null)
+            setDecodeMode(cfg.getInt(DECODE_MODE_PNAME, DECODE_ALL));
+        if (errorConcealment)
+        {
+            int ret
+                = VPX.codec_dec_init(
+                        context,
+                        INTERFACE,
+                        0,
+                        flags
+                            | VPX.CODEC_USE_ERROR_CONCEALMENT
+                            | VPX.CODEC_USE_INPUT_FRAGMENTS);
+
+            if (ret != VPX.CODEC_OK)
+            {
+                // libvpx was likely built without error concealment.
+                logger.warn("Failed to enable error concealment, libvpx"
+                        + " error: " + VPX.codec_err_to_string(ret));
+                errorConcealment = false;
+            }
+        }
+
+        int ret
+            = errorConcealment
+                ? VPX.CODEC_OK
+                : VPX.codec_dec_init(context, INTERFACE, 0, flags);
         if(ret != VPX.CODEC_OK)
             throw new RuntimeException("Failed to initialize decoder, libvpx"
                     + " error:\n"
@@ -164,14 +319,16 @@ protected int doProcess(Buffer inputBuffer, Buffer outputBuffer)
              * There are more decoded frames available in the context. Fill
              * outputBuffer with the next frame.
              */
+            long outImg = scale(img);
+
             updateOutputFormat(
-                    VPX.img_get_d_w(img),
-                    VPX.img_get_d_h(img),
+                    VPX.img_get_d_w(outImg),
+                    VPX.img_get_d_h(outImg),
                     ((VideoFormat) inputBuffer.getFormat()).getFrameRate());
             outputBuffer.setFormat(outputFormat);
 
 
-            AVFrame avframe = makeAVFrame(img);
+            AVFrame avframe = makeAVFrame(outImg);
             outputBuffer.setData(avframe);
 
             //YUV420p format , 12 bits per pixel
@@ -186,15 +343,76 @@ protected int doProcess(Buffer inputBuffer, Buffer outputBuffer)
              * frame.
              */
 
-            byte[] buf = (byte[])inputBuffer.getData();
+            Object data = inputBuffer.getData();
             int buf_offset = inputBuffer.getOffset();
             int buf_size = inputBuffer.getLength();
+            Object header = inputBuffer.getHeader();
+            int ret;
 
-            int ret = VPX.codec_decode(context,
-                    buf,
+            if (!shouldDecode(
+                    data,
                     buf_offset,
                     buf_size,
-                    0, 0);
+                    (header instanceof DePacketizer.FrameHeader)
+                        ? (DePacketizer.FrameHeader) header
+                        : null))
+            {
+                outputBuffer.setDiscard(true);
+                return BUFFER_PROCESSED_OK;
+            }
+
+            if (data instanceof java.nio.ByteBuffer
+                    && ((java.nio.ByteBuffer) data).isDirect())
+            {
+                // Decode straight from off-heap memory, without a copy.
+                ret = VPX.codec_decode(context,
+                        (java.nio.ByteBuffer) data,
+                        buf_offset,
+                        buf_size,
+                        0, 0);
+                if (errorConcealment)
+                {
+                    int flushRet = VPX.codec_decode_flush(context, 0);
+
+                    if (ret == VPX.CODEC_OK)
+                        ret = flushRet;
+                }
+            }
+            else if (errorConcealment)
+            {
+                DePacketizer.FrameFragments fragments
+                    = (header instanceof DePacketizer.FrameHeader)
+                        ? ((DePacketizer.FrameHeader) header).getFragments()
+                        : null;
+                int[] sizes;
+                int count;
+
+                if (fragments != null)
+                {
+                    sizes = fragments.getSizes();
+                    count = fragments.getCount();
+                }
+                else
+                {
+                    fragmentSizes[0] = buf_size;
+                    sizes = fragmentSizes;
+                    count = 1;
+                }
+                ret = VPX.codec_decode_fragments(context,
+                        (byte[]) data,
+                        buf_offset,
+                        sizes,
+                        count,
+                        0);
+            }
+            else
+            {
+                ret = VPX.codec_decode(context,
+                        (byte[]) data,
+                        buf_offset,
+                        buf_size,
+                        0, 0);
+            }
             if(ret != VPX.CODEC_OK)
             {
                 if(logger.isDebugEnabled())
@@ -204,6 +422,11 @@ protected int doProcess(Buffer inputBuffer, Buffer outputBuffer)
                 return BUFFER_PROCESSED_OK;
             }
 
+            if (errorConcealment
+                    && logger.isDebugEnabled()
+                    && VPX.codec_dec_get_frame_corrupted(context) > 0)
+                logger.debug("Decoded a frame with concealed errors.");
+
             leftoverFrames = false;
             iter[0] = 0;  //decode has just been called, reset iterator
             img = VPX.codec_get_frame(context, iter);
@@ -214,14 +437,16 @@ protected int doProcess(Buffer inputBuffer, Buffer outputBuffer)
                 return BUFFER_PROCESSED_OK;
             }
 
+            long outImg = scale(img);
+
             updateOutputFormat(
-                    VPX.img_get_d_w(img),
-                    VPX.img_get_d_h(img),
+                    VPX.img_get_d_w(outImg),
+                    VPX.img_get_d_h(outImg),
                     ((VideoFormat) inputBuffer.getFormat()).getFrameRate());
             outputBuffer.setFormat(outputFormat);
 
 
-            AVFrame avframe = makeAVFrame(img);
+            AVFrame avframe = makeAVFrame(outImg);
             outputBuffer.setData(avframe);
 
             //YUV420p format , 12 bits per pixel
@@ -300,6 +525,233 @@ private AVFrame makeAVFrame(long img)
         return avframe;
     }
 
+    /**
+     * Downscales a decoded image to fit in {@link #maxOutputSize}, keeping
+     * its aspect ratio.
+     *
+     * @param img pointer to the decoded <tt>vpx_image_t</tt>.
+     * @return pointer to the <tt>vpx_image_t</tt> to output, which is
+     * <tt>img</tt> if no downscaling is necessary.
+     */
+    private long scale(long img)
+    {
+        Dimension maxSize;
+
+        synchronized (this)
+        {
+            maxSize = maxOutputSize;
+        }
+        if (maxSize == null)
+            return img;
+
+        int w = VPX.img_get_d_w(img);
+        int h = VPX.img_get_d_h(img);
+
+        if (w <= maxSize.width && h <= maxSize.height)
+            return img;
+
+        double ratio
+            = Math.min(
+                    (double) maxSize.width / w,
+                    (double) maxSize.height / h);
+        // Keep the chroma planes aligned with the luma plane.
+        int scaledW = Math.max(2, ((int) (w * ratio)) & ~1);
+        int scaledH = Math.max(2, ((int) (h * ratio)) & ~1);
+
+        if (scaledImg != 0
+                && (VPX.img_get_d_w(scaledImg) != scaledW
+                    || VPX.img_get_d_h(scaledImg) != scaledH))
+        {
+            VPX.img_free(scaledImg);
+            scaledImg = 0;
+        }
+        if (scaledImg == 0)
+        {
+            scaledImg
+                = VPX.img_alloc(VPX.IMG_FMT_I420, scaledW, scaledH, 16);
+            if (scaledImg == 0)
+                return img;
+        }
+        return (VPX.img_scale(img, scaledImg) == 0) ? scaledImg : img;
+    }
+
+    /**
+     * Requests a keyframe from the remote peer through the
+     * <tt>KeyFrameControl</tt>, if any, at most once per
+     * {@link #KEY_FRAME_REQUEST_INTERVAL}.
+     */
+    private void requestKeyFrame()
+    {
+        KeyFrameControl keyFrameControl = this.keyFrameControl;
+
+        if (keyFrameControl == null)
+            return;
+
+        long now = System.currentTimeMillis();
+
+        if (lastKeyFrameRequestTime == -1
+                || now - lastKeyFrameRequestTime >= KEY_FRAME_REQUEST_INTERVAL)
+        {
+            lastKeyFrameRequestTime = now;
+            if (logger.isDebugEnabled())
+                logger.debug("Requesting a VP8 keyframe to decode from.");
+            keyFrameControl.requestKeyFrame(true);
+        }
+    }
+
+    /**
+     * Sets the decode mode, which allows to save CPU by skipping frames when
+     * the output is displayed small, e.g. as a thumbnail. Frames of
+     * higher temporal layers and non-keyframes are decoded again after a
+     * switch to a less restrictive mode as soon as their references are
+     * available, i.e. at the next layer sync point or keyframe. A keyframe is
+     * requested through the <tt>KeyFrameControl</tt>, if any, when one is
+     * needed.
+     *
+     * @param decodeMode one of {@link #DECODE_ALL}, {@link #DECODE_REFERENCE},
+     * {@link #DECODE_BASE_LAYER} and {@link #DECODE_KEYFRAMES}.
+     */
+    public synchronized void setDecodeMode(int decodeMode)
+    {
+        if (decodeMode < DECODE_ALL || decodeMode > DECODE_KEYFRAMES)
+            throw new IllegalArgumentException("decodeMode " + decodeMode);
+        this.decodeMode = decodeMode;
+    }
+
+    /**
+     * Sets the <tt>KeyFrameControl</tt> through which this decoder requests a
+     * keyframe when it has to wait for one, e.g. after frames were skipped in
+     * a more restrictive decode mode.
+     *
+     * @param keyFrameControl the <tt>KeyFrameControl</tt> to be used, or
+     * <tt>null</tt>.
+     */
+    public void setKeyFrameControl(KeyFrameControl keyFrameControl)
+    {
+        this.keyFrameControl = keyFrameControl;
+    }
+
+    /**
+     * Sets the maximum size of the decoded frames output by this decoder.
+     * Larger frames are downscaled natively, keeping their aspect ratio.
+     *
+     * @param maxOutputSize the maximum size of the output, or <tt>null</tt> to
+     * output frames at their decoded size.
+     */
+    public synchronized void setMaxOutputSize(Dimension maxOutputSize)
+    {
+        this.maxOutputSize
+            = (maxOutputSize == null) ? null : new Dimension(maxOutputSize);
+    }
+
+    /**
+     * Determines whether a VP8 frame is to be decoded in the current decode
+     * mode, keeping track of which references the skipped frames leave out of
+     * date.
+     *
+     * @param data the <tt>byte[]</tt> or <tt>java.nio.ByteBuffer</tt> holding
+     * the frame.
+     * @param offset the offset of the frame in <tt>data</tt>.
+     * @param length the length of the frame.
+     * @param header the information from the payload descriptors of the
+     * frame, or <tt>null</tt>.
+     * @return <tt>true</tt> if the frame is to be decoded, <tt>false</tt> if it
+     * is to be skipped.
+     */
+    boolean shouldDecode(
+            Object data,
+            int offset,
+            int length,
+            DePacketizer.FrameHeader header)
+    {
+        int decodeMode;
+
+        synchronized (this)
+        {
+            decodeMode = this.decodeMode;
+        }
+
+        if (length < 1)
+            return true;
+
+        // RFC 6386, 9.1: bit 0 of the frame tag is 0 for keyframes.
+        byte firstByte
+            = (data instanceof java.nio.ByteBuffer)
+                ? ((java.nio.ByteBuffer) data).get(offset)
+                : ((byte[]) data)[offset];
+
+        if ((firstByte & 0x01) == 0)
+        {
+            referencesValid = true;
+            maxTemporalLayerId = Integer.MAX_VALUE;
+            lastKeyFrameRequestTime = -1;
+            layerSyncWaitStartTime = -1;
+            return true;
+        }
+        if (decodeMode == DECODE_KEYFRAMES)
+        {
+            referencesValid = false;
+            return false;
+        }
+        if (!referencesValid)
+        {
+            // The frames which are now to be decoded cannot be until the next
+            // keyframe, so do not wait for a periodic one.
+            requestKeyFrame();
+            return false;
+        }
+
+        // Skipping non-reference frames leaves all references intact.
+        if (header != null
+                && !header.isReference()
+                && decodeMode != DECODE_ALL)
+            return false;
+
+        int tid = (header == null) ? -1 : header.getTemporalLayerId();
+
+        if (tid > 0)
+        {
+            if (decodeMode == DECODE_BASE_LAYER)
+            {
+                if (header.isReference())
+                    maxTemporalLayerId = Math.min(maxTemporalLayerId, tid - 1);
+                layerSyncWaitStartTime = -1;
+                return false;
+            }
+            if (tid > maxTemporalLayerId)
+            {
+                // A layer sync point references base layer frames only, so
+                // it can be decoded even if the layers in between cannot yet.
+                if (!header.isLayerSync())
+                {
+                    waitForLayerSync();
+                    return false;
+                }
+                if (tid == maxTemporalLayerId + 1)
+                {
+                    maxTemporalLayerId = tid;
+                    layerSyncWaitStartTime = -1;
+                }
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Notes that a frame of a higher temporal layer has been skipped because
+     * its references are not available, and requests a keyframe if no layer
+     * sync point has made them available within {@link #LAYER_SYNC_TIMEOUT}.
+     */
+    private void waitForLayerSync()
+    {
+        long now = System.currentTimeMillis();
+
+        if (layerSyncWaitStartTime == -1)
+            layerSyncWaitStartTime = now;
+        else if (now - layerSyncWaitStartTime >= LAYER_SYNC_TIMEOUT)
+            requestKeyFrame();
+    }
+
     /**
      * Sets the <tt>Format</tt> of the media data to be input for processing in
      * this <tt>Codec</tt>.
@@ -23,7 +23,11 @@
 import org.jitsi.impl.neomedia.*;
 import org.jitsi.impl.neomedia.codec.*;
 import org.jitsi.impl.neomedia.codec.video.*;
+import org.jitsi.service.configuration.*;
+import org.jitsi.service.libjitsi.*;
 import org.jitsi.service.neomedia.codec.*;
+import org.jitsi.service.neomedia.control.*;
+import org.jitsi.service.neomedia.event.*;
 import org.jitsi.utils.logging.*;
 
 /**
@@ -33,7 +37,84 @@
  */
 public class VPXEncoder
     extends AbstractCodec2
+    implements RTCPFeedbackMessageListener
 {
+    /**
+     * The name of the boolean <tt>ConfigurationService</tt> property which
+     * specifies whether the encoder is to be tuned for screen content and is
+     * to code only the macroblocks which have changed. The changed areas are
+     * given by the input <tt>Buffer</tt>s, which carry an array of
+     * <tt>java.awt.Rectangle</tt>s (the areas which have changed since the
+     * previous frame) as their header. Frames without such a header are coded
+     * entirely. The default value is <tt>false</tt>.
+     *
+     * No capture device of libjitsi sets such a header, and the codecs which
+     * may precede the encoder in a codec chain (e.g. <tt>SwScale</tt>) do not
+     * pass it on, so the property only takes effect with a producer provided
+     * by the application which feeds the encoder YUV420 frames of the encoded
+     * size directly, e.g. a custom <tt>DataSource</tt>. Such a producer has to
+     * give the rectangles in the coordinates of the encoded frames.
+     */
+    public static final String ACTIVE_MAP_PNAME
+        = "org.jitsi.impl.neomedia.codec.video.vp8.activeMap";
+
+    /**
+     * The name of the boolean <tt>ConfigurationService</tt> property which
+     * specifies whether the speed of the encoder is to be raised when encoding
+     * a frame takes close to the time budget of a frame, and lowered again
+     * when there is headroom. The speed configured with
+     * {@link #CPU_USED_PNAME}, or else {@link SpeedGovernor#DEFAULT_MIN_SPEED},
+     * is used as the lowest speed. The default value is <tt>false</tt>.
+     */
+    public static final String ADAPTIVE_SPEED_PNAME
+        = "org.jitsi.impl.neomedia.codec.video.vp8.adaptiveSpeed";
+
+    /**
+     * The name of the integer <tt>ConfigurationService</tt> property which
+     * specifies the value of the libvpx <tt>cpu-used</tt> control, i.e. the
+     * speed/quality trade-off of the encoder. A negative value <tt>-n</tt>
+     * selects a fixed speed <tt>n</tt>. If the property is not set, the
+     * control is left at the default of libvpx.
+     */
+    public static final String CPU_USED_PNAME
+        = "org.jitsi.impl.neomedia.codec.video.vp8.cpuUsed";
+
+    /**
+     * The frame rate to be assumed in the absence of any frame rate indication
+     * in the input format.
+     */
+    private static final int DEFAULT_FRAME_RATE = 30;
+
+    /**
+     * The maximum number of compressed frame packets the encoder produces
+     * for a frame: the first partition and up to eight token partitions when
+     * <tt>CODEC_USE_OUTPUT_PARTITION</tt> is used, a single one otherwise.
+     */
+    private static final int MAX_PACKETS_PER_FRAME = 9;
+
+    /**
+     * The name of the boolean <tt>ConfigurationService</tt> property which
+     * specifies whether the encoder is to write the RTP payloads (payload
+     * descriptors and MTU-sized fragments) itself, straight from the libvpx
+     * output, so that the {@link Packetizer} does not copy the frame again.
+     * The default value is <tt>false</tt>.
+     */
+    public static final String NATIVE_PACKETIZATION_PNAME
+        = "org.jitsi.impl.neomedia.codec.video.vp8.nativePacketization";
+
+    /**
+     * The name of the boolean <tt>ConfigurationService</tt> property which
+     * specifies whether requests for keyframes from the receiver are to be
+     * served by a frame predicted from a long-term reference (golden or
+     * alt-ref frame) which the receiver has acknowledged, with an RTCP RPSI
+     * message or {@link #acknowledgeFrame(int)}, instead of by a keyframe. A
+     * keyframe is still produced if no reference has been acknowledged, so
+     * the mode only pays off with receivers which send RPSI. The default
+     * value is <tt>false</tt>.
+     */
+    public static final String REFERENCE_RECOVERY_PNAME
+        = "org.jitsi.impl.neomedia.codec.video.vp8.referenceRecovery";
+
     /**
      * VPX interface to use
      */
@@ -49,18 +130,51 @@
      */
     private static final int DEFAULT_HEIGHT = 480;
 
+    /**
+     * The number of ticks per second of the time base of the presentation
+     * timestamps, i.e. the RTP clock rate of video.
+     */
+    private static final int TIMEBASE = 90000;
+
     /**
      * The <tt>Logger</tt> used by the <tt>VPXEncoder</tt> class and its
      * instances for logging output.
      */
     private static final Logger logger = Logger.getLogger(VPXEncoder.class);
 
+    /**
+     * The name of the integer <tt>ConfigurationService</tt> property which
+     * specifies the number of VP8 temporal layers to encode. The default value
+     * is <tt>1</tt> i.e. temporal scalability is disabled. The supported
+     * values are <tt>1</tt>, <tt>2</tt> and <tt>3</tt>.
+     */
+    public static final String TEMPORAL_LAYERS_PNAME
+        = "org.jitsi.impl.neomedia.codec.video.vp8.temporalLayers";
+
     /**
      * Default output formats
      */
     private static final VideoFormat[] SUPPORTED_OUTPUT_FORMATS
             = new VideoFormat[] { new VideoFormat(Constants.VP8) };
 
+    /**
+     * The macroblocks which have changed since the last frame the encoder
+     * produced, or <tt>null</tt> if no input <tt>Buffer</tt> has carried
+     * changed areas yet.
+     */
+    private ActiveMap activeMap = null;
+
+    /**
+     * Whether the encoder codes only the macroblocks which have changed, see
+     * {@link #ACTIVE_MAP_PNAME}.
+     */
+    private boolean activeMapEnabled = false;
+
+    /**
+     * Whether an active map is set on the encoder context.
+     */
+    private boolean activeMapSet = false;
+
     /**
      * Pointer to a native vpx_codec_dec_cfg structure containing
      * encoder configuration
@@ -72,16 +186,69 @@
      */
     private long context = 0;
 
+    /**
+     * The value of the <tt>cpu-used</tt> control to use when the speed is not
+     * adapted by {@link #speedGovernor}.
+     */
+    private int cpuUsed = 0;
+
+    /**
+     * Whether {@link #CPU_USED_PNAME} is set, i.e. whether {@link #cpuUsed}
+     * is to be applied rather than the default of libvpx.
+     */
+    private boolean cpuUsedConfigured = false;
+
     /**
      * Flags passed when (re-)initializing the encoder context
      */
     private long flags = 0;
 
     /**
-     * Number of encoder frames so far. Used as pst (presentation time stamp)
+     * Whether the next frame is to be encoded as a keyframe.
+     */
+    private boolean forceKeyFrame = false;
+
+    /**
+     * The duration in {@link #TIMEBASE} units of the last frame passed to the
+     * encoder.
      */
-    private long frameCount = 0;
+    private long frameDuration = 0;
 
+    /**
+     * The frame rate of the input of the encoder. Determines the durations of
+     * the frames.
+     */
+    private float frameRate = DEFAULT_FRAME_RATE;
+
+    /**
+     * The presentation timestamp in {@link #TIMEBASE} units of the last frame
+     * passed to the encoder.
+     */
+    private long pts = 0;
+
+    /**
+     * The target bitrate in kbps to apply before the next frame is encoded, or
+     * <tt>-1</tt> if it has not changed.
+     */
+    private int pendingBitrate = -1;
+
+    /**
+     * The frame rate to apply before the next frame is encoded, or
+     * <tt>-1</tt> if it has not changed.
+     */
+    private float pendingFrameRate = -1;
+
+    /**
+     * The <tt>KeyFrameControl</tt> through which the remote peer requests
+     * keyframes from this encoder.
+     */
+    private KeyFrameControl keyFrameControl;
+
+    /**
+     * The <tt>KeyFrameRequestee</tt> which this encoder adds to
+     * {@link #keyFrameControl}.
+     */
+    private KeyFrameControl.KeyFrameRequestee keyFrameRequestee;
 
     /**
      * Pointer to a native vpx_image instance used to feed frames to the encoder
@@ -89,21 +256,47 @@
     private long img = 0;
 
     /**
-     * Iterator for the compressed frames in the encoder context. Can be
-     * re-initialized by setting its only element to 0.
+     * Whether the encoder outputs natively packetized frames, see
+     * {@link #NATIVE_PACKETIZATION_PNAME}.
      */
-    private long[] iter = new long[1];
+    private boolean nativePacketization = false;
 
     /**
-     * Whether there are unprocessed packets left from a previous call to
-     * VP8.codec_encode()
+     * The compressed frame packets of the last encoded frame which did not
+     * fit in the output <tt>Buffer</tt> of the call which encoded it, at the
+     * offsets described by {@link #packetInfo}.
      */
-    private boolean leftoverPackets = false;
+    private byte[] leftoverData = null;
 
     /**
-     * Pointer to a vpx_codec_cx_pkt_t
+     * The index of the next packet of the last encoded frame to output.
      */
-    private long pkt = 0;
+    private int nextPacket = 0;
+
+    /**
+     * The number of compressed frame packets of the last encoded frame.
+     */
+    private int packetCount = 0;
+
+    /**
+     * The table describing the compressed frame packets of the last encoded
+     * frame, {@link VPX#CX_PKT_INFO_LENGTH} elements per packet.
+     */
+    private final long[] packetInfo
+        = new long[MAX_PACKETS_PER_FRAME * VPX.CX_PKT_INFO_LENGTH];
+
+    /**
+     * The table describing the RTP payloads of the last natively packetized
+     * frame, {@link VPX#CX_PKT_INFO_LENGTH} elements per payload.
+     */
+    private long[] payloadInfo = null;
+
+    /**
+     * The <tt>ReferenceRecovery</tt> which maintains the long-term references
+     * and serves requests for keyframes, or <tt>null</tt> if requests for
+     * keyframes are served by keyframes.
+     */
+    private ReferenceRecovery referenceRecovery = null;
 
     /**
      * Current width of the input and output frames
@@ -115,6 +308,34 @@
      */
     private int height = DEFAULT_HEIGHT;
 
+    /**
+     * The <tt>SpeedGovernor</tt> which adapts the speed of the encoder to the
+     * encode time, or <tt>null</tt> if the speed is fixed.
+     */
+    private SpeedGovernor speedGovernor = null;
+
+    /**
+     * The <tt>FrameInfo</tt> of the frame last fed to the encoder, or
+     * <tt>null</tt> if temporal scalability is disabled.
+     */
+    private TemporalLayering.FrameInfo frameInfo = null;
+
+    /**
+     * The header of the output <tt>Buffer</tt>s of the last encoded frame.
+     */
+    private Packetizer.FrameHeader frameHeader = null;
+
+    /**
+     * The PictureID of the next encoded frame.
+     */
+    private int pictureId = Packetizer.createInitialPictureId();
+
+    /**
+     * The temporal scalability structure used by this encoder, or
+     * <tt>null</tt> if temporal scalability is disabled.
+     */
+    private TemporalLayering temporalLayering = null;
+
     /**
      * Initializes a new <tt>VPXEncoder</tt> instance.
      */
@@ -164,6 +385,22 @@ protected void doClose()
             VPX.free(cfg);
             cfg = 0;
         }
+        if (keyFrameRequestee != null)
+        {
+            if (keyFrameControl != null)
+                keyFrameControl.removeKeyFrameRequestee(keyFrameRequestee);
+            keyFrameRequestee = null;
+        }
+        temporalLayering = null;
+        frameInfo = null;
+        frameHeader = null;
+        speedGovernor = null;
+        referenceRecovery = null;
+        activeMap = null;
+        activeMapSet = false;
+        leftoverData = null;
+        payloadInfo = null;
+        packetCount = nextPacket = 0;
     }
 
     /**
@@ -209,6 +446,73 @@ protected void doOpen() throws ResourceUnavailableException
         VPX.codec_enc_cfg_set_error_resilient(cfg,
             VPX.ERROR_RESILIENT_DEFAULT | VPX.ERROR_RESILIENT_PARTITIONS);
 
+        ConfigurationService cfgService = LibJitsi.getConfigurationService();
+        int temporalLayers = 1;
+        boolean adaptiveSpeed = false;
+        boolean recovery = false;
+
+        cpuUsed = 0;
+        cpuUsedConfigured = false;
+        nativePacketization = false;
+        activeMapEnabled = false;
+        if (cfgService != null)
+        {
+            temporalLayers
+                = cfgService.getInt(TEMPORAL_LAYERS_PNAME, temporalLayers);
+            cpuUsedConfigured = (cfgService.getString(CPU_USED_PNAME) != null);
+            cpuUsed = cfgService.getInt(CPU_USED_PNAME, cpuUsed);
+            adaptiveSpeed
+                = cfgService.getBoolean(ADAPTIVE_SPEED_PNAME, adaptiveSpeed);
+            nativePacketization
+                = cfgService.getBoolean(
+                        NATIVE_PACKETIZATION_PNAME,
+                        nativePacketization);
+            recovery
+                = cfgService.getBoolean(REFERENCE_RECOVERY_PNAME, recovery);
+            activeMapEnabled
+                = cfgService.getBoolean(ACTIVE_MAP_PNAME, activeMapEnabled);
+        }
+
+        frameRate = DEFAULT_FRAME_RATE;
+        if (inputFormat != null)
+        {
+            float inputFrameRate = ((VideoFormat) inputFormat).getFrameRate();
+
+            if (inputFrameRate > 0)
+                frameRate = inputFrameRate;
+        }
+        // The time base is fixed, because libvpx derives the ratio of the
+        // time stamps only when the encoder is initialized. Frame rate changes
+        // are conveyed by the durations of the frames instead.
+        VPX.codec_enc_cfg_set_timebase(cfg, 1, TIMEBASE);
+        pts = 0;
+        frameDuration = 0;
+
+        if (adaptiveSpeed)
+        {
+            speedGovernor
+                = new SpeedGovernor(
+                        cpuUsedConfigured
+                            ? Math.abs(cpuUsed)
+                            : SpeedGovernor.DEFAULT_MIN_SPEED,
+                        frameRate);
+        }
+        temporalLayering = TemporalLayering.create(temporalLayers);
+        if (temporalLayering != null)
+            temporalLayering.configure(cfg, bitRate);
+        else if (temporalLayers > 1)
+            logger.warn("Unsupported number of VP8 temporal layers: "
+                    + temporalLayers);
+        if (recovery)
+        {
+            referenceRecovery
+                = new ReferenceRecovery(
+                        temporalLayering == null
+                            || !temporalLayering.usesAltRef(),
+                        ReferenceRecovery.DEFAULT_REFRESH_INTERVAL);
+        }
+        forceKeyFrame = false;
+
         context = VPX.codec_ctx_malloc();
         int ret = VPX.codec_enc_init(context, INTERFACE, cfg, flags);
 
@@ -216,12 +520,28 @@ protected void doOpen() throws ResourceUnavailableException
             throw new RuntimeException("Failed to initialize encoder, libvpx"
                     + " error:\n"
                     + VPX.codec_err_to_string(ret));
+        setCpuUsed();
+        setScreenContentMode();
 
         if (inputFormat == null)
             throw new ResourceUnavailableException("No input format selected");
         if (outputFormat == null)
             throw new ResourceUnavailableException("No output format selected");
 
+        if (keyFrameRequestee == null)
+        {
+            keyFrameRequestee
+                = new KeyFrameControl.KeyFrameRequestee()
+                        {
+                            public boolean keyFrameRequest()
+                            {
+                                return VPXEncoder.this.keyFrameRequest();
+                            }
+                        };
+        }
+        if (keyFrameControl != null)
+            keyFrameControl.addKeyFrameRequestee(-1, keyFrameRequestee);
+
         if(logger.isDebugEnabled())
             logger.debug("VP8 encoder opened succesfully");
     }
@@ -250,10 +570,330 @@ private void updateSize(int w, int h)
         {
             VPX.codec_enc_cfg_set_w(cfg, w);
             VPX.codec_enc_cfg_set_h(cfg, h);
+            //libvpx cannot grow the frame beyond its initial size without
+            //re-initializing the encoder
+            if (!reconfigure())
+                reinit();
+        }
+    }
+
+    /**
+     * Sets the active map of the encoder from the areas which have changed
+     * since the last frame it produced, if {@link #ACTIVE_MAP_PNAME} is
+     * enabled.
+     *
+     * @param header the header of the input <tt>Buffer</tt>, which lists the
+     * areas which have changed since the previous input frame if it is an
+     * array of <tt>Rectangle</tt>s.
+     * @param width the width of the frame.
+     * @param height the height of the frame.
+     */
+    private void applyActiveMap(Object header, int width, int height)
+    {
+        if (!activeMapEnabled)
+            return;
+
+        if (activeMap == null || !activeMap.hasSize(width, height))
+            activeMap = new ActiveMap(width, height);
+
+        int ret;
+
+        if (header instanceof Rectangle[])
+        {
+            activeMap.add((Rectangle[]) header);
+            ret
+                = VPX.codec_enc_set_active_map(
+                        context,
+                        activeMap.getMap(),
+                        activeMap.getRows(),
+                        activeMap.getCols());
+            if (ret == VPX.CODEC_OK)
+            {
+                activeMapSet = true;
+                return;
+            }
+            logger.warn("Failed to set the active map: "
+                    + VPX.codec_err_to_string(ret));
+        }
+        else if (!activeMapSet)
+        {
+            return;
+        }
+
+        //the changed areas are unknown, code the whole frame. libvpx only
+        //accepts the null map with the macroblock dimensions of the frame.
+        ret
+            = VPX.codec_enc_set_active_map(
+                    context,
+                    null,
+                    activeMap.getRows(),
+                    activeMap.getCols());
+        if (ret != VPX.CODEC_OK)
+        {
+            logger.warn("Failed to disable the active map: "
+                    + VPX.codec_err_to_string(ret)
+                    + ". Setting a full active map instead.");
+            activeMap.fill();
+            ret
+                = VPX.codec_enc_set_active_map(
+                        context,
+                        activeMap.getMap(),
+                        activeMap.getRows(),
+                        activeMap.getCols());
+        }
+        if (ret == VPX.CODEC_OK)
+        {
+            activeMapSet = false;
+        }
+        else
+        {
+            logger.error("Failed to set a full active map: "
+                    + VPX.codec_err_to_string(ret));
+        }
+    }
+
+    /**
+     * Notifies this encoder that the receiver has decoded a specific frame,
+     * so that the frame can serve as the reference for recovery from loss if
+     * it is held in a long-term reference buffer. Called for each RTCP RPSI
+     * message received. Has no effect unless
+     * {@link #REFERENCE_RECOVERY_PNAME} is enabled.
+     *
+     * @param pictureId the PictureID of the frame.
+     * @return <tt>true</tt> if the frame can now serve as a reference for
+     * recovery, <tt>false</tt> otherwise.
+     */
+    public boolean acknowledgeFrame(int pictureId)
+    {
+        ReferenceRecovery referenceRecovery = this.referenceRecovery;
+
+        return
+            referenceRecovery != null
+                && referenceRecovery.acknowledge(pictureId);
+    }
+
+    /**
+     * Gets the PictureID which an RTCP RPSI message acknowledges. RFC 7741
+     * defines the native RPSI bit string of VP8 as the PictureID field of the
+     * payload descriptor. This encoder sends 15-bit PictureIDs, so only those
+     * are recognized.
+     *
+     * @param fci the feedback control information of the RPSI message.
+     * @return the acknowledged PictureID, or <tt>-1</tt> if <tt>fci</tt> does
+     * not hold a 15-bit PictureID.
+     */
+    static int getAcknowledgedPictureId(byte[] fci)
+    {
+        // RFC 4585, 6.3.3.2: the number of padding bits (PB), the payload
+        // type, then the native RPSI bit string.
+        if (fci == null || fci.length < 4)
+            return -1;
+
+        int bits = (fci.length - 2) * 8 - (fci[0] & 0xFF);
+
+        if (bits < 16 || (fci[2] & 0x80) == 0)
+            return -1;
+        return ((fci[2] & 0x7F) << 8) | (fci[3] & 0xFF);
+    }
+
+    /**
+     * Applies the changes of the target bitrate and of the frame rate
+     * requested with {@link #setBitrate(int)} and {@link #setFrameRate(float)}
+     * since the last frame was encoded.
+     */
+    private void applyPendingConfig()
+    {
+        int newBitrate;
+        float newFrameRate;
+
+        synchronized (this)
+        {
+            newBitrate = pendingBitrate;
+            newFrameRate = pendingFrameRate;
+            pendingBitrate = -1;
+            pendingFrameRate = -1;
+        }
+        if (newBitrate < 0 && newFrameRate < 0)
+            return;
+
+        if (newBitrate > 0)
+        {
+            VPX.codec_enc_cfg_set_rc_target_bitrate(cfg, newBitrate);
+            if (temporalLayering != null)
+                temporalLayering.configure(cfg, newBitrate);
+        }
+        if (newFrameRate > 0)
+        {
+            frameRate = newFrameRate;
+            if (speedGovernor != null)
+                speedGovernor.setFrameRate(newFrameRate);
+        }
+        if (newBitrate > 0 && !reconfigure())
             reinit();
+    }
+
+    /**
+     * Notifies this encoder that the remote peer has requested a keyframe,
+     * e.g. with an RTCP FIR or PLI. The request is served by a recovery frame
+     * predicted from an acknowledged long-term reference if
+     * {@link #REFERENCE_RECOVERY_PNAME} is enabled, and by a keyframe
+     * otherwise.
+     *
+     * @return <tt>true</tt>, the request is always honored.
+     */
+    private boolean keyFrameRequest()
+    {
+        ReferenceRecovery referenceRecovery = this.referenceRecovery;
+
+        if (referenceRecovery != null)
+        {
+            referenceRecovery.requestRecovery();
+        }
+        else
+        {
+            synchronized (this)
+            {
+                forceKeyFrame = true;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Applies the current configuration to the encoder context without
+     * re-initializing it.
+     *
+     * @return <tt>true</tt> if the configuration was applied, <tt>false</tt>
+     * if the encoder has to be re-initialized instead.
+     */
+    private boolean reconfigure()
+    {
+        int ret = VPX.codec_enc_config_set(context, cfg);
+
+        if (ret != VPX.CODEC_OK)
+        {
+            if(logger.isInfoEnabled())
+                logger.info("Failed to reconfigure the encoder, libvpx error: "
+                        + VPX.codec_err_to_string(ret));
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Notifies this encoder that an RTCP feedback message has been received.
+     * A Picture Loss Indication (PLI) or a Full Intra Request (FIR) is served
+     * as a keyframe request, see {@link #keyFrameRequest()}.
+     *
+     * @param ev the <tt>RTCPFeedbackMessageEvent</tt> which describes the
+     * received message.
+     */
+    @Override
+    public void rtcpFeedbackMessageReceived(RTCPFeedbackMessageEvent ev)
+    {
+        if (ev.getPayloadType() == RTCPFeedbackMessageEvent.PT_PS)
+        {
+            switch (ev.getFeedbackMessageType())
+            {
+                case RTCPFeedbackMessageEvent.FMT_PLI:
+                case RTCPFeedbackMessageEvent.FMT_FIR:
+                    if (logger.isTraceEnabled())
+                    {
+                        logger.trace(
+                                "Scheduling a key-frame, because we received an"
+                                    + " RTCP PLI or FIR.");
+                    }
+                    keyFrameRequest();
+                    break;
+                case RTCPFeedbackMessageEvent.FMT_RPSI:
+                    int ackPictureId
+                        = getAcknowledgedPictureId(
+                                ev.getFeedbackControlInformation());
+
+                    if (ackPictureId != -1
+                            && acknowledgeFrame(ackPictureId)
+                            && logger.isTraceEnabled())
+                    {
+                        logger.trace(
+                                "The receiver acknowledged PictureID "
+                                    + ackPictureId + " with an RTCP RPSI.");
+                    }
+                    break;
+                default:
+                    break;
+            }
         }
     }
 
+    /**
+     * Sets the target bitrate of the encoder. The change is applied to the
+     * running encoder before the next frame is encoded, without
+     * re-initializing it and thus without forcing a keyframe.
+     *
+     * @param bitrate the target bitrate in kbps.
+     */
+    public synchronized void setBitrate(int bitrate)
+    {
+        if (bitrate > 0)
+            pendingBitrate = bitrate;
+    }
+
+    /**
+     * Sets the <tt>KeyFrameControl</tt> through which the remote peer
+     * requests keyframes from this encoder.
+     *
+     * @param keyFrameControl the <tt>KeyFrameControl</tt> to be used.
+     */
+    public void setKeyFrameControl(KeyFrameControl keyFrameControl)
+    {
+        if (this.keyFrameControl != keyFrameControl)
+        {
+            if ((this.keyFrameControl != null) && (keyFrameRequestee != null))
+            {
+                this.keyFrameControl.removeKeyFrameRequestee(
+                        keyFrameRequestee);
+            }
+
+            this.keyFrameControl = keyFrameControl;
+
+            if ((this.keyFrameControl != null) && (keyFrameRequestee != null))
+            {
+                this.keyFrameControl.addKeyFrameRequestee(
+                        -1,
+                        keyFrameRequestee);
+            }
+        }
+    }
+
+    /**
+     * Tunes the encoder context for screen content if
+     * {@link #ACTIVE_MAP_PNAME} is enabled.
+     */
+    private void setScreenContentMode()
+    {
+        if (!activeMapEnabled)
+            return;
+
+        int ret = VPX.codec_enc_set_screen_content_mode(context, 1);
+
+        if (ret != VPX.CODEC_OK)
+            logger.warn("Failed to set the screen content mode: "
+                    + VPX.codec_err_to_string(ret));
+    }
+
+    /**
+     * Sets the frame rate of the input of the encoder. The change is applied
+     * to the running encoder before the next frame is encoded, without
+     * re-initializing it.
+     *
+     * @param frameRate the frame rate.
+     */
+    public synchronized void setFrameRate(float frameRate)
+    {
+        if (frameRate > 0)
+            pendingFrameRate = frameRate;
+    }
+
     /**
      * {@inheritDoc}
      *
@@ -276,30 +916,22 @@ protected int doProcess(Buffer inputBuffer, Buffer outputBuffer)
         }
 
         int ret = BUFFER_PROCESSED_OK;
-        byte[] output;
-        if(leftoverPackets)
+        if(nextPacket < packetCount)
         {
-            if(VPX.codec_cx_pkt_get_kind(pkt) == VPX.CODEC_CX_FRAME_PKT)
-            {
-                int size = VPX.codec_cx_pkt_get_size(pkt);
-                output = validateByteArraySize(inputBuffer, size, false);
-                VPX.memcpy(output,
-                           VPX.codec_cx_pkt_get_data(pkt),
-                           size);
-                outputBuffer.setOffset(0);
-                outputBuffer.setLength(size);
-                outputBuffer.setTimeStamp(inputBuffer.getTimeStamp());
-            }
-            else
-            {
-                //not a compressed frame, skip this packet
-                ret |= OUTPUT_BUFFER_NOT_FILLED;
-            }
+            int i = nextPacket * VPX.CX_PKT_INFO_LENGTH;
+            int offset = (int) packetInfo[i];
+            int size = (int) packetInfo[i + 1];
+            byte[] output = validateByteArraySize(outputBuffer, size, false);
+
+            System.arraycopy(leftoverData, offset, output, 0, size);
+            outputBuffer.setOffset(0);
+            outputBuffer.setLength(size);
+            outputBuffer.setTimeStamp(inputBuffer.getTimeStamp());
+            outputBuffer.setHeader(frameHeader);
+            nextPacket++;
         }
         else
         {
-            frameCount++;
-
             YUVFormat format = (YUVFormat) inputBuffer.getFormat();
             Dimension formatSize = format.getSize();
             int width = formatSize.width;
@@ -308,6 +940,12 @@ protected int doProcess(Buffer inputBuffer, Buffer outputBuffer)
             if (width > 0 && height > 0 &&
                     (width != this.width || height != this.height))
                 updateSize(width, height);
+            applyPendingConfig();
+            applyActiveMap(inputBuffer.getHeader(), width, height);
+
+            // Each frame starts where the previous one ends.
+            pts += frameDuration;
+            frameDuration = Math.max(1, Math.round(TIMEBASE / frameRate));
 
             //setup img
             int strideY = format.getStrideY();
@@ -331,53 +969,325 @@ protected int doProcess(Buffer inputBuffer, Buffer outputBuffer)
             if (offsetV == Format.NOT_SPECIFIED)
                 offsetV = offsetU + (width * height) / 4;
 
-            int result = VPX.codec_encode(
+            int encodeFlags = 0;
+            boolean keyFrame;
+
+            synchronized (this)
+            {
+                keyFrame = forceKeyFrame;
+                forceKeyFrame = false;
+            }
+
+            //a recovery frame restarts the temporal pattern like a keyframe,
+            //so that it is in the base layer and updates the last frame
+            boolean restart
+                = keyFrame
+                    || (referenceRecovery != null
+                        && referenceRecovery.isRecoveryRequested());
+
+            if (temporalLayering != null)
+            {
+                frameInfo = temporalLayering.next(restart);
+                encodeFlags = frameInfo.getFlags();
+                VPX.codec_enc_set_temporal_layer_id(
+                        context,
+                        frameInfo.getTemporalLayerId());
+            }
+            if (referenceRecovery != null)
+            {
+                encodeFlags
+                    = referenceRecovery.getFlags(
+                            encodeFlags,
+                            (frameInfo == null)
+                                ? 0
+                                : frameInfo.getTemporalLayerId(),
+                            pictureId);
+            }
+            if (keyFrame)
+                encodeFlags |= VPX.EFLAG_FORCE_KF;
+
+            if (nativePacketization)
+            {
+                return
+                    encodePacketized(
+                            inputBuffer,
+                            outputBuffer,
+                            offsetY,
+                            offsetU,
+                            offsetV,
+                            encodeFlags);
+            }
+
+            //encode straight into the output Buffer, the compressed frame is
+            //usually much smaller than a byte per pixel
+            byte[] output
+                = validateByteArraySize(outputBuffer, width * height, false);
+            long encodeStart = System.nanoTime();
+            int result = VPX.codec_encode_batch(
                     context,
                     img,
                     (byte[]) inputBuffer.getData(),
                     offsetY,
                     offsetU,
                     offsetV,
-                    frameCount, //pts
-                    1, //duration
-                    0, //flags
-                    VPX.DL_REALTIME);
-            if(result != VPX.CODEC_OK)
+                    pts,
+                    frameDuration,
+                    encodeFlags,
+                    VPX.DL_REALTIME,
+                    output,
+                    0,
+                    output.length,
+                    packetInfo);
+
+            updateSpeed(System.nanoTime() - encodeStart);
+
+            if (result == -VPX.CODEC_MEM_ERROR)
+            {
+                //libvpx never produces more than 3 bytes per pixel (and at
+                //least 32 KiB) and keeps the packets until the next frame is
+                //encoded
+                output
+                    = validateByteArraySize(
+                            outputBuffer,
+                            Math.max(3 * width * height, 32768),
+                            false);
+                result
+                    = VPX.codec_get_cx_data_batch(
+                            context,
+                            output,
+                            0,
+                            output.length,
+                            packetInfo);
+            }
+            frameEncoded(result, packetInfo);
+            if(result < 0)
             {
                 logger.warn("Failed to encode a frame: "
-                        + VPX.codec_err_to_string(result));
+                        + VPX.codec_err_to_string(-result));
+                packetCount = nextPacket = 0;
                 outputBuffer.setDiscard(true);
                 return BUFFER_PROCESSED_OK;
             }
 
-            iter[0] = 0;
-            pkt = VPX.codec_get_cx_data(context, iter);
-            if(pkt != 0 &&
-                    VPX.codec_cx_pkt_get_kind(pkt) == VPX.CODEC_CX_FRAME_PKT)
+            packetCount = result;
+            if (packetCount == 0)
             {
-                int size = VPX.codec_cx_pkt_get_size(pkt);
-                long data = VPX.codec_cx_pkt_get_data(pkt);
-                output = validateByteArraySize(outputBuffer, size, false);
-                VPX.memcpy(output, data, size);
-                outputBuffer.setOffset(0);
-                outputBuffer.setLength(size);
-                outputBuffer.setTimeStamp(inputBuffer.getTimeStamp());
+                //no compressed frame, e.g. the encoder dropped the frame
+                nextPacket = 0;
+                ret |= OUTPUT_BUFFER_NOT_FILLED;
             }
             else
             {
-                //not a compressed frame, skip this packet
-                ret |= OUTPUT_BUFFER_NOT_FILLED;
+                frameHeader = new Packetizer.FrameHeader(pictureId, frameInfo);
+                pictureId = nextPictureId(pictureId, 1);
+
+                outputBuffer.setOffset((int) packetInfo[0]);
+                outputBuffer.setLength((int) packetInfo[1]);
+                outputBuffer.setTimeStamp(inputBuffer.getTimeStamp());
+                outputBuffer.setHeader(frameHeader);
+                nextPacket = 1;
+
+                if (packetCount > 1)
+                {
+                    //the output Buffer may be reused before the remaining
+                    //packets are output, keep them at the same offsets
+                    int last = (packetCount - 1) * VPX.CX_PKT_INFO_LENGTH;
+                    int from = (int) packetInfo[VPX.CX_PKT_INFO_LENGTH];
+                    int to = (int) (packetInfo[last] + packetInfo[last + 1]);
+
+                    if (leftoverData == null || leftoverData.length < to)
+                        leftoverData = new byte[to];
+                    System.arraycopy(
+                            output, from,
+                            leftoverData, from,
+                            to - from);
+                }
             }
         }
 
-        pkt = VPX.codec_get_cx_data(context, iter);
-        leftoverPackets = pkt != 0;
-
-        if(leftoverPackets)
+        if(nextPacket < packetCount)
             return ret | INPUT_BUFFER_NOT_CONSUMED;
         else
             return ret;
+    }
 
+    /**
+     * Encodes a frame and packetizes it natively into RTP payloads, which are
+     * all output in <tt>outputBuffer</tt> and described by a
+     * {@link Packetizer.PacketizedFrame} set as its header.
+     *
+     * @param inputBuffer the input <tt>Buffer</tt> holding the raw frame.
+     * @param outputBuffer the output <tt>Buffer</tt>.
+     * @param offsetY the offset of the Y plane in the input data.
+     * @param offsetU the offset of the U plane in the input data.
+     * @param offsetV the offset of the V plane in the input data.
+     * @param encodeFlags the flags to encode the frame with.
+     * @return the result of the processing, as for
+     * {@link #doProcess(Buffer, Buffer)}.
+     */
+    private int encodePacketized(
+            Buffer inputBuffer,
+            Buffer outputBuffer,
+            int offsetY,
+            int offsetU,
+            int offsetV,
+            int encodeFlags)
+    {
+        long encodeStart = System.nanoTime();
+        int result = VPX.codec_encode(
+                context,
+                img,
+                (byte[]) inputBuffer.getData(),
+                offsetY,
+                offsetU,
+                offsetV,
+                pts,
+                frameDuration,
+                encodeFlags,
+                VPX.DL_REALTIME);
+
+        updateSpeed(System.nanoTime() - encodeStart);
+
+        if (result == VPX.CODEC_OK)
+        {
+            byte[] pd
+                = Packetizer.createPayloadDescriptor(
+                        frameInfo,
+                        pictureId,
+                        true);
+
+            //try with a byte per pixel first, then with the most that libvpx
+            //can produce (see doProcess)
+            for (int maxSize = width * height;;)
+            {
+                int maxPayloads
+                    = maxSize / Packetizer.MAX_SIZE + MAX_PACKETS_PER_FRAME;
+                byte[] output
+                    = validateByteArraySize(
+                            outputBuffer,
+                            maxSize
+                                + maxPayloads
+                                    * VPX.MAX_PAYLOAD_DESCRIPTOR_LENGTH,
+                            false);
+
+                if (payloadInfo == null
+                        || payloadInfo.length
+                            < maxPayloads * VPX.CX_PKT_INFO_LENGTH)
+                {
+                    payloadInfo
+                        = new long[maxPayloads * VPX.CX_PKT_INFO_LENGTH];
+                }
+                result
+                    = VPX.codec_get_cx_data_packetized(
+                            context,
+                            pd,
+                            pd.length,
+                            Packetizer.MAX_SIZE,
+                            output,
+                            0,
+                            output.length,
+                            payloadInfo);
+
+                int largestSize = Math.max(3 * width * height, 32768);
+
+                if (result != -VPX.CODEC_MEM_ERROR || maxSize >= largestSize)
+                    break;
+                maxSize = largestSize;
+            }
+        }
+        else
+        {
+            result = -result;
+        }
+
+        frameEncoded(result, payloadInfo);
+        packetCount = nextPacket = 0;
+        if (result < 0)
+        {
+            logger.warn("Failed to encode a frame: "
+                    + VPX.codec_err_to_string(-result));
+            outputBuffer.setDiscard(true);
+            return BUFFER_PROCESSED_OK;
+        }
+        if (result == 0)
+        {
+            //no compressed frame, e.g. the encoder dropped the frame
+            return OUTPUT_BUFFER_NOT_FILLED;
+        }
+
+        int last = (result - 1) * VPX.CX_PKT_INFO_LENGTH;
+        int length = (int) (payloadInfo[last] + payloadInfo[last + 1]);
+        int frames = 0;
+
+        //the PictureID was incremented natively for each frame
+        for (int i = 2; i < result * VPX.CX_PKT_INFO_LENGTH;
+                i += VPX.CX_PKT_INFO_LENGTH)
+        {
+            if ((payloadInfo[i] & VPX.PAYLOAD_END_OF_FRAME) != 0)
+                frames++;
+        }
+        pictureId = nextPictureId(pictureId, frames);
+
+        outputBuffer.setOffset(0);
+        outputBuffer.setLength(length);
+        outputBuffer.setTimeStamp(inputBuffer.getTimeStamp());
+        outputBuffer.setHeader(
+                new Packetizer.PacketizedFrame(payloadInfo, result));
+        return BUFFER_PROCESSED_OK;
+    }
+
+    /**
+     * Gets the PictureID which follows a specific one after a specific number
+     * of frames.
+     *
+     * @param pictureId the PictureID.
+     * @param frames the number of frames.
+     * @return the PictureID <tt>frames</tt> frames after <tt>pictureId</tt>.
+     */
+    private static int nextPictureId(int pictureId, int frames)
+    {
+        return
+            (pictureId + frames)
+                & DePacketizer.VP8PayloadDescriptor.EXTENDED_PICTURE_ID_MASK;
+    }
+
+    /**
+     * Updates the state which depends on the outcome of encoding a frame: the
+     * long-term references of the <tt>ReferenceRecovery</tt>, if any, and the
+     * changed areas, which the encoder has coded if it produced the frame.
+     *
+     * @param result the number of packets (or payloads) of the frame, or a
+     * negated libvpx error code.
+     * @param info the table describing the packets (or payloads) of the
+     * frame, {@link VPX#CX_PKT_INFO_LENGTH} elements per packet.
+     */
+    private void frameEncoded(int result, long[] info)
+    {
+        if (result > 0 && activeMap != null)
+            activeMap.clear();
+        if (referenceRecovery != null)
+        {
+            referenceRecovery.frameEncoded(
+                    result > 0,
+                    result > 0 && (info[2] & VPX.FRAME_IS_KEY) != 0);
+        }
+    }
+
+    /**
+     * Feeds the time it took to encode a frame to the
+     * <tt>SpeedGovernor</tt>, if any, and applies the speed it selects.
+     *
+     * @param encodeNanos the time in nanoseconds it took to encode a frame.
+     */
+    private void updateSpeed(long encodeNanos)
+    {
+        if (speedGovernor != null && speedGovernor.update(encodeNanos))
+        {
+            if (logger.isDebugEnabled())
+                logger.debug("Setting VP8 encoder speed to "
+                        + speedGovernor.getSpeed());
+            setCpuUsed();
+        }
     }
 
     /**
@@ -417,6 +1327,33 @@ private void reinit()
             throw new RuntimeException("Failed to re-initialize encoder, libvpx"
                     + " error:\n"
                     + VPX.codec_err_to_string(ret));
+
+        setCpuUsed();
+        setScreenContentMode();
+        activeMapSet = false;
+
+        //the first frame after initialization is a keyframe
+        if (temporalLayering != null)
+            temporalLayering.reset();
+    }
+
+    /**
+     * Applies the current <tt>cpu-used</tt> value to the encoder context, if
+     * it is configured or adapted. Otherwise the encoder keeps the default of
+     * libvpx.
+     */
+    private void setCpuUsed()
+    {
+        if (speedGovernor == null && !cpuUsedConfigured)
+            return;
+
+        int value
+            = (speedGovernor == null) ? cpuUsed : speedGovernor.getCpuUsed();
+        int ret = VPX.codec_enc_set_cpu_used(context, value);
+
+        if (ret != VPX.CODEC_OK)
+            logger.warn("Failed to set cpu-used to " + value + ": "
+                    + VPX.codec_err_to_string(ret));
     }
 
     /**
@@ -31,9 +31,12 @@
 import org.jitsi.impl.neomedia.*;
 import org.jitsi.impl.neomedia.codec.video.*;
 import org.jitsi.impl.neomedia.codec.video.h264.*;
+import org.jitsi.impl.neomedia.codec.video.vp8.VPXDecoder;
+import org.jitsi.impl.neomedia.codec.video.vp8.VPXEncoder;
 import org.jitsi.impl.neomedia.control.*;
 import org.jitsi.impl.neomedia.format.*;
 import org.jitsi.impl.neomedia.transform.*;
+import org.jitsi.service.configuration.*;
 import org.jitsi.service.libjitsi.*;
 import org.jitsi.service.neomedia.*;
 import org.jitsi.service.neomedia.control.*;
@@ -1177,6 +1180,44 @@ public boolean requestKeyFrame(
                                     playerScaler
                                 });
                     }
+                    /*
+                     * For VP8, the decoder requests a keyframe when it has to
+                     * wait for one. The DePacketizer may hand it frames in
+                     * native memory and partial frames, which only a
+                     * VPXDecoder reads.
+                     */
+                    else if ("vp8/rtp".equalsIgnoreCase(fmjEncoding))
+                    {
+                        org.jitsi.impl.neomedia.codec.video.vp8.DePacketizer
+                            depacketizer
+                                = new org.jitsi.impl.neomedia.codec.video.vp8
+                                    .DePacketizer();
+                        VPXDecoder decoder = new VPXDecoder();
+                        ConfigurationService cfg
+                            = LibJitsi.getConfigurationService();
+
+                        if (cfg != null)
+                        {
+                            String pname
+                                = org.jitsi.impl.neomedia.codec.video.vp8
+                                    .DePacketizer.NATIVE_FRAME_ASSEMBLY_PNAME;
+
+                            depacketizer.setNativeFrameAssembly(
+                                    cfg.getBoolean(pname, false));
+                            depacketizer.setOutputPartialFrames(
+                                    cfg.getBoolean(
+                                            VPXDecoder.ERROR_CONCEALMENT_PNAME,
+                                            false));
+                        }
+                        decoder.setKeyFrameControl(keyFrameControl);
+                        trackControl.setCodecChain(
+                                new Codec[]
+                                {
+                                    depacketizer,
+                                    decoder,
+                                    playerScaler
+                                });
+                    }
                     else
                     {
                         trackControl.setCodecChain(
@@ -1188,7 +1229,7 @@ public boolean requestKeyFrame(
             catch (UnsupportedPlugInException upiex)
             {
                 logger.error(
-                        "Failed to add SwScale or H.264 DePacketizer"
+                        "Failed to add SwScale or a DePacketizer and decoder"
                             + " to codec chain",
                         upiex);
                 playerScaler = null;
@@ -1691,13 +1732,13 @@ protected Format setProcessorFormat(
             MediaFormatImpl<? extends Format> mediaFormat,
             Format format)
     {
-        JNIEncoder encoder = null;
+        Codec encoder = null;
         SwScale scaler = null;
         int codecCount = 0;
 
         /*
-         * For H.264 we will monitor RTCP feedback. For example, if we receive a
-         * PLI/FIR message, we will send a keyframe.
+         * For H.264 and VP8 we will monitor RTCP feedback. For example, if we
+         * receive a PLI/FIR message, we will send a keyframe.
          */
         /*
          * The current Android video capture device system provided H.264 so it
@@ -1710,7 +1751,7 @@ protected Format setProcessorFormat(
         if (!OSUtils.IS_ANDROID
                 && "h264/rtp".equalsIgnoreCase(format.getEncoding()))
         {
-            encoder = new JNIEncoder();
+            JNIEncoder h264Encoder = new JNIEncoder();
 
             // packetization-mode
             {
@@ -1723,27 +1764,42 @@ protected Format setProcessorFormat(
                                 VideoMediaFormatImpl
                                     .H264_PACKETIZATION_MODE_FMTP);
 
-                encoder.setPacketizationMode(packetizationMode);
+                h264Encoder.setPacketizationMode(packetizationMode);
             }
 
             // additionalCodecSettings
             {
-                encoder.setAdditionalCodecSettings(
+                h264Encoder.setAdditionalCodecSettings(
                         mediaFormat.getAdditionalCodecSettings());
             }
 
-            this.encoder = encoder;
-            onRTCPFeedbackMessageCreate(encoder);
+            if (keyFrameControl != null)
+                h264Encoder.setKeyFrameControl(keyFrameControl);
+
+            this.encoder = h264Encoder;
+            encoder = h264Encoder;
+        }
+        else if ("vp8/rtp".equalsIgnoreCase(format.getEncoding()))
+        {
+            VPXEncoder vp8Encoder = new VPXEncoder();
+
+            if (keyFrameControl != null)
+                vp8Encoder.setKeyFrameControl(keyFrameControl);
+
+            this.encoder = vp8Encoder;
+            encoder = vp8Encoder;
+        }
+
+        if (encoder != null)
+        {
+            onRTCPFeedbackMessageCreate(this.encoder);
             synchronized (rtcpFeedbackMessageCreateListeners)
             {
                 for (RTCPFeedbackMessageCreateListener l
                         : rtcpFeedbackMessageCreateListeners)
-                    l.onRTCPFeedbackMessageCreate(encoder);
+                    l.onRTCPFeedbackMessageCreate(this.encoder);
             }
 
-            if (keyFrameControl != null)
-                encoder.setKeyFrameControl(keyFrameControl);
-
             codecCount++;
         }
 
@@ -1784,7 +1840,7 @@ protected Format setProcessorFormat(
             catch(UnsupportedPlugInException upiex)
             {
                 logger.error(
-                        "Failed to add SwScale/JNIEncoder to codec chain",
+                        "Failed to add SwScale or an encoder to codec chain",
                         upiex);
             }
         }
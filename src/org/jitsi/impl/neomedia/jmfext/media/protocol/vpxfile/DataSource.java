@@ -0,0 +1,127 @@
+/*
+ * Copyright @ 2015 Atlassian Pty Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.jitsi.impl.neomedia.jmfext.media.protocol.vpxfile;
+
+import java.awt.*;
+import java.io.*;
+
+import javax.media.*;
+import javax.media.control.*;
+import javax.media.format.*;
+
+import org.jitsi.impl.neomedia.jmfext.media.protocol.*;
+import org.jitsi.service.neomedia.codec.*;
+
+/**
+ * Implements <tt>CaptureDevice</tt> and <tt>DataSource</tt> which play the
+ * VP8 or VP9 frames of an IVF or WebM file in a loop, e.g. to replay a
+ * recording or to generate load. The file is memory-mapped and indexed once by
+ * a {@link VPXFileReader}, and each frame is copied from the mapping into the
+ * <tt>Buffer</tt> which reads it.
+ *
+ * @author agent
+ */
+public class DataSource
+    extends AbstractVideoPullBufferCaptureDevice
+{
+    /**
+     * The format of the video of the file.
+     */
+    private final Format[] supportedFormats = new Format[1];
+
+    /**
+     * The reader of the file, while connected.
+     */
+    private VPXFileReader reader;
+
+    /**
+     * {@inheritDoc}
+     *
+     * Maps and indexes the file at the remainder of the
+     * <tt>MediaLocator</tt>, which gives the format of the video.
+     */
+    @Override
+    protected void doConnect()
+        throws IOException
+    {
+        super.doConnect();
+
+        reader = new VPXFileReader(getLocator().getRemainder());
+        supportedFormats[0]
+            = new VideoFormat(
+                    (reader.getCodec() == VPXFileReader.CODEC_VP9)
+                        ? Constants.VP9
+                        : Constants.VP8,
+                    new Dimension(reader.getWidth(), reader.getHeight()),
+                    Format.NOT_SPECIFIED,
+                    null,
+                    Format.NOT_SPECIFIED);
+    }
+
+    /**
+     * {@inheritDoc}
+     *
+     * Unmaps the file.
+     */
+    @Override
+    protected void doDisconnect()
+    {
+        super.doDisconnect();
+
+        if (reader != null)
+        {
+            reader.close();
+            reader = null;
+        }
+    }
+
+    /**
+     * {@inheritDoc}
+     *
+     * Implements
+     * {@link AbstractPullBufferCaptureDevice#createStream(int, FormatControl)}.
+     */
+    @Override
+    protected VPXFileStream createStream(
+            int streamIndex,
+            FormatControl formatControl)
+    {
+        return new VPXFileStream(this, formatControl);
+    }
+
+    /**
+     * Gets the reader of the file.
+     *
+     * @return the reader of the file, or <tt>null</tt> if this instance is not
+     * connected.
+     */
+    VPXFileReader getReader()
+    {
+        return reader;
+    }
+
+    /**
+     * {@inheritDoc}
+     *
+     * Overrides the super implementation in order to return the format of
+     * the file, which the super cannot know.
+     */
+    @Override
+    protected Format[] getSupportedFormats(int streamIndex)
+    {
+        return supportedFormats.clone();
+    }
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright @ 2015 Atlassian Pty Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.jitsi.impl.neomedia.jmfext.media.protocol.vpxfile;
+
+import javax.media.*;
+import javax.media.format.*;
+
+import org.jitsi.impl.neomedia.device.*;
+import org.jitsi.service.neomedia.codec.*;
+import org.jitsi.utils.*;
+
+/**
+ * Implements a <tt>MediaDevice</tt> which plays the VP8 or VP9 video of an
+ * IVF or WebM file in a loop, without decoding or copying it.
+ *
+ * @author agent
+ */
+public class VPXFileMediaDevice
+    extends MediaDeviceImpl
+{
+    /**
+     * The list of <tt>Format</tt>s supported by the
+     * <tt>VPXFileMediaDevice</tt> instances.
+     */
+    protected static final Format[] SUPPORTED_FORMATS
+        = new Format[]
+                {
+                    new VideoFormat(Constants.VP8),
+                    new VideoFormat(Constants.VP9)
+                };
+
+    /**
+     * Initializes a new <tt>VPXFileMediaDevice</tt> instance which will play
+     * the IVF or WebM file located at <tt>filename</tt>.
+     *
+     * @param filename the location of the file which the
+     * <tt>VPXFileStream</tt> will read.
+     */
+    public VPXFileMediaDevice(String filename)
+    {
+        super(new CaptureDeviceInfo(
+                  filename,
+                  new MediaLocator("vpxfile:" + filename),
+                  VPXFileMediaDevice.SUPPORTED_FORMATS),
+              MediaType.VIDEO);
+    }
+}
@@ -0,0 +1,315 @@
+/*
+ * Copyright @ 2015 Atlassian Pty Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.jitsi.impl.neomedia.jmfext.media.protocol.vpxfile;
+
+import java.io.*;
+
+import org.jitsi.utils.*;
+
+/**
+ * Reads the VP8 or VP9 frames of an IVF file, or of the first video track of
+ * a WebM file such as the ones written by <tt>WebmWriter</tt>. The file is
+ * memory-mapped and indexed once when it is opened, and each frame is then
+ * returned as a direct <tt>ByteBuffer</tt> over the mapping, without a copy,
+ * so that many readers of the same file share the pages of the file in
+ * memory.
+ *
+ * The mapping goes away when the reader is closed, and the pages of a file
+ * which is truncated while it is mapped cannot be accessed anymore (which
+ * raises <tt>SIGBUS</tt>). Frames which are to outlive the call which gets
+ * them, e.g. because they are passed on to other threads, or which may have
+ * been truncated, are to be copied with
+ * {@link #readFrame(int, byte[], int, long[])}, which guards against both.
+ *
+ * The frames of a live or unfinished WebM recording, i.e. with elements of
+ * unknown size or cut short, are read up to the last complete one. Laced
+ * blocks are skipped.
+ *
+ * @author agent
+ */
+public class VPXFileReader
+{
+    static
+    {
+        JNIUtils.loadLibrary("jnvpx", VPXFileReader.class);
+    }
+
+    /**
+     * The codec of a VP8 file.
+     */
+    public static final int CODEC_VP8 = 0;
+
+    /**
+     * The codec of a VP9 file.
+     */
+    public static final int CODEC_VP9 = 1;
+
+    /**
+     * The flag which marks a keyframe.
+     */
+    public static final int FLAG_KEY = 1;
+
+    /**
+     * The index in the array filled by {@link #getFrame(int, long[])} of the
+     * time stamp of the frame in nanoseconds.
+     */
+    public static final int INFO_TIMESTAMP = 0;
+
+    /**
+     * The index in the array filled by {@link #getFrame(int, long[])} of the
+     * flags of the frame, e.g. {@link #FLAG_KEY}.
+     */
+    public static final int INFO_FLAGS = 1;
+
+    /**
+     * The length of the array filled by {@link #getFrame(int, long[])}.
+     */
+    public static final int INFO_LENGTH = 2;
+
+    private static native void close(long reader);
+
+    private static native int getCodec(long reader);
+
+    /**
+     * Gets a frame of a file.
+     *
+     * @param reader the reader returned by {@link #open(String)}.
+     * @param index the index of the frame.
+     * @param info an array of at least {@link #INFO_LENGTH} elements to be
+     * filled with the time stamp and flags of the frame, or <tt>null</tt>.
+     * @return a direct <tt>ByteBuffer</tt> over the frame in the mapping of
+     * the file, or <tt>null</tt> if <tt>index</tt> is out of range.
+     */
+    private static native java.nio.ByteBuffer getFrame(
+            long reader,
+            int index,
+            long[] info);
+
+    private static native int getFrameCount(long reader);
+
+    private static native int getHeight(long reader);
+
+    private static native int getWidth(long reader);
+
+    /**
+     * Copies a frame of a file into a specific array, unless the file has
+     * been truncated since it was mapped and no longer holds the frame.
+     *
+     * @param reader the reader returned by {@link #open(String)}.
+     * @param index the index of the frame.
+     * @param buf the array to copy the frame into.
+     * @param offset the offset in <tt>buf</tt> to copy the frame at.
+     * @param info an array of at least {@link #INFO_LENGTH} elements to be
+     * filled with the time stamp and flags of the frame, or <tt>null</tt>.
+     * @return <tt>true</tt> if the frame was copied, <tt>false</tt> if
+     * <tt>index</tt> is out of range, <tt>buf</tt> is too small or the file
+     * no longer holds the frame.
+     */
+    private static native boolean readFrame(
+            long reader,
+            int index,
+            byte[] buf,
+            int offset,
+            long[] info);
+
+    /**
+     * Maps and indexes a file.
+     *
+     * @param path the path of the file.
+     * @return the reader of the file, or <tt>0</tt> if the file could not be
+     * mapped, is neither an IVF nor a WebM file with a VP8 or VP9 track, or
+     * has no frame.
+     */
+    private static native long open(String path);
+
+    /**
+     * The path of the file.
+     */
+    private final String path;
+
+    /**
+     * The native reader of the file, or <tt>0</tt> once closed.
+     */
+    private long reader;
+
+    /**
+     * Initializes a new <tt>VPXFileReader</tt> which maps and indexes a
+     * specific file.
+     *
+     * @param path the path of the IVF or WebM file.
+     * @throws IOException if the file could not be mapped, or is neither an
+     * IVF nor a WebM file with a VP8 or VP9 track, or has no frame.
+     */
+    public VPXFileReader(String path)
+        throws IOException
+    {
+        this.path = path;
+        reader = open(path);
+        if (reader == 0)
+            throw new IOException("Failed to read VP8/VP9 frames from " + path);
+    }
+
+    /**
+     * Unmaps the file. The buffers returned by
+     * {@link #getFrame(int, long[])} must not be accessed afterwards.
+     */
+    public synchronized void close()
+    {
+        if (reader != 0)
+        {
+            close(reader);
+            reader = 0;
+        }
+    }
+
+    /**
+     * Gets the codec of the file.
+     *
+     * @return {@link #CODEC_VP8} or {@link #CODEC_VP9}.
+     */
+    public synchronized int getCodec()
+    {
+        return getCodec(getReader());
+    }
+
+    /**
+     * Gets a frame of the file, without a copy.
+     *
+     * @param index the index of the frame, from <tt>0</tt> to
+     * {@link #getFrameCount()} excluded.
+     * @param info an array of at least {@link #INFO_LENGTH} elements to be
+     * filled with the time stamp in nanoseconds and the flags of the frame,
+     * or <tt>null</tt>.
+     * @return a direct <tt>ByteBuffer</tt> over the frame, which is valid
+     * until {@link #close()}, or <tt>null</tt> if <tt>index</tt> is out of
+     * range.
+     */
+    public synchronized java.nio.ByteBuffer getFrame(int index, long[] info)
+    {
+        if (info != null && info.length < INFO_LENGTH)
+            throw new IllegalArgumentException("info");
+        return getFrame(getReader(), index, info);
+    }
+
+    /**
+     * Gets the length of a frame of the file.
+     *
+     * @param index the index of the frame, from <tt>0</tt> to
+     * {@link #getFrameCount()} excluded.
+     * @return the length of the frame in bytes, or <tt>-1</tt> if
+     * <tt>index</tt> is out of range.
+     */
+    public synchronized int getFrameLength(int index)
+    {
+        java.nio.ByteBuffer frame = getFrame(getReader(), index, null);
+
+        return (frame == null) ? -1 : frame.capacity();
+    }
+
+    /**
+     * Gets the number of frames of the file.
+     *
+     * @return the number of frames of the file.
+     */
+    public synchronized int getFrameCount()
+    {
+        return getFrameCount(getReader());
+    }
+
+    /**
+     * Gets the height of the frames of the file, as declared by its header.
+     *
+     * @return the height of the frames of the file in pixels.
+     */
+    public synchronized int getHeight()
+    {
+        return getHeight(getReader());
+    }
+
+    /**
+     * Copies a frame of the file into a specific array. Unlike the buffer
+     * returned by {@link #getFrame(int, long[])}, the copy stays valid after
+     * this reader is closed.
+     *
+     * @param index the index of the frame, from <tt>0</tt> to
+     * {@link #getFrameCount()} excluded.
+     * @param buf the array to copy the frame into, which has room for at least
+     * {@link #getFrameLength(int)} bytes from <tt>offset</tt>.
+     * @param offset the offset in <tt>buf</tt> to copy the frame at.
+     * @param info an array of at least {@link #INFO_LENGTH} elements to be
+     * filled with the time stamp in nanoseconds and the flags of the frame,
+     * or <tt>null</tt>.
+     * @return the length of the frame in bytes, or <tt>-1</tt> if
+     * <tt>index</tt> is out of range.
+     * @throws IOException if this reader has been closed, or if the file has
+     * been truncated since it was mapped and no longer holds the frame.
+     */
+    public synchronized int readFrame(
+            int index,
+            byte[] buf,
+            int offset,
+            long[] info)
+        throws IOException
+    {
+        if (reader == 0)
+            throw new IOException("Closed: " + path);
+        if (info != null && info.length < INFO_LENGTH)
+            throw new IllegalArgumentException("info");
+
+        int length = getFrameLength(index);
+
+        if (length < 0)
+            return -1;
+        if (offset < 0 || offset > buf.length - length)
+            throw new IllegalArgumentException("buf");
+        if (!readFrame(reader, index, buf, offset, info))
+            throw new IOException("Truncated: " + path);
+        return length;
+    }
+
+    /**
+     * Gets the path of the file.
+     *
+     * @return the path of the file.
+     */
+    public String getPath()
+    {
+        return path;
+    }
+
+    /**
+     * Gets the native reader of the file.
+     *
+     * @return the native reader of the file.
+     * @throws IllegalStateException if this instance has been closed.
+     */
+    private long getReader()
+    {
+        if (reader == 0)
+            throw new IllegalStateException("closed");
+        return reader;
+    }
+
+    /**
+     * Gets the width of the frames of the file, as declared by its header.
+     *
+     * @return the width of the frames of the file in pixels.
+     */
+    public synchronized int getWidth()
+    {
+        return getWidth(getReader());
+    }
+}
@@ -0,0 +1,213 @@
+/*
+ * Copyright @ 2015 Atlassian Pty Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.jitsi.impl.neomedia.jmfext.media.protocol.vpxfile;
+
+import java.io.*;
+
+import javax.media.*;
+import javax.media.control.*;
+
+import org.jitsi.impl.neomedia.codec.*;
+import org.jitsi.impl.neomedia.jmfext.media.protocol.*;
+
+/**
+ * Implements a <tt>PullBufferStream</tt> which plays the frames of a
+ * {@link VPXFileReader} in a loop, at the pace of their time stamps. The
+ * frames are copied from the mapping of the file into the <tt>byte</tt> array
+ * of the <tt>Buffer</tt>s, which is reused from one read to the next, so
+ * that they stay valid while they are processed even if the
+ * <tt>DataSource</tt> is disconnected meanwhile.
+ *
+ * @author agent
+ */
+public class VPXFileStream
+    extends AbstractVideoPullBufferStream<DataSource>
+{
+    /**
+     * The delay in nanoseconds beyond which a late stream skips ahead instead
+     * of catching up with a burst of frames, e.g. after the thread which reads
+     * it has been suspended.
+     */
+    private static final long MAX_LATENESS = 1000000000L;
+
+    /**
+     * The frame interval in nanoseconds which is assumed for a file with a
+     * single frame.
+     */
+    private static final long DEFAULT_FRAME_INTERVAL = 33333333L;
+
+    /**
+     * The index of the next frame to be read.
+     */
+    private int index = 0;
+
+    /**
+     * The array which receives the time stamp and flags of the frames.
+     */
+    private final long[] info = new long[VPXFileReader.INFO_LENGTH];
+
+    /**
+     * The duration of a pass over the file in nanoseconds, including the
+     * interval after its last frame.
+     */
+    private long loopDuration = -1;
+
+    /**
+     * The time stamp of the first frame of the file in nanoseconds.
+     */
+    private long firstTimestamp;
+
+    /**
+     * The <tt>System.nanoTime()</tt> at which the first frame of the current
+     * pass over the file is due, or <tt>-1</tt> if the next frame is to be
+     * returned without waiting.
+     */
+    private long passStartTime = -1;
+
+    /**
+     * Initializes a new <tt>VPXFileStream</tt> instance which is to have a
+     * specific <tt>FormatControl</tt>
+     *
+     * @param dataSource the <tt>DataSource</tt> which is creating the new
+     * instance so that it becomes one of its <tt>streams</tt>
+     * @param formatControl the <tt>FormatControl</tt> of the new instance which
+     * is to specify the format in which it is to provide its media data
+     */
+    VPXFileStream(DataSource dataSource, FormatControl formatControl)
+    {
+        super(dataSource, formatControl);
+    }
+
+    /**
+     * Reads the next frame of the file into a specific <tt>Buffer</tt>,
+     * waiting until it is due.
+     *
+     * @param buffer the <tt>Buffer</tt> to write the frame into
+     * @throws IOException if the <tt>DataSource</tt> is not connected or the
+     * frame could not be read
+     */
+    @Override
+    protected void doRead(Buffer buffer)
+        throws IOException
+    {
+        VPXFileReader reader = dataSource.getReader();
+
+        if (reader == null)
+            throw new IOException("Not connected");
+
+        Format format = buffer.getFormat();
+
+        if (format == null)
+        {
+            format = getFormat();
+            if (format != null)
+                buffer.setFormat(format);
+        }
+
+        byte[] data;
+        int length;
+
+        try
+        {
+            int frameCount = reader.getFrameCount();
+
+            if (loopDuration < 0)
+            {
+                reader.getFrame(frameCount - 1, info);
+
+                long lastTimestamp = info[VPXFileReader.INFO_TIMESTAMP];
+
+                reader.getFrame(0, info);
+                firstTimestamp = info[VPXFileReader.INFO_TIMESTAMP];
+                loopDuration
+                    = lastTimestamp - firstTimestamp
+                        + ((frameCount > 1)
+                            ? (lastTimestamp - firstTimestamp)
+                                / (frameCount - 1)
+                            : DEFAULT_FRAME_INTERVAL);
+                if (loopDuration <= 0)
+                    loopDuration = DEFAULT_FRAME_INTERVAL;
+            }
+
+            if (index >= frameCount)
+            {
+                index = 0;
+                if (passStartTime >= 0)
+                    passStartTime += loopDuration;
+            }
+
+            data
+                = AbstractCodec2.validateByteArraySize(
+                        buffer,
+                        reader.getFrameLength(index),
+                        false);
+            length = reader.readFrame(index++, data, 0, info);
+        }
+        catch (IllegalStateException ise)
+        {
+            // The DataSource has been disconnected in the meantime.
+            throw new IOException("Not connected");
+        }
+
+        long offset = info[VPXFileReader.INFO_TIMESTAMP] - firstTimestamp;
+        long now = System.nanoTime();
+
+        if (passStartTime < 0 || now - (passStartTime + offset) > MAX_LATENESS)
+            passStartTime = now - offset;
+
+        // Sleep until the frame is due, from a fixed start so that the
+        // errors of the sleeps do not add up.
+        long nanos = passStartTime + offset - now;
+
+        if (nanos > 0)
+        {
+            try
+            {
+                Thread.sleep(nanos / 1000000, (int) (nanos % 1000000));
+            }
+            catch (InterruptedException ie)
+            {
+                Thread.currentThread().interrupt();
+            }
+        }
+
+        int flags = Buffer.FLAG_SYSTEM_TIME | Buffer.FLAG_LIVE_DATA;
+
+        if ((info[VPXFileReader.INFO_FLAGS] & VPXFileReader.FLAG_KEY) != 0)
+            flags |= Buffer.FLAG_KEY_FRAME;
+
+        buffer.setData(data);
+        buffer.setOffset(0);
+        buffer.setLength(length);
+        buffer.setTimeStamp(System.nanoTime());
+        buffer.setFlags(flags);
+    }
+
+    /**
+     * {@inheritDoc}
+     *
+     * Restarts the pacing so that a stream which was stopped does not catch
+     * up with the frames which it has not read in the meantime.
+     */
+    @Override
+    public void start()
+        throws IOException
+    {
+        super.start();
+
+        passStartTime = -1;
+    }
+}
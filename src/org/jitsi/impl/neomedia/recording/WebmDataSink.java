@@ -114,6 +114,18 @@
      */
     private long lastFramePts = -1;
 
+    /**
+     * The name of the file currently written to, which changes when the
+     * output is rotated.
+     */
+    private String currentFilename;
+
+    /**
+     * The PTS (presentation timestamp) of the first frame of the file
+     * currently written to. In milliseconds.
+     */
+    private long currentFileStartPts = 0;
+
     /**
      * The <tt>KeyFrameControl</tt> which we will use to request a keyframe.
      */
@@ -135,6 +147,73 @@
             WebmDataSink.class.getCanonicalName() + ".AUTOKEYFRAME";
     private int autoKeyframeRequestInterval = 0;
 
+    /**
+     * Property name to control whether the <tt>WebmWriter</tt> writes to the
+     * file on a background thread.
+     */
+    private static final String ASYNC_IO_PNAME
+        = WebmDataSink.class.getCanonicalName() + ".ASYNC_IO";
+
+    /**
+     * Whether the <tt>WebmWriter</tt> writes to the file on a background
+     * thread.
+     */
+    private final boolean asyncIO;
+
+    /**
+     * Property name to control whether the output is written as a live
+     * stream, which is never seeked back, e.g. to a named pipe read by
+     * another process.
+     */
+    private static final String LIVE_PNAME
+        = WebmDataSink.class.getCanonicalName() + ".LIVE";
+
+    /**
+     * Whether the output is written as a live stream.
+     */
+    private final boolean live;
+
+    /**
+     * Property name to control the duration in milliseconds after which the
+     * recording continues in a new file, <tt>0</tt> for no limit.
+     */
+    private static final String ROTATION_DURATION_PNAME
+        = WebmDataSink.class.getCanonicalName() + ".ROTATION_DURATION";
+
+    /**
+     * Property name to control the size in bytes after which the recording
+     * continues in a new file, <tt>0</tt> for no limit.
+     */
+    private static final String ROTATION_SIZE_PNAME
+        = WebmDataSink.class.getCanonicalName() + ".ROTATION_SIZE";
+
+    /**
+     * The duration in milliseconds after which the recording continues in a
+     * new file, or <tt>0</tt>.
+     */
+    private final long rotationDuration;
+
+    /**
+     * The size in bytes after which the recording continues in a new file, or
+     * <tt>0</tt>.
+     */
+    private final long rotationSize;
+
+    /**
+     * Property name to control the interval in milliseconds between the
+     * checkpoints at which the cues are stored in the file, <tt>0</tt> (the
+     * default) to only store them when the file is closed.
+     */
+    private static final String CUE_CHECKPOINT_INTERVAL_PNAME
+        = WebmDataSink.class.getCanonicalName() + ".CUE_CHECKPOINT_INTERVAL";
+
+    /**
+     * The interval in milliseconds between the checkpoints at which the cues
+     * are stored in the file, or <tt>-1</tt> to use the default of the
+     * <tt>WebmWriter</tt>, i.e. no checkpoints.
+     */
+    private final long cueCheckpointInterval;
+
 
     /**
      * Initialize a new <tt>WebmDataSink</tt> instance.
@@ -149,6 +228,12 @@ public WebmDataSink(String filename, DataSource dataSource)
         if (this.autoKeyframeRequestInterval > 0 && logger.isInfoEnabled()) {
             logger.info("Auto keyframe request is initialized for every " + this.autoKeyframeRequestInterval + " frames.");
         }
+        this.asyncIO = cfg.getBoolean(ASYNC_IO_PNAME, false);
+        this.live = cfg.getBoolean(LIVE_PNAME, false);
+        this.rotationDuration = cfg.getLong(ROTATION_DURATION_PNAME, 0);
+        this.rotationSize = cfg.getLong(ROTATION_SIZE_PNAME, 0);
+        this.cueCheckpointInterval
+            = cfg.getLong(CUE_CHECKPOINT_INTERVAL_PNAME, -1);
         this.filename = filename;
         this.dataSource = dataSource;
     }
@@ -176,24 +261,35 @@ public void close()
                 return;
             }
             if (writer != null)
-                writer.close();
-            if (USE_RECORDING_ENDED_EVENTS
-                    && eventHandler != null
-                    && firstFrameTime != -1
-                    && lastFramePts != -1)
             {
-                RecorderEvent event = new RecorderEvent();
-                event.setType(RecorderEvent.Type.RECORDING_ENDED);
-                event.setSsrc(ssrc);
-                event.setFilename(filename);
-
-                // make sure that the difference in the 'instant'-s of the
-                // STARTED and ENDED events matches the duration of the file
-                event.setDuration(lastFramePts);
+                long[] stats = writer.getIOStatistics();
 
-                event.setMediaType(MediaType.VIDEO);
-                eventHandler.handleEvent(event);
+                if (stats[WebmWriter.IO_STAT_LATE_BLOCKS] > 0)
+                {
+                    logger.warn(
+                            stats[WebmWriter.IO_STAT_LATE_BLOCKS]
+                                + " blocks arrived too late to be interleaved"
+                                + " in order in " + filename
+                                + " and were retimed.");
+                }
+                if (asyncIO && logger.isInfoEnabled())
+                {
+                    logger.info("WebM I/O statistics for " + filename
+                        + ": clusters="
+                        + stats[WebmWriter.IO_STAT_CLUSTERS]
+                        + ", bytes=" + stats[WebmWriter.IO_STAT_BYTES]
+                        + ", maxQueued="
+                        + stats[WebmWriter.IO_STAT_MAX_QUEUED]
+                        + ", stalls=" + stats[WebmWriter.IO_STAT_STALLS]
+                        + ", stallMs="
+                        + stats[WebmWriter.IO_STAT_STALL_NANOS] / 1000000
+                        + ", writeErrors="
+                        + stats[WebmWriter.IO_STAT_WRITE_ERRORS]);
+                }
+                writer.close();
             }
+            if (firstFrameTime != -1 && lastFramePts != -1)
+                recordingEnded(lastFramePts - currentFileStartPts);
             open = false;
         }
     }
@@ -267,7 +363,11 @@ public void setOutputLocator(MediaLocator mediaLocator)
     @Override
     public void start() throws IOException
     {
-        writer = new WebmWriter(filename);
+        writer = new WebmWriter(filename, asyncIO, live);
+        if (cueCheckpointInterval >= 0)
+            writer.setCueCheckpointInterval(cueCheckpointInterval);
+        if (rotationDuration > 0 || rotationSize > 0)
+            writer.setRotation(rotationDuration, rotationSize);
         dataSource.start();
         if (logger.isInfoEnabled())
             logger.info("Created WebmWriter on " + filename);
@@ -359,24 +459,9 @@ public void transferData(PushBufferStream stream)
                     logger.info("Received the first keyframe (width="
                         + width + "; height=" + height + ")"+" ssrc="+ssrc);
 
-                if (eventHandler != null)
-                {
-                    RecorderEvent event = new RecorderEvent();
-                    event.setType(RecorderEvent.Type.RECORDING_STARTED);
-                    event.setSsrc(ssrc);
-                    if (height*4 == width*3)
-                        event.setAspectRatio(
-                                RecorderEvent.AspectRatio.ASPECT_RATIO_4_3);
-                    else if (height*16 == width*9)
-                        event.setAspectRatio(
-                                RecorderEvent.AspectRatio.ASPECT_RATIO_16_9);
-
-                    event.setFilename(filename);
-                    event.setInstant(firstFrameTime);
-                    event.setRtpTimestamp(rtpTimeStamp);
-                    event.setMediaType(MediaType.VIDEO);
-                    eventHandler.handleEvent(event);
-                }
+                currentFilename = filename;
+                currentFileStartPts = 0;
+                recordingStarted(firstFrameTime, rtpTimeStamp);
             }
             else
             {
@@ -453,13 +538,89 @@ else if (height*16 == width*9)
                 diff += 1L<<32;
             //pts is in milliseconds, the VP8 rtp clock rate is 90000
             fd.pts = diff / 90;
-            writer.writeFrame(fd);
+            if (writer.writeFrame(fd))
+                recordingRotated(fd.pts, rtpTimeStamp);
 
             lastFramePts = fd.pts;
         }
         } //synchronized
     }
 
+    /**
+     * Notifies the event handler, if {@link #USE_RECORDING_ENDED_EVENTS} is
+     * enabled, that the file currently written to has been completed.
+     *
+     * @param duration the duration of the file in milliseconds.
+     */
+    private void recordingEnded(long duration)
+    {
+        if (USE_RECORDING_ENDED_EVENTS && eventHandler != null)
+        {
+            RecorderEvent event = new RecorderEvent();
+            event.setType(RecorderEvent.Type.RECORDING_ENDED);
+            event.setSsrc(ssrc);
+            event.setFilename(currentFilename);
+
+            // make sure that the difference in the 'instant'-s of the
+            // STARTED and ENDED events matches the duration of the file
+            event.setDuration(duration);
+
+            event.setMediaType(MediaType.VIDEO);
+            eventHandler.handleEvent(event);
+        }
+    }
+
+    /**
+     * Notifies the event handler that the recording continues in a new file.
+     * The file written to so far is reported as ended and the new one as
+     * started, as if they were separate recordings.
+     *
+     * @param pts the PTS in milliseconds at which the new file starts.
+     * @param rtpTimeStamp the RTP time stamp of the frame at which the new
+     * file starts.
+     */
+    private void recordingRotated(long pts, long rtpTimeStamp)
+    {
+        recordingEnded(pts - currentFileStartPts);
+
+        currentFilename = writer.getFileName();
+        currentFileStartPts = pts;
+        if (logger.isInfoEnabled())
+            logger.info("Continuing the recording in " + currentFilename);
+
+        recordingStarted(firstFrameTime + pts, rtpTimeStamp);
+    }
+
+    /**
+     * Notifies the event handler that the recording has started in the file
+     * currently written to.
+     *
+     * @param instant the time as returned by
+     * <tt>System.currentTimeMillis()</tt> of the first frame of the file.
+     * @param rtpTimeStamp the RTP time stamp of the first frame of the file.
+     */
+    private void recordingStarted(long instant, long rtpTimeStamp)
+    {
+        if (eventHandler != null)
+        {
+            RecorderEvent event = new RecorderEvent();
+            event.setType(RecorderEvent.Type.RECORDING_STARTED);
+            event.setSsrc(ssrc);
+            if (height*4 == width*3)
+                event.setAspectRatio(
+                        RecorderEvent.AspectRatio.ASPECT_RATIO_4_3);
+            else if (height*16 == width*9)
+                event.setAspectRatio(
+                        RecorderEvent.AspectRatio.ASPECT_RATIO_16_9);
+
+            event.setFilename(currentFilename);
+            event.setInstant(instant);
+            event.setRtpTimestamp(rtpTimeStamp);
+            event.setMediaType(MediaType.VIDEO);
+            eventHandler.handleEvent(event);
+        }
+    }
+
     /**
      * Returns <tt>true</tt> if the VP8 compressed frame contained in
      * <tt>buf</tt> at offset <tt>offset</tt> is a keyframe.
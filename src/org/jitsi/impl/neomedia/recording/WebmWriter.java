@@ -16,6 +16,8 @@
 package org.jitsi.impl.neomedia.recording;
 
 import java.io.*;
+import java.nio.*;
+import java.nio.charset.*;
 import org.jitsi.utils.*;
 
 public class WebmWriter
@@ -37,8 +39,130 @@
      */
     public static int FLAG_FRAME_IS_INVISIBLE = 0x04;
 
+    /**
+     * The codec of a VP8 video track.
+     */
+    public static final int CODEC_VP8 = 0;
+
+    /**
+     * The codec of a VP9 video track.
+     */
+    public static final int CODEC_VP9 = 1;
+
+    /**
+     * The codec of an Opus audio track.
+     */
+    public static final int CODEC_OPUS = 2;
+
+    /**
+     * The number of samples at 48 kHz which an Opus decoder discards at the
+     * start of a stream by default, i.e. the pre-skip of libopus' encoder.
+     */
+    public static final int OPUS_DEFAULT_PRE_SKIP = 312;
+
+    /**
+     * The index in the array returned by {@link #getIOStatistics()} of the
+     * number of clusters handed to the I/O thread.
+     */
+    public static final int IO_STAT_CLUSTERS = 0;
+
+    /**
+     * The index in the array returned by {@link #getIOStatistics()} of the
+     * number of bytes handed to the I/O thread.
+     */
+    public static final int IO_STAT_BYTES = 1;
+
+    /**
+     * The index in the array returned by {@link #getIOStatistics()} of the
+     * number of clusters currently waiting to be written.
+     */
+    public static final int IO_STAT_QUEUED = 2;
+
+    /**
+     * The index in the array returned by {@link #getIOStatistics()} of the
+     * largest number of clusters which have been waiting to be written.
+     */
+    public static final int IO_STAT_MAX_QUEUED = 3;
+
+    /**
+     * The index in the array returned by {@link #getIOStatistics()} of the
+     * number of times the writer blocked because the queue was full.
+     */
+    public static final int IO_STAT_STALLS = 4;
+
+    /**
+     * The index in the array returned by {@link #getIOStatistics()} of the
+     * total time in nanoseconds the writer blocked because the queue was full.
+     */
+    public static final int IO_STAT_STALL_NANOS = 5;
+
+    /**
+     * The index in the array returned by {@link #getIOStatistics()} of the
+     * number of clusters which the I/O thread failed to write.
+     */
+    public static final int IO_STAT_WRITE_ERRORS = 6;
+
+    /**
+     * The index in the array returned by {@link #getIOStatistics()} of the
+     * number of blocks which arrived too late to be interleaved in order and
+     * were written with the time stamp of the previous block. Unlike the
+     * other statistics, it is also counted if the writes are synchronous.
+     */
+    public static final int IO_STAT_LATE_BLOCKS = 7;
+
+    /**
+     * The length of the array returned by {@link #getIOStatistics()}.
+     */
+    public static final int IO_STATS_LENGTH = 8;
+
+    /**
+     * The index in a descriptor passed to
+     * {@link #writeFrames(ByteBuffer, long[], int)} of the offset of the
+     * frame in the buffer.
+     */
+    public static final int BLOCK_OFFSET = 0;
+
+    /**
+     * The index in a descriptor passed to
+     * {@link #writeFrames(ByteBuffer, long[], int)} of the length of the
+     * frame in bytes.
+     */
+    public static final int BLOCK_LENGTH = 1;
+
+    /**
+     * The index in a descriptor passed to
+     * {@link #writeFrames(ByteBuffer, long[], int)} of the presentation time
+     * of the frame in milliseconds.
+     */
+    public static final int BLOCK_PTS = 2;
+
+    /**
+     * The index in a descriptor passed to
+     * {@link #writeFrames(ByteBuffer, long[], int)} of the flags of the
+     * frame, e.g. {@link #FLAG_FRAME_IS_KEY}.
+     */
+    public static final int BLOCK_FLAGS = 3;
+
+    /**
+     * The index in a descriptor passed to
+     * {@link #writeFrames(ByteBuffer, long[], int)} of the number of the
+     * track of the frame.
+     */
+    public static final int BLOCK_TRACK = 4;
+
+    /**
+     * The number of elements of a descriptor passed to
+     * {@link #writeFrames(ByteBuffer, long[], int)}.
+     */
+    public static final int BLOCK_DESCRIPTOR_LENGTH = 5;
+
     private long glob;
 
+    /**
+     * The number of tracks added to this writer.
+     */
+    private int trackCount = 0;
+
     private native long allocCfg();
 
     /**
@@ -47,17 +171,191 @@
      */
     private native void freeCfg(long glob);
 
-    private native boolean openFile(long glob, String fileName);
-    private native void writeWebmFileHeader(long glob, int width, int height);
+    private native boolean openFile(
+            long glob,
+            String fileName,
+            boolean live);
+    private native int addVideoTrack(
+            long glob,
+            int codec,
+            int width,
+            int height);
+    private native int addAudioTrack(
+            long glob,
+            int codec,
+            int sampleRate,
+            int channels,
+            byte[] codecPrivate);
+    private native void writeWebmFileHeader(long glob);
+
+    /**
+     * Adds a video track to the file. Tracks are to be added before the
+     * header is written.
+     *
+     * @param codec the codec of the track, {@link #CODEC_VP8} or
+     * {@link #CODEC_VP9}.
+     * @param width the width of the video in pixels.
+     * @param height the height of the video in pixels.
+     * @return the number of the track, to be set as the <tt>track</tt> of the
+     * <tt>FrameDescriptor</tt>s of its frames, or <tt>-1</tt> if the track
+     * cannot be added.
+     */
+    public int addVideoTrack(int codec, int width, int height)
+    {
+        int track = addVideoTrack(glob, codec, width, height);
+
+        if (track > 0)
+            trackCount = track;
+        return track;
+    }
+
+    /**
+     * Adds an audio track to the file. Tracks are to be added before the
+     * header is written.
+     *
+     * @param codec the codec of the track, {@link #CODEC_OPUS}.
+     * @param sampleRate the sample rate of the audio in Hz.
+     * @param channels the number of channels of the audio.
+     * @param codecPrivate the codec private data of the track, e.g. the
+     * <tt>OpusHead</tt> of an Opus track (see
+     * {@link #createOpusHead(int, int, int)}), or <tt>null</tt>.
+     * @return the number of the track, to be set as the <tt>track</tt> of the
+     * <tt>FrameDescriptor</tt>s of its frames, or <tt>-1</tt> if the track
+     * cannot be added.
+     */
+    public int addAudioTrack(
+            int codec,
+            int sampleRate,
+            int channels,
+            byte[] codecPrivate)
+    {
+        int track
+            = addAudioTrack(glob, codec, sampleRate, channels, codecPrivate);
+
+        if (track > 0)
+            trackCount = track;
+        return track;
+    }
+
+    /**
+     * Creates the <tt>OpusHead</tt> identification header of an Opus stream
+     * as defined by RFC 7845, which is the codec private data of an Opus
+     * track.
+     *
+     * @param channels the number of channels, one or two.
+     * @param inputSampleRate the sample rate of the audio which was encoded,
+     * in Hz.
+     * @param preSkip the number of samples at 48 kHz to discard from the
+     * start of the decoded stream.
+     * @return the <tt>OpusHead</tt>.
+     */
+    public static byte[] createOpusHead(
+            int channels,
+            int inputSampleRate,
+            int preSkip)
+    {
+        byte[] head = new byte[19];
+
+        System.arraycopy(
+                "OpusHead".getBytes(StandardCharsets.US_ASCII), 0,
+                head, 0,
+                8);
+        head[8] = 1; // version
+        head[9] = (byte) channels;
+        head[10] = (byte) preSkip;
+        head[11] = (byte) (preSkip >> 8);
+        head[12] = (byte) inputSampleRate;
+        head[13] = (byte) (inputSampleRate >> 8);
+        head[14] = (byte) (inputSampleRate >> 16);
+        head[15] = (byte) (inputSampleRate >> 24);
+        // The output gain (16-17) and the channel mapping family (18) are 0.
+        return head;
+    }
+
+    /**
+     * Writes the header of the file, which describes the tracks added so far.
+     */
+    public void writeWebmFileHeader()
+    {
+        writeWebmFileHeader(glob);
+    }
+
+    /**
+     * Writes the header of a file with a single VP8 track, unless tracks have
+     * been added already.
+     *
+     * @param width the width of the video in pixels.
+     * @param height the height of the video in pixels.
+     */
     public void writeWebmFileHeader(int width, int height)
     {
-        writeWebmFileHeader(glob, width, height);
+        if (trackCount == 0)
+            addVideoTrack(CODEC_VP8, width, height);
+        writeWebmFileHeader(glob);
     }
-    private native void writeWebmBlock(long glob, FrameDescriptor fd);
+    private native boolean writeWebmBlock(long glob, FrameDescriptor fd);
+    private native boolean writeWebmBlocks(
+            long glob,
+            ByteBuffer data,
+            long[] descriptors,
+            int count);
     private native void writeWebmFileFooter(long glob, long hash);
 
+    /**
+     * Starts a thread which writes the clusters to the file so that the
+     * callers of {@link #writeFrame(FrameDescriptor)} do not block on disk
+     * I/O unless the queue of clusters is full.
+     *
+     * @param glob
+     * @return <tt>true</tt> if the thread was started.
+     */
+    private native boolean startIOThread(long glob);
+
+    private native void getIOStatistics(long glob, long[] stats);
+
+    private native void setCueCheckpointInterval(long glob, long interval);
+
+    private native String getFileName(long glob);
+
+    private native void setRotation(long glob, long duration, long size);
+
     public WebmWriter(String filename)
             throws IOException
+    {
+        this(filename, false);
+    }
+
+    /**
+     * Initializes a new <tt>WebmWriter</tt> which writes to a specific file.
+     *
+     * @param filename the name of the file to write to.
+     * @param asyncIO whether to write the clusters to the file on a
+     * background thread. The writes are synchronous if the thread cannot be
+     * started.
+     * @throws IOException if the file cannot be opened for writing.
+     */
+    public WebmWriter(String filename, boolean asyncIO)
+            throws IOException
+    {
+        this(filename, asyncIO, false);
+    }
+
+    /**
+     * Initializes a new <tt>WebmWriter</tt> which writes to a specific file
+     * or stream.
+     *
+     * @param filename the name of the file to write to, which may be a named
+     * pipe or a device such as <tt>/dev/stdout</tt> if <tt>live</tt>.
+     * @param asyncIO whether to write the clusters to the file on a
+     * background thread. The writes are synchronous if the thread cannot be
+     * started.
+     * @param live whether to write a live stream, which is never seeked back:
+     * the Segment has an unknown size, there is no SeekHead, duration or
+     * cues, and each cluster is passed on as soon as it is complete.
+     * @throws IOException if the file cannot be opened for writing.
+     */
+    public WebmWriter(String filename, boolean asyncIO, boolean live)
+            throws IOException
     {
         glob = allocCfg();
 
@@ -66,10 +364,13 @@ public WebmWriter(String filename)
             throw new IOException("allocCfg() failed");
         }
 
-        if (openFile(glob, filename))
+        if (openFile(glob, filename, live))
         {
             throw new IOException("Can not open " + filename + " for writing");
         }
+
+        if (asyncIO)
+            startIOThread(glob);
     }
 
     public void close()
@@ -78,9 +379,105 @@ public void close()
         freeCfg(glob); //also closes the file
     }
 
-    public void writeFrame(FrameDescriptor fd)
+    /**
+     * Sets the interval between the checkpoints at which the cues written so
+     * far are stored in the file, between two clusters, so that a file which
+     * is never closed (e.g. because the process crashed) is seekable up to
+     * the last checkpoint. Checkpoints are disabled by default: each one
+     * rewrites all the cues so far and leaves those of the previous one
+     * behind as a Void element, so the dead bytes grow quadratically with the
+     * length of the file and the interval should be chosen with that in mind,
+     * e.g. together with a rotation of the file.
+     *
+     * @param interval the interval in milliseconds of media time, or
+     * <tt>0</tt> to only write the cues when the file is closed.
+     */
+    public void setCueCheckpointInterval(long interval)
+    {
+        setCueCheckpointInterval(glob, interval);
+    }
+
+    /**
+     * Gets the name of the file currently written to, which changes when the
+     * output is rotated.
+     *
+     * @return the name of the file currently written to.
+     */
+    public String getFileName()
+    {
+        return getFileName(glob);
+    }
+
+    /**
+     * Sets the limits past which the output is rotated, i.e. the current
+     * file is completed and writing continues with the same tracks in a new
+     * file. The rotation happens at the next keyframe of the video (or at the
+     * next cluster of a file without video) so that each file starts with
+     * one, and the time stamps of each file start at zero. The files are
+     * named after the first one, e.g. <tt>rec-1.webm</tt>, <tt>rec-2.webm</tt>
+     * after <tt>rec.webm</tt>. Live streams are not rotated.
+     *
+     * @param duration the duration in milliseconds of media time after which
+     * to rotate, or <tt>0</tt> for no limit.
+     * @param size the size in bytes after which to rotate, or <tt>0</tt> for
+     * no limit.
+     */
+    public void setRotation(long duration, long size)
+    {
+        setRotation(glob, duration, size);
+    }
+
+    /**
+     * Gets the statistics of the I/O thread, indexed by the
+     * <tt>IO_STAT_*</tt> constants. All but {@link #IO_STAT_LATE_BLOCKS} are
+     * zero if the writes are synchronous.
+     *
+     * @return the statistics of the I/O thread.
+     */
+    public long[] getIOStatistics()
     {
-        writeWebmBlock(glob, fd);
+        long[] stats = new long[IO_STATS_LENGTH];
+
+        getIOStatistics(glob, stats);
+        return stats;
+    }
+
+    /**
+     * Writes a frame to the file. The frames of each track are to be written
+     * in presentation order. The frames of different tracks are interleaved
+     * by presentation time, for which a frame waits for the frames of the
+     * other tracks for up to half a second.
+     *
+     * @param fd the frame.
+     * @return <tt>true</tt> if the output was rotated to a new file, see
+     * {@link #getFileName()}.
+     */
+    public boolean writeFrame(FrameDescriptor fd)
+    {
+        return writeWebmBlock(glob, fd);
+    }
+
+    /**
+     * Writes several frames to the file with a single native call, as
+     * {@link #writeFrame(FrameDescriptor)} would one after the other. Frames
+     * with an offset or length out of the bounds of <tt>data</tt> are skipped.
+     *
+     * @param data a direct buffer which holds the frames.
+     * @param descriptors the descriptors of the frames,
+     * {@link #BLOCK_DESCRIPTOR_LENGTH} elements each, indexed by the
+     * <tt>BLOCK_*</tt> constants.
+     * @param count the number of frames.
+     * @return <tt>true</tt> if the output was rotated to a new file while
+     * writing the frames, see {@link #getFileName()}.
+     */
+    public boolean writeFrames(ByteBuffer data, long[] descriptors, int count)
+    {
+        if (!data.isDirect())
+            throw new IllegalArgumentException("data is not direct");
+        if (count < 0 || count > descriptors.length / BLOCK_DESCRIPTOR_LENGTH)
+            throw new IllegalArgumentException("count");
+
+        return writeWebmBlocks(glob, data, descriptors, count);
     }
 
     public static class FrameDescriptor
@@ -90,5 +487,11 @@ public void writeFrame(FrameDescriptor fd)
         public long length;
         public long pts;
         public int flags;
+
+        /**
+         * The number of the track of the frame, as returned when the track
+         * was added. The default is the first track.
+         */
+        public int track = 1;
     }
 }
@@ -41,6 +41,11 @@
      */
     public static final int FMT_PLI = 1;
 
+    /**
+     * Reference Picture Selection Indication (RPSI) feedback message type.
+     */
+    public static final int FMT_RPSI = 3;
+
     /**
      * The payload type (PT) of payload-specific RTCP feedback messages.
      */
@@ -51,6 +56,11 @@
      */
     public static final int PT_TL = 205;
 
+    /**
+     * Feedback control information (FCI), or <tt>null</tt>.
+     */
+    private final byte[] feedbackControlInformation;
+
     /**
      * Feedback message type (FMT).
      */
@@ -72,11 +82,42 @@ public RTCPFeedbackMessageEvent(
             Object source,
             int feedbackMessageType,
             int payloadType)
+    {
+        this(source, feedbackMessageType, payloadType, null);
+    }
+
+    /**
+     * Constructor.
+     *
+     * @param source source
+     * @param feedbackMessageType feedback message type (FMT)
+     * @param payloadType payload type (PT)
+     * @param feedbackControlInformation feedback control information (FCI),
+     * or <tt>null</tt>
+     */
+    public RTCPFeedbackMessageEvent(
+            Object source,
+            int feedbackMessageType,
+            int payloadType,
+            byte[] feedbackControlInformation)
     {
         super(source);
 
         this.feedbackMessageType = feedbackMessageType;
         this.payloadType = payloadType;
+        this.feedbackControlInformation = feedbackControlInformation;
+    }
+
+    /**
+     * Get feedback control information (FCI), e.g. the PictureID which an
+     * RPSI message acknowledges.
+     *
+     * @return feedback control information, or <tt>null</tt> if the message
+     * has none
+     */
+    public byte[] getFeedbackControlInformation()
+    {
+        return feedbackControlInformation;
     }
 
     /**
@@ -0,0 +1,716 @@
+/*
+ * Copyright @ 2015 Atlassian Pty Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.jitsi.impl.neomedia.codec.video;
+
+import java.io.*;
+import java.util.*;
+
+import org.jitsi.impl.neomedia.jmfext.media.protocol.ivffile.*;
+
+/**
+ * Measures the throughput and the per-frame latency of the VP8 encoder and
+ * decoder of <tt>libjnvpx</tt> through the different JNI paths which
+ * {@link VPX} offers: <tt>Get/Release&lt;Type&gt;ArrayElements</tt> with one
+ * call per packet or frame, <tt>GetPrimitiveArrayCritical</tt> with batched
+ * calls, and direct <tt>java.nio.ByteBuffer</tt>s.
+ *
+ * Synthetic input is encoded and decoded at 180p, 360p, 720p and 1080p. An IVF
+ * file can be given in addition, in which case its frames are decoded, and the
+ * decoded frames re-encoded, at the resolution of the file.
+ *
+ * Run with the <tt>vpx-benchmark</tt> ant target, e.g.
+ * <tt>ant vpx-benchmark -Dvpx.benchmark.args="-frames 600 -ivf in.ivf"</tt>.
+ *
+ * @author agent
+ */
+public class VPXBenchmark
+{
+    /**
+     * The default number of measured frames per run.
+     */
+    private static final int DEFAULT_FRAMES = 300;
+
+    /**
+     * The frame rate the encoder is configured with.
+     */
+    private static final int FRAME_RATE = 30;
+
+    /**
+     * The maximum number of decoded IVF frames kept as input for the encoder.
+     */
+    private static final int MAX_RAW_FRAMES = 30;
+
+    /**
+     * The synthetic resolutions: width, height and name.
+     */
+    private static final Object[][] RESOLUTIONS
+        = {
+            { 320, 180, "180p" },
+            { 640, 360, "360p" },
+            { 1280, 720, "720p" },
+            { 1920, 1080, "1080p" }
+        };
+
+    /**
+     * The number of frames run before the measured ones, so that the JIT and
+     * the rate control of the encoder settle.
+     */
+    private static final int WARMUP_FRAMES = 30;
+
+    /**
+     * Runs the benchmark.
+     *
+     * @param args <tt>-frames &lt;n&gt;</tt> sets the number of measured frames
+     * per run and <tt>-ivf &lt;file&gt;</tt> adds the runs with the frames of
+     * an IVF file.
+     * @throws IOException if reading the IVF file fails.
+     */
+    public static void main(String[] args)
+        throws IOException
+    {
+        int frames = DEFAULT_FRAMES;
+        String ivf = null;
+
+        for (int i = 0; i < args.length; i++)
+        {
+            if ("-frames".equals(args[i]) && i + 1 < args.length)
+                frames = Integer.parseInt(args[++i]);
+            else if ("-ivf".equals(args[i]) && i + 1 < args.length)
+                ivf = args[++i];
+            else
+            {
+                System.err.println(
+                        "Usage: VPXBenchmark [-frames <n>] [-ivf <file>]");
+                System.exit(1);
+            }
+        }
+
+        System.out.println(
+                String.format(
+                        "%-12s %-8s %-10s %10s %9s %9s %9s",
+                        "input", "op", "path",
+                        "fps", "p50 ms", "p90 ms", "p99 ms"));
+
+        for (Object[] resolution : RESOLUTIONS)
+        {
+            int width = (Integer) resolution[0];
+            int height = (Integer) resolution[1];
+            List<byte[]> raw = new ArrayList<>();
+
+            for (int i = 0; i < MAX_RAW_FRAMES; i++)
+                raw.add(createSyntheticFrame(width, height, i));
+            run((String) resolution[2], width, height, raw, null, frames);
+        }
+
+        if (ivf != null)
+        {
+            IVFFileReader reader = new IVFFileReader(ivf);
+            IVFHeader header = reader.getHeader();
+            int count = Math.min(frames, header.getNumberOfFramesInFile());
+            List<byte[]> encoded = new ArrayList<>(count);
+
+            for (int i = 0; i < count; i++)
+            {
+                VP8Frame frame = reader.getNextFrame(false);
+
+                encoded.add(
+                        Arrays.copyOf(
+                                frame.getFrameData(),
+                                frame.getFrameLength()));
+            }
+
+            int width = header.getWidth();
+            int height = header.getHeight();
+
+            run(
+                    new File(ivf).getName(),
+                    width,
+                    height,
+                    decodeToRaw(encoded, width, height),
+                    encoded,
+                    frames);
+        }
+    }
+
+    /**
+     * Runs the encode and decode benchmarks for one input.
+     *
+     * @param name the name of the input.
+     * @param width the width of the frames.
+     * @param height the height of the frames.
+     * @param raw the I420 frames to encode, cycled through.
+     * @param encoded the VP8 frames to decode, or <tt>null</tt> to decode the
+     * frames encoded from <tt>raw</tt>.
+     * @param frames the number of measured frames.
+     */
+    private static void run(
+            String name,
+            int width,
+            int height,
+            List<byte[]> raw,
+            List<byte[]> encoded,
+            int frames)
+    {
+        List<byte[]> output = new ArrayList<>();
+
+        report(name, "encode", "elements",
+                encodeElements(width, height, raw, frames));
+        report(name, "encode", "critical",
+                encodeBatch(width, height, raw, frames, output));
+        report(name, "encode", "packetize",
+                encodePacketized(width, height, raw, frames));
+
+        if (encoded == null)
+            encoded = output;
+        report(name, "decode", "elements", decodeElements(encoded));
+        report(name, "decode", "direct", decodeDirect(encoded));
+        report(name, "decode", "critical",
+                decodeExport(encoded, width, height));
+    }
+
+    /**
+     * Creates an encoder context.
+     *
+     * @param width the width of the frames.
+     * @param height the height of the frames.
+     * @return an array holding pointers to the context, its configuration and
+     * a <tt>vpx_image_t</tt> describing the input frames.
+     */
+    private static long[] createEncoder(int width, int height)
+    {
+        long cfg = VPX.codec_enc_cfg_malloc();
+
+        VPX.codec_enc_config_default(VPX.INTERFACE_VP8_ENC, cfg, 0);
+        VPX.codec_enc_cfg_set_w(cfg, width);
+        VPX.codec_enc_cfg_set_h(cfg, height);
+        // About 0.1 bits per pixel at 30 frames per second.
+        VPX.codec_enc_cfg_set_rc_target_bitrate(cfg, width * height * 3 / 1000);
+        VPX.codec_enc_cfg_set_rc_end_usage(cfg, VPX.RC_MODE_CBR);
+        VPX.codec_enc_cfg_set_kf_mode(cfg, VPX.KF_MODE_AUTO);
+        VPX.codec_enc_cfg_set_error_resilient(cfg,
+            VPX.ERROR_RESILIENT_DEFAULT | VPX.ERROR_RESILIENT_PARTITIONS);
+        VPX.codec_enc_cfg_set_timebase(cfg, 1, FRAME_RATE);
+
+        long context = VPX.codec_ctx_malloc();
+        int ret = VPX.codec_enc_init(context, VPX.INTERFACE_VP8_ENC, cfg, 0);
+
+        if (ret != VPX.CODEC_OK)
+            throw new IllegalStateException(
+                    "codec_enc_init: " + VPX.codec_err_to_string(ret));
+
+        long img = VPX.img_malloc();
+
+        VPX.img_set_fmt(img, VPX.IMG_FMT_I420);
+        VPX.img_set_bps(img, 12);
+        VPX.img_set_w(img, width);
+        VPX.img_set_d_w(img, width);
+        VPX.img_set_h(img, height);
+        VPX.img_set_d_h(img, height);
+        VPX.img_set_stride0(img, width);
+        VPX.img_set_stride1(img, width / 2);
+        VPX.img_set_stride2(img, width / 2);
+        VPX.img_set_stride3(img, 0);
+
+        return new long[] { context, cfg, img };
+    }
+
+    /**
+     * Creates a decoder context.
+     *
+     * @return a pointer to the decoder context.
+     */
+    private static long createDecoder()
+    {
+        long context = VPX.codec_ctx_malloc();
+        int ret = VPX.codec_dec_init(context, VPX.INTEFACE_VP8_DEC, 0, 0);
+
+        if (ret != VPX.CODEC_OK)
+            throw new IllegalStateException(
+                    "codec_dec_init: " + VPX.codec_err_to_string(ret));
+        return context;
+    }
+
+    /**
+     * Creates a synthetic I420 frame: a gradient which moves with the frame
+     * index, a moving block and some noise, roughly like camera input.
+     *
+     * @param width the width of the frame.
+     * @param height the height of the frame.
+     * @param index the index of the frame.
+     * @return the frame.
+     */
+    private static byte[] createSyntheticFrame(int width, int height, int index)
+    {
+        byte[] frame = new byte[width * height * 3 / 2];
+        Random random = new Random(index);
+        int block = height / 4;
+        int blockX = (index * width / MAX_RAW_FRAMES) % (width - block);
+        int blockY = height / 2 - block / 2;
+
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                int v;
+
+                if (x >= blockX && x < blockX + block
+                        && y >= blockY && y < blockY + block)
+                    v = 235;
+                else
+                    v = ((x + y + 4 * index) & 0xff) / 2 + 32;
+                frame[y * width + x] = (byte) (v + random.nextInt(8));
+            }
+        }
+        for (int i = width * height; i < frame.length; i++)
+            frame[i] = (byte) (128 + ((i + index) & 0x0f));
+        return frame;
+    }
+
+    /**
+     * Decodes VP8 frames into I420 frames to be used as encoder input.
+     *
+     * @param encoded the VP8 frames.
+     * @param width the width of the frames.
+     * @param height the height of the frames.
+     * @return up to {@link #MAX_RAW_FRAMES} I420 frames.
+     */
+    private static List<byte[]> decodeToRaw(
+            List<byte[]> encoded,
+            int width,
+            int height)
+    {
+        long context = createDecoder();
+        int frameSize = width * height * 3 / 2;
+        byte[] out = new byte[VPX.DECODE_EXPORT_HEADER_SIZE + frameSize];
+        List<byte[]> raw = new ArrayList<>();
+
+        for (byte[] frame : encoded)
+        {
+            int len
+                = VPX.codec_decode_export(
+                        context, frame, 0, frame.length,
+                        out, 0, out.length,
+                        0);
+
+            if (len >= VPX.DECODE_EXPORT_HEADER_SIZE + frameSize)
+            {
+                raw.add(
+                        Arrays.copyOfRange(
+                                out,
+                                VPX.DECODE_EXPORT_HEADER_SIZE,
+                                VPX.DECODE_EXPORT_HEADER_SIZE + frameSize));
+                if (raw.size() == MAX_RAW_FRAMES)
+                    break;
+            }
+        }
+        destroy(context);
+        if (raw.isEmpty())
+            throw new IllegalStateException("No frame could be decoded");
+        return raw;
+    }
+
+    /**
+     * Copies the planes of the frames decoded by a decoder out with
+     * <tt>codec_get_frame</tt> and <tt>memcpy</tt>, as
+     * <tt>codec_decode_export</tt> does in a single call, so that all the
+     * decode paths are timed with the same work.
+     *
+     * @param context a pointer to the decoder context.
+     * @param planes the arrays to copy the Y, U and V planes into, which are
+     * (re)allocated as necessary.
+     */
+    private static void copyFrames(long context, byte[][] planes)
+    {
+        long[] iter = new long[1];
+        long img;
+
+        while ((img = VPX.codec_get_frame(context, iter)) != 0)
+        {
+            int h = VPX.img_get_d_h(img);
+            long[] ptrs
+                = {
+                    VPX.img_get_plane0(img),
+                    VPX.img_get_plane1(img),
+                    VPX.img_get_plane2(img)
+                };
+            int[] sizes
+                = {
+                    VPX.img_get_stride0(img) * h,
+                    VPX.img_get_stride1(img) * ((h + 1) / 2),
+                    VPX.img_get_stride2(img) * ((h + 1) / 2)
+                };
+
+            for (int p = 0; p < planes.length; p++)
+            {
+                if (planes[p] == null || planes[p].length < sizes[p])
+                    planes[p] = new byte[sizes[p]];
+                VPX.memcpy(planes[p], ptrs[p], sizes[p]);
+            }
+        }
+    }
+
+    /**
+     * Decodes frames with <tt>codec_decode(byte[])</tt> and copies them out
+     * with {@link #copyFrames(long, byte[][])}.
+     *
+     * @param encoded the VP8 frames.
+     * @return the time in nanoseconds each measured frame took.
+     */
+    private static long[] decodeElements(List<byte[]> encoded)
+    {
+        long context = createDecoder();
+        byte[][] planes = new byte[3][];
+        long[] nanos = new long[encoded.size()];
+
+        int warmup = Math.min(WARMUP_FRAMES, encoded.size());
+
+        for (int i = -warmup; i < encoded.size(); i++)
+        {
+            // The warm-up, like the measured run, starts from the keyframe.
+            byte[] frame = encoded.get((i < 0) ? i + warmup : i);
+            long start = System.nanoTime();
+
+            VPX.codec_decode(context, frame, 0, frame.length, 0, 0);
+            copyFrames(context, planes);
+
+            if (i >= 0)
+                nanos[i] = System.nanoTime() - start;
+            if (i == -1)
+            {
+                destroy(context);
+                context = createDecoder();
+            }
+        }
+        destroy(context);
+        return nanos;
+    }
+
+    /**
+     * Decodes frames with <tt>codec_decode(java.nio.ByteBuffer)</tt> and
+     * copies them out with {@link #copyFrames(long, byte[][])}. The frames are copied into the direct buffer
+     * outside of the measurement, as they would be received into it.
+     *
+     * @param encoded the VP8 frames.
+     * @return the time in nanoseconds each measured frame took.
+     */
+    private static long[] decodeDirect(List<byte[]> encoded)
+    {
+        int maxSize = 0;
+
+        for (byte[] frame : encoded)
+            maxSize = Math.max(maxSize, frame.length);
+
+        java.nio.ByteBuffer buf = java.nio.ByteBuffer.allocateDirect(maxSize);
+        long context = createDecoder();
+        byte[][] planes = new byte[3][];
+        long[] nanos = new long[encoded.size()];
+
+        int warmup = Math.min(WARMUP_FRAMES, encoded.size());
+
+        for (int i = -warmup; i < encoded.size(); i++)
+        {
+            // The warm-up, like the measured run, starts from the keyframe.
+            byte[] frame = encoded.get((i < 0) ? i + warmup : i);
+
+            buf.clear();
+            buf.put(frame);
+
+            long start = System.nanoTime();
+
+            VPX.codec_decode(context, buf, 0, frame.length, 0, 0);
+            copyFrames(context, planes);
+
+            if (i >= 0)
+                nanos[i] = System.nanoTime() - start;
+            if (i == -1)
+            {
+                destroy(context);
+                context = createDecoder();
+            }
+        }
+        destroy(context);
+        return nanos;
+    }
+
+    /**
+     * Decodes frames and copies them out with <tt>codec_decode_export</tt>.
+     *
+     * @param encoded the VP8 frames.
+     * @param width the width of the frames.
+     * @param height the height of the frames.
+     * @return the time in nanoseconds each measured frame took.
+     */
+    private static long[] decodeExport(
+            List<byte[]> encoded,
+            int width,
+            int height)
+    {
+        long context = createDecoder();
+        byte[] out
+            = new byte[
+                    2 * (VPX.DECODE_EXPORT_HEADER_SIZE + width * height * 3 / 2)];
+        long[] nanos = new long[encoded.size()];
+
+        int warmup = Math.min(WARMUP_FRAMES, encoded.size());
+
+        for (int i = -warmup; i < encoded.size(); i++)
+        {
+            // The warm-up, like the measured run, starts from the keyframe.
+            byte[] frame = encoded.get((i < 0) ? i + warmup : i);
+            long start = System.nanoTime();
+
+            VPX.codec_decode_export(
+                    context, frame, 0, frame.length,
+                    out, 0, out.length,
+                    0);
+
+            if (i >= 0)
+                nanos[i] = System.nanoTime() - start;
+            if (i == -1)
+            {
+                destroy(context);
+                context = createDecoder();
+            }
+        }
+        destroy(context);
+        return nanos;
+    }
+
+    /**
+     * Destroys and frees a codec context.
+     *
+     * @param context a pointer to the context.
+     */
+    private static void destroy(long context)
+    {
+        VPX.codec_destroy(context);
+        VPX.free(context);
+    }
+
+    /**
+     * Destroys an encoder created with {@link #createEncoder(int, int)}.
+     *
+     * @param encoder the pointers returned by <tt>createEncoder</tt>.
+     */
+    private static void destroyEncoder(long[] encoder)
+    {
+        destroy(encoder[0]);
+        VPX.free(encoder[1]);
+        VPX.free(encoder[2]);
+    }
+
+    /**
+     * Encodes frames with <tt>codec_encode_batch</tt>, which copies all
+     * packets out with a single critical array access.
+     *
+     * @param width the width of the frames.
+     * @param height the height of the frames.
+     * @param raw the I420 frames to encode, cycled through.
+     * @param frames the number of measured frames.
+     * @param output receives the measured encoded frames.
+     * @return the time in nanoseconds each measured frame took.
+     */
+    private static long[] encodeBatch(
+            int width,
+            int height,
+            List<byte[]> raw,
+            int frames,
+            List<byte[]> output)
+    {
+        long[] encoder = createEncoder(width, height);
+        byte[] out = new byte[Math.max(3 * width * height, 32768)];
+        long[] info = new long[9 * VPX.CX_PKT_INFO_LENGTH];
+        long[] nanos = new long[frames];
+
+        for (int i = -WARMUP_FRAMES; i < frames; i++)
+        {
+            byte[] frame = raw.get((i + WARMUP_FRAMES) % raw.size());
+            long start = System.nanoTime();
+            int count
+                = VPX.codec_encode_batch(
+                        encoder[0], encoder[2], frame,
+                        0, width * height, width * height * 5 / 4,
+                        i + WARMUP_FRAMES, 1,
+                        (i == 0) ? VPX.EFLAG_FORCE_KF : 0,
+                        VPX.DL_REALTIME,
+                        out, 0, out.length,
+                        info);
+
+            if (i < 0)
+                continue;
+            nanos[i] = System.nanoTime() - start;
+
+            // Keep the frames to decode. The first one is a keyframe.
+            for (int j = 0; j < count; j++)
+            {
+                int k = j * VPX.CX_PKT_INFO_LENGTH;
+
+                output.add(
+                        Arrays.copyOfRange(
+                                out,
+                                (int) info[k],
+                                (int) (info[k] + info[k + 1])));
+            }
+        }
+        destroyEncoder(encoder);
+        return nanos;
+    }
+
+    /**
+     * Encodes frames with <tt>codec_encode</tt> and copies the packets out one
+     * by one with <tt>codec_get_cx_data</tt> and <tt>memcpy</tt>.
+     *
+     * @param width the width of the frames.
+     * @param height the height of the frames.
+     * @param raw the I420 frames to encode, cycled through.
+     * @param frames the number of measured frames.
+     * @return the time in nanoseconds each measured frame took.
+     */
+    private static long[] encodeElements(
+            int width,
+            int height,
+            List<byte[]> raw,
+            int frames)
+    {
+        long[] encoder = createEncoder(width, height);
+        byte[] out = new byte[Math.max(3 * width * height, 32768)];
+        long[] iter = new long[1];
+        long[] nanos = new long[frames];
+
+        for (int i = -WARMUP_FRAMES; i < frames; i++)
+        {
+            byte[] frame = raw.get((i + WARMUP_FRAMES) % raw.size());
+            long start = System.nanoTime();
+            long pkt;
+
+            VPX.codec_encode(
+                    encoder[0], encoder[2], frame,
+                    0, width * height, width * height * 5 / 4,
+                    i + WARMUP_FRAMES, 1, 0, VPX.DL_REALTIME);
+            iter[0] = 0;
+            while ((pkt = VPX.codec_get_cx_data(encoder[0], iter)) != 0)
+            {
+                if (VPX.codec_cx_pkt_get_kind(pkt) == VPX.CODEC_CX_FRAME_PKT)
+                {
+                    VPX.memcpy(
+                            out,
+                            VPX.codec_cx_pkt_get_data(pkt),
+                            VPX.codec_cx_pkt_get_size(pkt));
+                }
+            }
+
+            if (i >= 0)
+                nanos[i] = System.nanoTime() - start;
+        }
+        destroyEncoder(encoder);
+        return nanos;
+    }
+
+    /**
+     * Encodes frames with <tt>codec_encode</tt> and packetizes them into RTP
+     * payloads with <tt>codec_get_cx_data_packetized</tt>.
+     *
+     * @param width the width of the frames.
+     * @param height the height of the frames.
+     * @param raw the I420 frames to encode, cycled through.
+     * @param frames the number of measured frames.
+     * @return the time in nanoseconds each measured frame took.
+     */
+    private static long[] encodePacketized(
+            int width,
+            int height,
+            List<byte[]> raw,
+            int frames)
+    {
+        long[] encoder = createEncoder(width, height);
+        int maxSize = Math.max(3 * width * height, 32768);
+        int maxPayloads = maxSize / 1350 + 9;
+        byte[] out
+            = new byte[
+                    maxSize + maxPayloads * VPX.MAX_PAYLOAD_DESCRIPTOR_LENGTH];
+        long[] info = new long[maxPayloads * VPX.CX_PKT_INFO_LENGTH];
+        byte[] pd = { 0x10 };
+        long[] nanos = new long[frames];
+
+        for (int i = -WARMUP_FRAMES; i < frames; i++)
+        {
+            byte[] frame = raw.get((i + WARMUP_FRAMES) % raw.size());
+            long start = System.nanoTime();
+
+            VPX.codec_encode(
+                    encoder[0], encoder[2], frame,
+                    0, width * height, width * height * 5 / 4,
+                    i + WARMUP_FRAMES, 1, 0, VPX.DL_REALTIME);
+            VPX.codec_get_cx_data_packetized(
+                    encoder[0], pd, pd.length, 1350,
+                    out, 0, out.length,
+                    info);
+
+            if (i >= 0)
+                nanos[i] = System.nanoTime() - start;
+        }
+        destroyEncoder(encoder);
+        return nanos;
+    }
+
+    /**
+     * Prints the frame rate and the latency percentiles of a run.
+     *
+     * @param input the name of the input.
+     * @param op <tt>encode</tt> or <tt>decode</tt>.
+     * @param path the name of the JNI path.
+     * @param nanos the time in nanoseconds each measured frame took.
+     */
+    private static void report(
+            String input,
+            String op,
+            String path,
+            long[] nanos)
+    {
+        long[] sorted = nanos.clone();
+        long total = 0;
+
+        Arrays.sort(sorted);
+        for (long n : sorted)
+            total += n;
+
+        System.out.println(
+                String.format(
+                        "%-12s %-8s %-10s %10.1f %9.3f %9.3f %9.3f",
+                        input, op, path,
+                        (total == 0) ? 0 : sorted.length * 1e9 / total,
+                        percentile(sorted, 50) / 1e6,
+                        percentile(sorted, 90) / 1e6,
+                        percentile(sorted, 99) / 1e6));
+    }
+
+    /**
+     * Gets a percentile of sorted values.
+     *
+     * @param sorted the values, in ascending order.
+     * @param p the percentile.
+     * @return the <tt>p</tt>th percentile of <tt>sorted</tt>.
+     */
+    private static long percentile(long[] sorted, int p)
+    {
+        if (sorted.length == 0)
+            return 0;
+
+        int i = (int) Math.ceil(p / 100.0 * sorted.length) - 1;
+
+        return sorted[Math.max(0, Math.min(i, sorted.length - 1))];
+    }
+}
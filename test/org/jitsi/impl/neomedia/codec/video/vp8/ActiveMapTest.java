@@ -0,0 +1,37 @@
+package org.jitsi.impl.neomedia.codec.video.vp8;
+
+import java.awt.Rectangle;
+
+import org.junit.Test;
+
+import static org.junit.Assert.assertEquals;
+
+public class ActiveMapTest
+{
+    @Test
+    public void testDirtyRectangles()
+    {
+        // 40x20 pixels: 3 columns and 2 rows of macroblocks.
+        ActiveMap map = new ActiveMap(40, 20);
+
+        assertEquals(3, map.getCols());
+        assertEquals(2, map.getRows());
+
+        map.add(
+            new Rectangle[]
+            {
+                new Rectangle(15, 0, 2, 1),
+                new Rectangle(-10, 16, 11, 100),
+                new Rectangle(100, 100, 5, 5)
+            });
+
+        byte[] expected = { 1, 1, 0, 1, 0, 0 };
+
+        for (int i = 0; i < expected.length; i++)
+            assertEquals(expected[i], map.getMap()[i]);
+
+        map.clear();
+        for (byte b : map.getMap())
+            assertEquals(0, b);
+    }
+}
@@ -0,0 +1,84 @@
+package org.jitsi.impl.neomedia.codec.video.vp8;
+
+import org.jitsi.impl.neomedia.codec.video.*;
+import org.junit.Test;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertTrue;
+
+public class ReferenceRecoveryTest
+{
+    @Test
+    public void testRecoveryWithoutAcknowledgementForcesKeyframe()
+    {
+        ReferenceRecovery recovery = new ReferenceRecovery(true, 2);
+
+        recovery.getFlags(0, 0, 0);
+        recovery.frameEncoded(true, true);
+        recovery.requestRecovery();
+
+        int flags = recovery.getFlags(0, 0, 1);
+
+        assertTrue((flags & VPX.EFLAG_FORCE_KF) != 0);
+        recovery.frameEncoded(true, true);
+        assertFalse(recovery.isRecoveryRequested());
+    }
+
+    @Test
+    public void testRecoveryFromAcknowledgedReference()
+    {
+        ReferenceRecovery recovery = new ReferenceRecovery(true, 2);
+
+        recovery.getFlags(0, 0, 0);
+        recovery.frameEncoded(true, true);
+        assertTrue(recovery.acknowledge(0));
+
+        // Frames between refreshes leave the long-term references untouched.
+        int flags = recovery.getFlags(0, 0, 1);
+
+        assertEquals(VPX.EFLAG_NO_UPD_GF | VPX.EFLAG_NO_UPD_ARF, flags);
+        recovery.frameEncoded(true, false);
+
+        // The refresh does not overwrite the acknowledged reference in both
+        // buffers.
+        flags = recovery.getFlags(0, 0, 2);
+        assertTrue((flags & (VPX.EFLAG_FORCE_GF | VPX.EFLAG_FORCE_ARF)) != 0);
+        recovery.frameEncoded(true, false);
+        assertFalse(recovery.acknowledge(1));
+
+        recovery.requestRecovery();
+        flags = recovery.getFlags(0, 0, 3);
+        assertEquals(0, flags & VPX.EFLAG_FORCE_KF);
+        assertTrue((flags & VPX.EFLAG_NO_REF_LAST) != 0);
+        assertTrue((flags & VPX.EFLAG_NO_UPD_LAST) == 0);
+        assertTrue(
+            (flags & VPX.EFLAG_NO_REF_GF) == 0
+                || (flags & VPX.EFLAG_NO_REF_ARF) == 0);
+
+        // A dropped frame does not complete the recovery.
+        recovery.frameEncoded(false, false);
+        assertTrue(recovery.isRecoveryRequested());
+        recovery.getFlags(0, 0, 4);
+        recovery.frameEncoded(true, false);
+        assertFalse(recovery.isRecoveryRequested());
+    }
+
+    @Test
+    public void testRefreshOnlyInBaseLayer()
+    {
+        ReferenceRecovery recovery = new ReferenceRecovery(false, 1);
+
+        recovery.getFlags(0, 0, 0);
+        recovery.frameEncoded(true, true);
+
+        int flags = recovery.getFlags(0, 1, 1);
+
+        assertEquals(0, flags & VPX.EFLAG_FORCE_GF);
+        recovery.frameEncoded(true, false);
+
+        flags = recovery.getFlags(0, 0, 2);
+        assertTrue((flags & VPX.EFLAG_FORCE_GF) != 0);
+        assertEquals(0, flags & VPX.EFLAG_NO_UPD_GF);
+    }
+}
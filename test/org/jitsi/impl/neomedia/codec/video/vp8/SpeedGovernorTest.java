@@ -0,0 +1,127 @@
+package org.jitsi.impl.neomedia.codec.video.vp8;
+
+import org.junit.Test;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertTrue;
+
+public class SpeedGovernorTest
+{
+    /**
+     * The frame rate of the tests, i.e. a budget of 100 ms per frame.
+     */
+    private static final float FRAME_RATE = 10;
+
+    /**
+     * An encode time above the high watermark of the budget.
+     */
+    private static final long SLOW = 95000000L;
+
+    /**
+     * An encode time between the watermarks of the budget.
+     */
+    private static final long STEADY = 60000000L;
+
+    /**
+     * An encode time below the low watermark of the budget.
+     */
+    private static final long FAST = 10000000L;
+
+    /**
+     * Feeds a governor with frames which take the same time to encode until
+     * it changes the speed.
+     *
+     * @return the number of frames after which the speed changed, or
+     * <tt>-1</tt> if it did not change within <tt>maxFrames</tt> frames.
+     */
+    private static int feedUntilChange(
+            SpeedGovernor governor,
+            long encodeNanos,
+            int maxFrames)
+    {
+        for (int i = 1; i <= maxFrames; i++)
+        {
+            if (governor.update(encodeNanos))
+                return i;
+        }
+        return -1;
+    }
+
+    @Test
+    public void testMinSpeedIsClamped()
+    {
+        SpeedGovernor governor = new SpeedGovernor(0, FRAME_RATE);
+
+        assertEquals(1, governor.getSpeed());
+        assertEquals(-1, governor.getCpuUsed());
+        assertEquals(
+            SpeedGovernor.MAX_SPEED,
+            new SpeedGovernor(100, FRAME_RATE).getSpeed());
+    }
+
+    @Test
+    public void testStepsUpOneSpeedPerHold()
+    {
+        SpeedGovernor governor = new SpeedGovernor(4, FRAME_RATE);
+        int holdFrames = feedUntilChange(governor, SLOW, 1000);
+
+        assertTrue(holdFrames > 1);
+        assertEquals(5, governor.getSpeed());
+        assertEquals(-5, governor.getCpuUsed());
+
+        // The next step waits for a whole hold again.
+        assertEquals(holdFrames, feedUntilChange(governor, SLOW, 1000));
+        assertEquals(6, governor.getSpeed());
+    }
+
+    @Test
+    public void testStepsDownNotBelowMinSpeed()
+    {
+        SpeedGovernor governor = new SpeedGovernor(4, FRAME_RATE);
+
+        assertTrue(feedUntilChange(governor, SLOW, 1000) > 0);
+        assertEquals(5, governor.getSpeed());
+        assertTrue(feedUntilChange(governor, FAST, 1000) > 0);
+        assertEquals(4, governor.getSpeed());
+        assertEquals(-1, feedUntilChange(governor, FAST, 1000));
+        assertEquals(4, governor.getSpeed());
+    }
+
+    @Test
+    public void testDoesNotStepAboveMaxSpeed()
+    {
+        SpeedGovernor governor
+            = new SpeedGovernor(SpeedGovernor.MAX_SPEED, FRAME_RATE);
+
+        assertEquals(-1, feedUntilChange(governor, SLOW, 1000));
+        assertEquals(SpeedGovernor.MAX_SPEED, governor.getSpeed());
+    }
+
+    @Test
+    public void testHysteresis()
+    {
+        int holdFrames
+            = feedUntilChange(new SpeedGovernor(4, FRAME_RATE), SLOW, 1000);
+        SpeedGovernor governor = new SpeedGovernor(4, FRAME_RATE);
+
+        // Between the watermarks the speed is kept.
+        assertEquals(-1, feedUntilChange(governor, STEADY, 1000));
+        assertEquals(4, governor.getSpeed());
+
+        // A single slow frame does not pull the average above the high
+        // watermark.
+        assertFalse(governor.update(SLOW * 2));
+        assertEquals(-1, feedUntilChange(governor, STEADY, 1000));
+        assertEquals(4, governor.getSpeed());
+
+        // Right after a raise, fast frames do not lower the speed before the
+        // hold has passed.
+        assertTrue(feedUntilChange(governor, SLOW, 1000) > 0);
+        assertEquals(5, governor.getSpeed());
+        for (int i = 1; i < holdFrames; i++)
+            assertFalse(governor.update(FAST));
+        assertTrue(governor.update(FAST));
+        assertEquals(4, governor.getSpeed());
+    }
+}
@@ -0,0 +1,108 @@
+package org.jitsi.impl.neomedia.codec.video.vp8;
+
+import org.junit.Test;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertNull;
+import static org.junit.Assert.assertTrue;
+
+public class TemporalLayeringTest
+{
+    @Test
+    public void testUnsupportedNumberOfLayers()
+    {
+        assertNull(TemporalLayering.create(1));
+        assertNull(TemporalLayering.create(4));
+    }
+
+    @Test
+    public void testThreeLayerPattern()
+    {
+        TemporalLayering layering = TemporalLayering.create(3);
+        int[] expectedTids = { 0, 2, 1, 2, 0, 2, 1, 2 };
+        int[] expectedTl0PicIdx = { 0, 0, 0, 0, 1, 1, 1, 1 };
+        boolean[] expectedLayerSync
+            = { false, true, true, false, false, true, true, false };
+
+        for (int i = 0; i < expectedTids.length; i++)
+        {
+            TemporalLayering.FrameInfo info = layering.next(false);
+
+            assertEquals(expectedTids[i], info.getTemporalLayerId());
+            assertEquals(expectedTl0PicIdx[i], info.getTL0PicIdx());
+            assertEquals(expectedLayerSync[i], info.isLayerSync());
+            assertEquals(expectedTids[i] != 2, info.isReference());
+        }
+    }
+
+    @Test
+    public void testTwoLayerPattern()
+    {
+        TemporalLayering layering = TemporalLayering.create(2);
+
+        for (int i = 0; i < 4; i++)
+        {
+            TemporalLayering.FrameInfo info = layering.next(false);
+            boolean tl1 = (i % 2) == 1;
+
+            assertEquals(tl1 ? 1 : 0, info.getTemporalLayerId());
+            assertEquals(tl1, info.isLayerSync());
+            assertEquals(!tl1, info.isReference());
+        }
+    }
+
+    @Test
+    public void testKeyframeRestartsPattern()
+    {
+        TemporalLayering layering = TemporalLayering.create(2);
+
+        assertEquals(0, layering.next(false).getTemporalLayerId());
+        assertEquals(0, layering.next(true).getTemporalLayerId());
+        assertEquals(1, layering.next(false).getTL0PicIdx());
+    }
+
+    @Test
+    public void testPayloadDescriptor()
+    {
+        byte[] pd
+            = DePacketizer.VP8PayloadDescriptor.create(
+                    true, true, 0x7abc, 0x1ab, 2, true);
+
+        assertEquals(6, pd.length);
+        assertTrue(
+            DePacketizer.VP8PayloadDescriptor.isStartOfPartition(pd, 0));
+        assertFalse(
+            DePacketizer.VP8PayloadDescriptor.isReference(pd, 0, pd.length));
+        assertEquals(
+            6, DePacketizer.VP8PayloadDescriptor.getSize(pd, 0, pd.length));
+        assertTrue(
+            DePacketizer.VP8PayloadDescriptor.hasExtendedPictureId(
+                    pd, 0, pd.length));
+        assertEquals(
+            0x7abc, DePacketizer.VP8PayloadDescriptor.getPictureId(pd, 0));
+        assertEquals(
+            0xab,
+            DePacketizer.VP8PayloadDescriptor.getTL0PICIDX(pd, 0, pd.length));
+        assertEquals(
+            2,
+            DePacketizer.VP8PayloadDescriptor.getTemporalLayerIndex(
+                    pd, 0, pd.length));
+        assertTrue(
+            DePacketizer.VP8PayloadDescriptor.isLayerSync(pd, 0, pd.length));
+    }
+
+    @Test
+    public void testPayloadDescriptorWithoutLayers()
+    {
+        byte[] pd = DePacketizer.VP8PayloadDescriptor.create(false, 0x8001);
+
+        assertEquals(
+            4, DePacketizer.VP8PayloadDescriptor.getSize(pd, 0, pd.length));
+        assertEquals(1, DePacketizer.VP8PayloadDescriptor.getPictureId(pd, 0));
+        assertEquals(
+            -1,
+            DePacketizer.VP8PayloadDescriptor.getTemporalLayerIndex(
+                    pd, 0, pd.length));
+    }
+}
@@ -0,0 +1,140 @@
+package org.jitsi.impl.neomedia.codec.video.vp8;
+
+import org.junit.*;
+
+import static org.junit.Assert.assertArrayEquals;
+
+public class VPXDecoderTest
+{
+    /**
+     * Initializes a new <tt>VPXDecoder</tt>, skipping the test if the classes
+     * it depends on are not available.
+     */
+    private static VPXDecoder createDecoder()
+    {
+        try
+        {
+            return new VPXDecoder();
+        }
+        catch (Throwable t)
+        {
+            Assume.assumeNoException(t);
+            return null;
+        }
+    }
+
+    /**
+     * Feeds the frames of a temporal layering pattern, starting with a
+     * keyframe, to {@link VPXDecoder#shouldDecode} as they would be received
+     * from a <tt>Packetizer</tt>, switching the decode mode before specific
+     * frames.
+     *
+     * @param numberOfLayers the number of temporal layers of the pattern.
+     * @param decodeModes the decode mode to use for each frame.
+     * @return whether each frame is decoded.
+     */
+    private static boolean[] decode(int numberOfLayers, int[] decodeModes)
+    {
+        VPXDecoder decoder = createDecoder();
+        TemporalLayering layering = TemporalLayering.create(numberOfLayers);
+        boolean[] decoded = new boolean[decodeModes.length];
+
+        for (int i = 0; i < decodeModes.length; i++)
+        {
+            TemporalLayering.FrameInfo info = layering.next(i == 0);
+            byte[] pd = Packetizer.createPayloadDescriptor(info, i, true);
+            DePacketizer.FrameHeader header
+                = new DePacketizer.FrameHeader(
+                        DePacketizer.VP8PayloadDescriptor
+                            .getTemporalLayerIndex(pd, 0, pd.length),
+                        DePacketizer.VP8PayloadDescriptor.isLayerSync(
+                                pd, 0, pd.length),
+                        DePacketizer.VP8PayloadDescriptor.isReference(
+                                pd, 0, pd.length),
+                        null);
+            // RFC 6386, 9.1: bit 0 of the frame tag is 0 for keyframes.
+            byte[] frame = { (byte) ((i == 0) ? 0x00 : 0x01) };
+
+            decoder.setDecodeMode(decodeModes[i]);
+            decoded[i] = decoder.shouldDecode(frame, 0, frame.length, header);
+        }
+        return decoded;
+    }
+
+    @Test
+    public void testThreeLayersBaseLayerAndBack()
+    {
+        final int ALL = VPXDecoder.DECODE_ALL;
+        final int BASE = VPXDecoder.DECODE_BASE_LAYER;
+
+        // The pattern is TL0, TL2 (sync), TL1 (sync), TL2.
+        boolean[] decoded
+            = decode(
+                    3,
+                    new int[]
+                        {
+                            ALL, ALL, ALL, ALL,
+                            BASE, BASE, BASE, BASE,
+                            BASE, BASE, BASE, BASE,
+                            ALL, ALL, ALL, ALL,
+                            ALL, ALL, ALL, ALL
+                        });
+
+        assertArrayEquals(
+                new boolean[]
+                    {
+                        true, true, true, true,
+                        true, false, false, false,
+                        true, false, false, false,
+                        // TL2 frames which are not sync points are decoded
+                        // again from the first TL2 sync point after TL1 has
+                        // been resumed.
+                        true, true, true, false,
+                        true, true, true, true
+                    },
+                decoded);
+    }
+
+    @Test
+    public void testThreeLayersReferenceOnly()
+    {
+        final int ALL = VPXDecoder.DECODE_ALL;
+        final int REF = VPXDecoder.DECODE_REFERENCE;
+
+        boolean[] decoded
+            = decode(
+                    3,
+                    new int[]
+                        {
+                            ALL, ALL, ALL, ALL,
+                            REF, REF, REF, REF,
+                            ALL, ALL, ALL, ALL
+                        });
+
+        assertArrayEquals(
+                new boolean[]
+                    {
+                        true, true, true, true,
+                        true, false, true, false,
+                        true, true, true, true
+                    },
+                decoded);
+    }
+
+    @Test
+    public void testTwoLayersBaseLayerAndBack()
+    {
+        final int ALL = VPXDecoder.DECODE_ALL;
+        final int BASE = VPXDecoder.DECODE_BASE_LAYER;
+
+        boolean[] decoded
+            = decode(
+                    2,
+                    new int[] { ALL, ALL, BASE, BASE, BASE, BASE, ALL, ALL });
+
+        assertArrayEquals(
+                new boolean[]
+                    { true, true, true, false, true, false, true, true },
+                decoded);
+    }
+}
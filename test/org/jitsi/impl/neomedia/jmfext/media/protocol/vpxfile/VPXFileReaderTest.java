@@ -0,0 +1,426 @@
+package org.jitsi.impl.neomedia.jmfext.media.protocol.vpxfile;
+
+import java.io.*;
+import java.util.*;
+
+import org.jitsi.util.*;
+import org.junit.*;
+
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.fail;
+
+public class VPXFileReaderTest
+{
+    /**
+     * The frames of the tests: a VP8 key frame (the low bit of the first byte
+     * is clear) followed by two delta frames.
+     */
+    private static final byte[][] FRAMES
+        = {
+            { 0x00, 0x01, 0x02 },
+            { 0x01, 0x02 },
+            { 0x01, 0x05, 0x06, 0x07 }
+        };
+
+    /**
+     * The ID of the EBML header.
+     */
+    private static final int EBML_ID = 0x1A45DFA3;
+
+    /**
+     * The ID of the Segment element.
+     */
+    private static final int SEGMENT_ID = 0x18538067;
+
+    /**
+     * The ID of the Cluster element.
+     */
+    private static final int CLUSTER_ID = 0x1F43B675;
+
+    /**
+     * The files created by the test which is running.
+     */
+    private final List<File> files = new ArrayList<File>();
+
+    /**
+     * Skips the tests if the native library of <tt>VPXFileReader</tt> is not
+     * available.
+     */
+    @BeforeClass
+    public static void loadLibrary()
+    {
+        try
+        {
+            Class.forName(VPXFileReader.class.getName());
+        }
+        catch (Throwable t)
+        {
+            Assume.assumeNoException(t);
+        }
+    }
+
+    @After
+    public void deleteFiles()
+    {
+        for (File file : files)
+            file.delete();
+        files.clear();
+    }
+
+    /**
+     * Writes an EBML element, with its size on eight bytes.
+     *
+     * @param id the ID of the element.
+     * @param unknownSize <tt>true</tt> to write the size as unknown, i.e. as
+     * in a live recording.
+     * @param children the contents of the element.
+     * @return the bytes of the element.
+     */
+    private static byte[] element(
+            int id,
+            boolean unknownSize,
+            byte[]... children)
+    {
+        ByteArrayOutputStream out = new ByteArrayOutputStream();
+        int length = 0;
+
+        for (byte[] child : children)
+            length += child.length;
+        for (int shift = 24; shift >= 0; shift -= 8)
+        {
+            if ((id >>> shift) != 0)
+                out.write(id >>> shift);
+        }
+        out.write(0x01);
+        for (int shift = 48; shift >= 0; shift -= 8)
+            out.write(unknownSize ? 0xFF : (length >>> shift));
+        for (byte[] child : children)
+            out.write(child, 0, child.length);
+        return out.toByteArray();
+    }
+
+    private static byte[] element(int id, byte[]... children)
+    {
+        return element(id, false, children);
+    }
+
+    /**
+     * Writes an EBML element of an unsigned integer.
+     */
+    private static byte[] uint(int id, int value, int length)
+    {
+        byte[] bytes = new byte[length];
+
+        for (int i = length - 1; i >= 0; i--, value >>>= 8)
+            bytes[i] = (byte) value;
+        return element(id, bytes);
+    }
+
+    /**
+     * Writes a SimpleBlock of track 1.
+     */
+    private static byte[] simpleBlock(int timecode, boolean key, byte[] frame)
+    {
+        byte[] block = new byte[4 + frame.length];
+
+        block[0] = (byte) 0x81;
+        block[1] = (byte) (timecode >> 8);
+        block[2] = (byte) timecode;
+        block[3] = (byte) (key ? 0x80 : 0);
+        System.arraycopy(frame, 0, block, 4, frame.length);
+        return element(0xA3, block);
+    }
+
+    /**
+     * Writes a WebM file with a VP8 track of 320x240 and {@link #FRAMES} at
+     * 0, 33 and 100 ms, in two clusters.
+     *
+     * @param unknownSize <tt>true</tt> to write the segment and the clusters
+     * with unknown sizes, as in a live recording.
+     */
+    private static byte[] webm(boolean unknownSize)
+    {
+        return concat(
+                element(EBML_ID, element(0x4282, "webm".getBytes())),
+                element(
+                        SEGMENT_ID,
+                        unknownSize,
+                        element(0x1549A966, uint(0x2AD7B1, 1000000, 3)),
+                        element(
+                                0x1654AE6B,
+                                element(
+                                        0xAE,
+                                        uint(0xD7, 1, 1),
+                                        uint(0x83, 1, 1),
+                                        element(0x86, "V_VP8".getBytes()),
+                                        element(
+                                                0xE0,
+                                                uint(0xB0, 320, 2),
+                                                uint(0xBA, 240, 2)))),
+                        element(
+                                CLUSTER_ID,
+                                unknownSize,
+                                uint(0xE7, 0, 1),
+                                simpleBlock(0, true, FRAMES[0]),
+                                simpleBlock(33, false, FRAMES[1])),
+                        element(
+                                CLUSTER_ID,
+                                unknownSize,
+                                uint(0xE7, 100, 1),
+                                simpleBlock(0, false, FRAMES[2]))));
+    }
+
+    /**
+     * Writes an IVF file of 320x240 at 30 frames per second with
+     * {@link #FRAMES}.
+     */
+    private static byte[] ivf()
+    {
+        ByteArrayOutputStream out = new ByteArrayOutputStream();
+
+        out.write('D');
+        out.write('K');
+        out.write('I');
+        out.write('F');
+        writeLE(out, 0, 2);
+        writeLE(out, 32, 2);
+        out.write('V');
+        out.write('P');
+        out.write('8');
+        out.write('0');
+        writeLE(out, 320, 2);
+        writeLE(out, 240, 2);
+        writeLE(out, 30, 4);
+        writeLE(out, 1, 4);
+        writeLE(out, FRAMES.length, 4);
+        writeLE(out, 0, 4);
+        for (int i = 0; i < FRAMES.length; i++)
+        {
+            writeLE(out, FRAMES[i].length, 4);
+            writeLE(out, i, 8);
+            out.write(FRAMES[i], 0, FRAMES[i].length);
+        }
+        return out.toByteArray();
+    }
+
+    private static void writeLE(ByteArrayOutputStream out, long value, int n)
+    {
+        for (int i = 0; i < n; i++, value >>>= 8)
+            out.write((int) value);
+    }
+
+    private static byte[] concat(byte[]... arrays)
+    {
+        ByteArrayOutputStream out = new ByteArrayOutputStream();
+
+        for (byte[] array : arrays)
+            out.write(array, 0, array.length);
+        return out.toByteArray();
+    }
+
+    /**
+     * Writes the first <tt>length</tt> bytes of <tt>bytes</tt> into a
+     * temporary file and opens a <tt>VPXFileReader</tt> on it.
+     */
+    private VPXFileReader open(byte[] bytes, int length, String suffix)
+        throws IOException
+    {
+        File file = File.createTempFile("VPXFileReaderTest", suffix);
+        OutputStream out = new FileOutputStream(file);
+
+        files.add(file);
+        try
+        {
+            out.write(bytes, 0, length);
+        }
+        finally
+        {
+            out.close();
+        }
+        return new VPXFileReader(file.getPath());
+    }
+
+    /**
+     * Asserts that a reader returns the first <tt>count</tt> of
+     * {@link #FRAMES} with specific time stamps.
+     */
+    private static void assertFrames(
+            VPXFileReader reader,
+            int count,
+            long[] timestamps)
+        throws IOException
+    {
+        long[] info = new long[VPXFileReader.INFO_LENGTH];
+
+        assertEquals(VPXFileReader.CODEC_VP8, reader.getCodec());
+        assertEquals(320, reader.getWidth());
+        assertEquals(240, reader.getHeight());
+        assertEquals(count, reader.getFrameCount());
+        for (int i = 0; i < count; i++)
+        {
+            byte[] buf = new byte[reader.getFrameLength(i) + 1];
+
+            assertEquals(FRAMES[i].length, reader.readFrame(i, buf, 1, info));
+            assertArrayEquals(
+                    FRAMES[i],
+                    Arrays.copyOfRange(buf, 1, buf.length));
+            assertEquals(timestamps[i], info[VPXFileReader.INFO_TIMESTAMP]);
+            assertEquals(
+                    (i == 0) ? VPXFileReader.FLAG_KEY : 0,
+                    info[VPXFileReader.INFO_FLAGS]);
+        }
+        assertEquals(-1, reader.getFrameLength(count));
+        assertEquals(-1, reader.readFrame(count, new byte[16], 0, info));
+    }
+
+    @Test
+    public void testIvf()
+        throws IOException
+    {
+        byte[] ivf = ivf();
+        VPXFileReader reader = open(ivf, ivf.length, ".ivf");
+
+        try
+        {
+            assertFrames(
+                    reader,
+                    3,
+                    new long[] { 0, 1000000000L / 30, 2000000000L / 30 });
+        }
+        finally
+        {
+            reader.close();
+        }
+    }
+
+    @Test
+    public void testTruncatedIvf()
+        throws IOException
+    {
+        byte[] ivf = ivf();
+        VPXFileReader reader = open(ivf, ivf.length - 2, ".ivf");
+
+        try
+        {
+            assertFrames(reader, 2, new long[] { 0, 1000000000L / 30 });
+        }
+        finally
+        {
+            reader.close();
+        }
+    }
+
+    @Test
+    public void testWebm()
+        throws IOException
+    {
+        byte[] webm = webm(false);
+        VPXFileReader reader = open(webm, webm.length, ".webm");
+
+        try
+        {
+            assertFrames(
+                    reader,
+                    3,
+                    new long[] { 0, 33000000L, 100000000L });
+        }
+        finally
+        {
+            reader.close();
+        }
+    }
+
+    @Test
+    public void testUnknownSizeWebm()
+        throws IOException
+    {
+        byte[] webm = webm(true);
+        VPXFileReader reader = open(webm, webm.length, ".webm");
+
+        try
+        {
+            assertFrames(
+                    reader,
+                    3,
+                    new long[] { 0, 33000000L, 100000000L });
+        }
+        finally
+        {
+            reader.close();
+        }
+    }
+
+    @Test
+    public void testTruncatedWebm()
+        throws IOException
+    {
+        byte[] webm = webm(true);
+        VPXFileReader reader = open(webm, webm.length - 2, ".webm");
+
+        try
+        {
+            assertFrames(reader, 2, new long[] { 0, 33000000L });
+        }
+        finally
+        {
+            reader.close();
+        }
+    }
+
+    @Test(expected = IOException.class)
+    public void testGarbage()
+        throws IOException
+    {
+        byte[] garbage = new byte[64];
+
+        Arrays.fill(garbage, (byte) 'g');
+        open(garbage, garbage.length, ".webm").close();
+    }
+
+    @Test
+    public void testFileTruncatedAfterOpen()
+        throws IOException
+    {
+        // The size of a mapped file cannot be changed on Windows.
+        Assume.assumeFalse(OSUtils.IS_WINDOWS);
+
+        byte[] ivf = ivf();
+        VPXFileReader reader = open(ivf, ivf.length, ".ivf");
+
+        try
+        {
+            RandomAccessFile file
+                = new RandomAccessFile(files.get(0), "rw");
+
+            try
+            {
+                file.setLength(32);
+            }
+            finally
+            {
+                file.close();
+            }
+            try
+            {
+                reader.readFrame(2, new byte[16], 0, null);
+                fail("Read a frame past the end of the file");
+            }
+            catch (IOException expected)
+            {
+            }
+        }
+        finally
+        {
+            reader.close();
+        }
+        try
+        {
+            reader.readFrame(0, new byte[16], 0, null);
+            fail("Read a frame of a closed reader");
+        }
+        catch (IOException expected)
+        {
+        }
+    }
+}